@@ -23,7 +23,7 @@ namespace lve {
         float minZ;
         float maxZ;
 
-        //Constructeur par dfaut
+        //Constructeur par défaut
         AABB() {
             this->minX = 0.0;
             this->maxX = 0.0;
@@ -82,7 +82,7 @@ namespace lve {
             this->maxZ = (pointA.z > pointB.z) ? pointA.z : pointB.z;
         }
 
-        //Sphre contre AABB
+        //Sphère contre AABB
         bool isIntersectSphere(Sphere sphere) {
             float x = this->max(this->minX, this->min(sphere.x, this->maxX));
             float y = this->max(this->minY, this->min(sphere.y, this->maxY));
@@ -97,16 +97,16 @@ namespace lve {
             return distance < sphere.radius;
         }
 
-        //calcule le point le plus proche de la sphre sur le cube AABB et utilise cette information pour dterminer la normale de collision. Elle renvoie la direction dans laquelle la sphre devrait se dplacer aprs la collision avec le cube.
+        //calcule le point le plus proche de la sphère sur le cube AABB et utilise cette information pour déterminer la normale de collision. Elle renvoie la direction dans laquelle la sphère devrait se déplacer après la collision avec le cube.
         glm::vec3 normIntersectSphere(Sphere sphere) {
             glm::vec3 norm = { 0.f, 0.f, 0.f };
 
-            // Calcul du point le plus proche de la sphre sur le cube
+            // Calcul du point le plus proche de la sphère sur le cube
             float x = glm::clamp(sphere.x, this->minX, this->maxX);
             float y = glm::clamp(sphere.y, this->minY, this->maxY);
             float z = glm::clamp(sphere.z, this->minZ, this->maxZ);
 
-            // Calcul de la normale base sur le point le plus proche
+            // Calcul de la normale basée sur le point le plus proche
             norm.x = sphere.x - x;
             norm.y = sphere.y - y;
             norm.z = sphere.z - z;
@@ -129,7 +129,7 @@ namespace lve {
                 );
         }
 
-        //dtermine la quelle valeur inverser lors d'une colision entre deux cubes
+        //détermine la quelle valeur inverser lors d'une colision entre deux cubes
         glm::vec3 normIntersectAABB(AABB box) {
             glm::vec3 norm = { 1.f, 1.f, 1.f };
 
@@ -139,13 +139,13 @@ namespace lve {
                 float zOverlap = std::min(this->maxZ, box.maxZ) - std::max(this->minZ, box.minZ);
 
                 if (xOverlap < yOverlap && xOverlap < zOverlap) {
-                    //Face touche : face X
+                    //Face touchée : face X
                     norm = { -1.f, 1.f, 1.f };
                 } else if (yOverlap < xOverlap && yOverlap < zOverlap) {
-                    //Face touche : face Y
+                    //Face touchée : face Y
                     norm = { 1.f, -1.f, 1.f };
                 } else {
-                    //Face touche : face Z
+                    //Face touchée : face Z
                     norm = { 1.f, 1.f, -1.f };
                 }
             }
@@ -187,7 +187,7 @@ namespace lve {
             return res;
         }
 
-        //renvois les coordones du point au centre de la boite de colision
+        //renvois les coordonées du point au centre de la boite de colision
         glm::vec3 center() {
             return { minX + ((minX - maxX) / 2), minY + ((minY - maxY) / 2), minZ + ((minZ - maxZ) / 2) };
         }
@@ -30,7 +30,7 @@ namespace lve {
                 );
         }
 
-        //Point contre sphre
+        //Point contre sphère
         bool isPointInsideSphere(glm::vec3 point, Sphere sphere) {
             float distance = sqrt(
                 (point.x - sphere.x) * (point.x - sphere.x) +
@@ -52,7 +52,7 @@ namespace lve {
                 );
         }
 
-        //Sphre contre sphre
+        //Sphère contre sphère
         bool isIntersectSphere2(Sphere sphereA, Sphere sphereB) {
             float distance = sqrt(
                 (sphereA.x - sphereB.x) * (sphereA.x - sphereB.x) +
@@ -62,7 +62,7 @@ namespace lve {
             return distance < sphereA.radius + sphereB.radius;
         }
 
-        //Sphre contre AABB
+        //Sphère contre AABB
         bool isIntersectSphereAABB(Sphere sphere, AABB box) {
             float x = this->max(box.minX, this->min(sphere.x, box.maxX));
             float y = this->max(box.minY, this->min(sphere.y, box.maxY));
@@ -20,7 +20,15 @@ namespace lve {
             int lookDown = GLFW_KEY_DOWN;
         };
 
+        // one bit per key of KeyMappings, so input can be sampled on the main thread and applied on another
+        enum Action : uint32_t {
+            MoveLeft = 1 << 0, MoveRight = 1 << 1, MoveForward = 1 << 2, MoveBackward = 1 << 3, MoveUp = 1 << 4, MoveDown = 1 << 5,
+            LookLeft = 1 << 6, LookRight = 1 << 7, LookUp = 1 << 8, LookDown = 1 << 9
+        };
+
+        uint32_t sampleActions(GLFWwindow* window) const;
         void  moveInPanelXZ(GLFWwindow* window, float dt, LveGameObject& gameObject);
+        void  moveInPanelXZ(uint32_t actions, float dt, LveGameObject& gameObject);
 
         KeyMappings keys{};
         float moveSpeed{ 3.0f };
@@ -6,9 +6,18 @@
 #include "lve_game_object.hpp"
 #include "lve_descriptors.hpp"
 #include "lve_imgui.hpp"
+#include "lve_render_config.hpp"
+#include "lve_benchmark.hpp"
+#include "lve_gpu_profiler.hpp"
+#include "lve_job_system.hpp"
+#include "lve_latency_counter.hpp"
+#include "lve_render_snapshot.hpp"
+#include "lve_triple_buffer.hpp"
+#include "Keyboard_movement_controller.hpp"
 
 //std
 #include <memory>
+#include <stop_token>
 #include <vector>
 
 namespace lve {
@@ -16,8 +25,11 @@ namespace lve {
     public:
         static constexpr int WIDTH = 1280;
         static constexpr int HEIGHT = 720;
+        // idle mode (--idle): frames still rendered after the last change, so ImGui can settle its hover and focus states
+        static constexpr uint32_t IDLE_GRACE_FRAMES = 3;
+        static constexpr double IDLE_WAIT_SECONDS = 0.25;  // safety net, the simulation wakes the loop when something moves
 
-        FirstApp();
+        FirstApp(const LveRenderConfig& config = {});
         ~FirstApp();
 
         FirstApp(const FirstApp&) = delete;
@@ -25,19 +37,40 @@ namespace lve {
 
         void run();
     private:
+        // sampled on the main thread every frame, read by the simulation thread
+        struct SimulationInput {
+            bool spacePressed = false;
+            bool hasSliders = false;  // ImGui transform sliders of the inspected object
+            glm::vec3 sliderPosition{};
+            glm::vec3 sliderRotation{};
+            glm::vec3 sliderScale{};
+        };
 
+        void simulate(std::stop_token stopToken);
         double getCurrentTime();
         void loadGameObjects();
         void loadCubesCollision();
+        void loadBenchmarkScene();
 
 
-        LveWindow lveWindow{ WIDTH, HEIGHT, "GG ENGINE" };
-        LveDevice lveDevice{ lveWindow };
-        LveRenderer lveRenderer{ lveWindow,lveDevice };
-        LveImgui lveImgui{ lveWindow, lveDevice, lveRenderer };
+        LveRenderConfig renderConfig;
+        // no window nor ImGui when headless
+        std::unique_ptr<LveWindow> lveWindow = renderConfig.headless ? nullptr : std::make_unique<LveWindow>(WIDTH, HEIGHT, "GG ENGINE");
+        LveDevice lveDevice{ lveWindow.get() };
+        LveRenderer lveRenderer{ lveWindow.get(), lveDevice, renderConfig };
+        std::unique_ptr<LveImgui> lveImgui = lveWindow ? std::make_unique<LveImgui>(*lveWindow, lveDevice, lveRenderer) : nullptr;
+        LveGpuProfiler gpuProfiler{ lveDevice, lveRenderer.getFramesInFlight() };
+        LveLatencyCounter latencyCounter{ lveDevice };
+        LveJobSystem jobSystem{ renderConfig.workerThreads };  // created on the main thread, which joins in while waiting
 
         // note: order of declarations matters
-        std::unique_ptr<LveDescriptorPool> globalPool{};
-        LveGameObject::Map gameObjects;
+        std::unique_ptr<LveBenchmark> benchmark{};  // only with --benchmark
+        std::unique_ptr<LveDescriptorAllocator> globalAllocator{};
+        std::vector<std::unique_ptr<LveDescriptorAllocator>> frameAllocators{};
+        LveGameObject::Map gameObjects;  // owned by the simulation thread while run() is running
+        LveGameObject::Map renderObjects;  // render thread copies, updated from the snapshots
+        LveTripleBuffer<RenderSnapshot> snapshots;  // simulation -> render
+        LveTripleBuffer<SimulationInput> inputs;  // render -> simulation
+        KeyboardMovementController cameraController{};  // render thread: the camera is latched right before submit
     };
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+//std
+#include <cstdint>
+
+// Heap tracking: with LVE_TRACK_ALLOCATIONS defined, global operator new/delete are replaced to count allocations per thread.
+// LVE_NO_ALLOC_SCOPE("name") marks a steady-state region: once enforcement is on, any allocation inside it fails an assert.
+// Without LVE_TRACK_ALLOCATIONS the macro expands to nothing and operator new is left alone
+#ifdef LVE_TRACK_ALLOCATIONS
+#define LVE_NO_ALLOC_CONCAT_INNER(a, b) a##b
+#define LVE_NO_ALLOC_CONCAT(a, b) LVE_NO_ALLOC_CONCAT_INNER(a, b)
+#define LVE_NO_ALLOC_SCOPE(name) ::lve::LveNoAllocScope LVE_NO_ALLOC_CONCAT(lveNoAllocScope, __LINE__){ name }
+#else
+#define LVE_NO_ALLOC_SCOPE(name) ((void)0)
+#endif
+
+namespace lve {
+    class LveAllocTracker {
+    public:
+        static constexpr uint32_t WARMUP_FRAMES = 30;  // caches and pools fill up before no-alloc regions are enforced
+
+        struct Counters {
+            uint64_t allocations = 0;
+            uint64_t bytes = 0;
+        };
+
+        static Counters thread();  // running totals of the calling thread
+        static void markFrame();  // closes the calling thread's frame, see lastFrame()
+        static Counters lastFrame();  // allocations between the last two markFrame() calls
+        static void setEnforced(bool enforced);
+        static bool isEnforced();
+
+        static void enterNoAlloc(const char* name);
+        static void leaveNoAlloc(const char* previous);
+        static const char* currentNoAlloc();
+    };
+
+    class LveNoAllocScope {
+    public:
+        explicit LveNoAllocScope(const char* name) : previous{ LveAllocTracker::currentNoAlloc() } { LveAllocTracker::enterNoAlloc(name); }
+        ~LveNoAllocScope() { LveAllocTracker::leaveNoAlloc(previous); }
+
+        LveNoAllocScope(const LveNoAllocScope&) = delete;
+        LveNoAllocScope& operator=(const LveNoAllocScope&) = delete;
+
+    private:
+        const char* previous;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_camera.hpp"
+#include "lve_frame_info.hpp"
+#include "lve_game_object.hpp"
+#include "lve_gpu_profiler.hpp"
+#include "lve_model.hpp"
+#include "lve_render_config.hpp"
+
+//std
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+    // Reproducible performance run: builds a procedural scene, flies a scripted camera, measures CPU and GPU frame times
+    // (GPU scopes from LveGpuProfiler) and writes percentiles, draw counts and device memory as JSON, compared against an optional baseline
+    class LveBenchmark {
+    public:
+        static constexpr uint32_t WARMUP_FRAMES = 30;  // pipeline and cache warm-up, left out of the statistics
+        static constexpr float CUBE_SPACING = 1.5f;
+        static constexpr const char* MODEL_PATH = "models/NOEL1.obj";
+
+        LveBenchmark(LveDevice& device, const LveRenderConfig& config);
+
+        LveBenchmark(const LveBenchmark&) = delete;
+        LveBenchmark& operator=(const LveBenchmark&) = delete;
+
+        void buildScene(LveGameObject::Map& gameObjects, std::shared_ptr<LveModel> cubeModel, std::shared_ptr<LveModel> objModel);
+        void updateCamera(uint32_t frame, LveCamera& camera) const;
+        void beginFrame();
+        void endFrame(const FrameStats& stats);
+        void recordGpuResults(const LveGpuProfiler::FrameResults& results);
+        void endRun();  // right after the last frame of the loop: its CPU time has no next beginFrame to close it
+        bool finish(VkExtent2D extent, LveGpuProfiler& gpuProfiler);  // after vkDeviceWaitIdle
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Percentiles {
+            double mean = 0.0;
+            double p50 = 0.0;
+            double p90 = 0.0;
+            double p99 = 0.0;
+            double max = 0.0;
+        };
+
+        static bool isMeasured(uint32_t frame) { return frame >= WARMUP_FRAMES; }
+        static Percentiles computePercentiles(std::vector<double> samples);
+        static double readJsonNumber(const std::string& json, const std::string& section, const std::string& key);
+
+        LveDevice& lveDevice;
+        LveRenderConfig config;
+        float sceneRadius = 10.f;
+
+        uint32_t frameNumber = 0;
+        Clock::time_point frameStart{};
+        std::vector<double> cpuFrameMs{};
+        uint64_t lastGpuFrame = 0;
+        std::vector<std::pair<const char*, std::vector<double>>> gpuScopeMs{};  // first scope is the whole frame
+        std::vector<double> vertexInvocations{};
+        std::vector<double> fragmentInvocations{};
+        std::vector<double> drawCalls{};
+        VkDeviceSize peakDeviceMemory = 0;
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_descriptors.hpp"
+
+// libs
+#include "glm/glm.hpp"
+
+//std
+#include <memory>
+#include <vector>
+
+namespace lve {
+    // layout of MaterialBuffer in simple_shader.frag (std430)
+    struct BindlessMaterial {
+        glm::vec4 baseColor{ 1.f };
+        uint32_t textureIndex = ~0u;  // LveBindlessTable::INVALID_INDEX when untextured
+        uint32_t padding[3]{};
+    };
+
+    // One global set of update-after-bind descriptor arrays: draws only carry indices into it.
+    // binding 0: sampled images, binding 1: storage buffers (materials, per-draw data)
+    class LveBindlessTable {
+    public:
+        static constexpr uint32_t TEXTURE_BINDING = 0;
+        static constexpr uint32_t BUFFER_BINDING = 1;
+        static constexpr uint32_t MAX_TEXTURES = 1024;
+        static constexpr uint32_t MAX_BUFFERS = 1024;
+        static constexpr uint32_t INVALID_INDEX = ~0u;
+
+        LveBindlessTable(LveDevice& device);
+        ~LveBindlessTable();
+        LveBindlessTable(const LveBindlessTable&) = delete;
+        LveBindlessTable& operator=(const LveBindlessTable&) = delete;
+
+        uint32_t addTexture(VkDescriptorImageInfo imageInfo);
+        uint32_t addBuffer(VkDescriptorBufferInfo bufferInfo);
+        void removeTexture(uint32_t index);
+        void removeBuffer(uint32_t index);
+
+        VkDescriptorSetLayout getSetLayout() const { return setLayout->getDescriptorSetLayout(); }
+        VkDescriptorSet getDescriptorSet() const { return descriptorSet; }
+
+    private:
+        struct Slots {
+            uint32_t next = 0;
+            std::vector<uint32_t> freeIndices{};
+        };
+
+        static uint32_t acquire(Slots& slots, uint32_t capacity);
+        void release(const std::shared_ptr<Slots>& slots, uint32_t index);
+
+        LveDevice& lveDevice;
+        std::unique_ptr<LveDescriptorSetLayout> setLayout{};
+        std::unique_ptr<LveDescriptorPool> pool{};
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        // shared with the deferred releases, which may run after the table is destroyed
+        std::shared_ptr<Slots> textures = std::make_shared<Slots>();
+        std::shared_ptr<Slots> buffers = std::make_shared<Slots>();
+    };
+}
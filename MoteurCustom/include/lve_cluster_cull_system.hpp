@@ -0,0 +1,71 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_pipeline.hpp"
+#include "lve_game_object.hpp"
+#include "lve_frame_info.hpp"
+
+//std
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace lve {
+    // Culls the clusters of LOD 0 models on the GPU. Visible clusters of every object are appended to one list of indexed
+    // indirect draws per vertex layout and index type, behind a counter read by vkCmdDrawIndexedIndirectCount: each list is
+    // drawn with a single call, firstInstance selecting the object's data. Needs drawIndirectCount, multiDrawIndirect and
+    // drawIndirectFirstInstance; without them nothing is culled and the models are drawn whole
+    class ClusterCullSystem {
+    public:
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+        static constexpr uint32_t INITIAL_COMMAND_CAPACITY = 4096;
+        static constexpr uint32_t LIST_COUNT = 4;  // Full / Packed vertices, 32 / 16-bit indices
+
+        // an object to cull; its draws use the per-object data at instanceIndex
+        struct CullObject {
+            LveGameObject* object;
+            uint32_t instanceIndex;
+        };
+
+        ClusterCullSystem(LveDevice& device, VkDescriptorSetLayout globalSetLayout);
+        ~ClusterCullSystem();
+        ClusterCullSystem(const ClusterCullSystem&) = delete;
+        ClusterCullSystem& operator=(const ClusterCullSystem&) = delete;
+
+        bool isSupported() const { return supported; }
+        void cull(FrameInfo& frameInfo, const std::vector<CullObject>& objects);
+        bool hasDraws(VertexLayout layout, VkIndexType indexType) const { return lists[listIndex(layout, indexType)].capacity > 0; }
+        uint32_t drawClusters(VkCommandBuffer commandBuffer, VertexLayout layout, VkIndexType indexType);
+
+    private:
+        struct DrawList {
+            uint32_t firstCommand = 0;
+            uint32_t capacity = 0;  // clusters of its objects, upper bound of the visible count
+        };
+
+        static uint32_t listIndex(VertexLayout layout, VkIndexType indexType) {
+            return (layout == VertexLayout::Packed ? 2 : 0) + (indexType == VK_INDEX_TYPE_UINT16 ? 1 : 0);
+        }
+
+        void createDescriptors();
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+        void createPipeline();
+        void prepareFrame(int frameIndex, uint32_t commandCount);
+
+        LveDevice& lveDevice;
+        std::unique_ptr<LvePipeline> lvePipeline;
+        VkPipelineLayout pipelineLayout;
+
+        std::unique_ptr<LveDescriptorSetLayout> cullSetLayout{};  // set allocated every frame from FrameInfo::frameDescriptors
+        std::vector<std::unique_ptr<LveBuffer>> indirectBuffers{};
+        std::vector<uint32_t> indirectCapacities{};
+        std::vector<std::unique_ptr<LveBuffer>> countBuffers{};  // LIST_COUNT counters
+
+        bool supported = false;
+        VkBuffer currentIndirectBuffer = VK_NULL_HANDLE;
+        VkBuffer currentCountBuffer = VK_NULL_HANDLE;
+        std::array<DrawList, LIST_COUNT> lists{};
+    };
+}
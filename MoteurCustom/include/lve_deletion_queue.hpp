@@ -0,0 +1,41 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+//std
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+    // Defers the destruction of GPU resources until the frame that may still use them has completed on the device timeline.
+    // Releases are stamped with the timeline value of the next frame submission, then destroyed a slice at a time
+    class LveDeletionQueue {
+    public:
+        static constexpr size_t DEFAULT_SLICE = 64;  // destructions per collect(), so unloading a level does not cause a hitch
+
+        LveDeletionQueue(LveDevice& device);
+        ~LveDeletionQueue();
+
+        LveDeletionQueue(const LveDeletionQueue&) = delete;
+        LveDeletionQueue& operator=(const LveDeletionQueue&) = delete;
+
+        void defer(std::function<void()> destroy);
+        void retire(uint64_t timelineValue);
+        void collect(size_t maxDestructions = DEFAULT_SLICE);
+        void flush();
+        size_t pendingCount();
+
+    private:
+        struct Entry {
+            uint64_t timelineValue;
+            std::function<void()> destroy;
+        };
+
+        LveDevice& lveDevice;
+        std::mutex mutex;
+        std::vector<std::function<void()>> unstamped{};  // released since the last frame submission
+        std::deque<Entry> entries{};  // ordered by timeline value
+    };
+}
@@ -4,11 +4,18 @@
 
 // std
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 
 namespace lve {
 
+    // one element of the data given to vkUpdateDescriptorSetWithTemplate
+    union LveDescriptorInfo {
+        VkDescriptorBufferInfo buffer;
+        VkDescriptorImageInfo image;
+    };
+
     class LveDescriptorSetLayout {
     public:
         class Builder {
@@ -16,25 +23,34 @@ namespace lve {
             Builder(LveDevice& lveDevice) : lveDevice{ lveDevice } {}
 
             Builder& addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t count = 1);
+            // descriptor indexing flags (partially bound, update after bind...), requires LveDevice::supportsBindless
+            Builder& setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags);
             std::unique_ptr<LveDescriptorSetLayout> build() const;
 
         private:
             LveDevice& lveDevice;
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+            std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags{};
         };
 
-        LveDescriptorSetLayout(LveDevice& lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+        LveDescriptorSetLayout(LveDevice& lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings, std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags = {});
         ~LveDescriptorSetLayout();
         LveDescriptorSetLayout(const LveDescriptorSetLayout&) = delete;
         LveDescriptorSetLayout& operator=(const LveDescriptorSetLayout&) = delete;
 
         VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+        VkDescriptorUpdateTemplate getUpdateTemplate() const { return updateTemplate; }
 
 
     private:
+        void createUpdateTemplate();
+
         LveDevice& lveDevice;
         VkDescriptorSetLayout descriptorSetLayout;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+        // null when a binding is an array; templateSlots maps a binding to its LveDescriptorInfo index
+        VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+        std::unordered_map<uint32_t, uint32_t> templateSlots{};
 
         friend class LveDescriptorWriter;
     };
@@ -76,12 +92,54 @@ namespace lve {
         friend class LveDescriptorWriter;
     };
 
+    // Chains descriptor pools: when one is exhausted a new, larger one is created.
+    // reset() recycles every pool at once, meant for per-frame sets once the frame fence has signaled
+    class LveDescriptorAllocator {
+    public:
+        class Builder {
+        public:
+            Builder(LveDevice& lveDevice) : lveDevice{ lveDevice } {}
+
+            Builder& addPoolRatio(VkDescriptorType descriptorType, float descriptorsPerSet);
+            Builder& setInitialSets(uint32_t count);
+            std::unique_ptr<LveDescriptorAllocator> build() const;
+
+        private:
+            LveDevice& lveDevice;
+            std::vector<std::pair<VkDescriptorType, float>> ratios{};
+            uint32_t initialSets = INITIAL_SETS_PER_POOL;
+        };
+
+        static constexpr uint32_t INITIAL_SETS_PER_POOL = 64;
+        static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+        LveDescriptorAllocator(LveDevice& lveDevice, const std::vector<std::pair<VkDescriptorType, float>>& ratios, uint32_t initialSets);
+        ~LveDescriptorAllocator();
+        LveDescriptorAllocator(const LveDescriptorAllocator&) = delete;
+        LveDescriptorAllocator& operator=(const LveDescriptorAllocator&) = delete;
+
+        bool allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor);
+        void reset();
+        size_t getPoolCount() const { return readyPools.size() + fullPools.size(); }
+
+    private:
+        VkDescriptorPool acquirePool();
+
+        LveDevice& lveDevice;
+        std::vector<std::pair<VkDescriptorType, float>> ratios;
+        uint32_t setsPerPool;
+        std::vector<VkDescriptorPool> readyPools{};
+        std::vector<VkDescriptorPool> fullPools{};
+    };
+
     class LveDescriptorWriter {
     public:
-        LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorPool& pool);
+        // memory holds the pending writes, e.g. a frame arena for per-frame sets
+        LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorPool& pool, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+        LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorAllocator& allocator, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
-        LveDescriptorWriter& writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo);
-        LveDescriptorWriter& writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo);
+        LveDescriptorWriter& writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement = 0);
+        LveDescriptorWriter& writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement = 0);
 
         bool build(VkDescriptorSet& set);
         void overwrite(VkDescriptorSet& set);
@@ -89,8 +147,9 @@ namespace lve {
 
     private:
         LveDescriptorSetLayout& setLayout;
-        LveDescriptorPool& pool;
-        std::vector<VkWriteDescriptorSet> writes;
+        LveDescriptorPool* pool = nullptr;
+        LveDescriptorAllocator* allocator = nullptr;
+        std::pmr::vector<VkWriteDescriptorSet> writes;
     };
 
 }  // namespace lve
\ No newline at end of file
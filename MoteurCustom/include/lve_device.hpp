@@ -3,11 +3,17 @@
 #include "lve_window.hpp"
 
 // std lib headers
+#include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 namespace lve {
+    class LveDeletionQueue;
+    class LveGeometryPool;
+    class LveShaderLibrary;
 
     struct SwapChainSupportDetails {
         VkSurfaceCapabilitiesKHR capabilities;
@@ -30,8 +36,10 @@ namespace lve {
         #else
             const bool enableValidationLayers = true;
         #endif
+        static constexpr const char* PIPELINE_CACHE_PATH = "pipeline_cache.bin";
 
         LveDevice(LveWindow& window);
+        LveDevice(LveWindow* window);  // nullptr: headless, no surface, no present queue and no swap chain extension
         ~LveDevice();
 
         // Not copyable or movable
@@ -47,6 +55,8 @@ namespace lve {
         VkSurfaceKHR getSurface() const { return surface_; }
         VkQueue getGraphicsQueue() const { return graphicsQueue_; }
         VkQueue getPresentQueue() const { return presentQueue_; }
+        VkPipelineCache getPipelineCache() const { return pipelineCache; }
+        size_t getPipelineCacheLoadedBytes() const { return pipelineCacheLoadedBytes; }
         static uint32_t getGraphicsQueueFamily() { QueueFamilyIndices indice; return indice.graphicsFamily; }
 
         SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
@@ -58,10 +68,32 @@ namespace lve {
         void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
         void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
         void createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
 
+        LveGeometryPool& getGeometryPool();
+        bool hasGeometryPool() const { return geometryPool != nullptr; }
+        LveShaderLibrary& getShaderLibrary() { return *shaderLibrary; }
+        LveDeletionQueue& getDeletionQueue() { return *deletionQueue; }
+        bool supportsMultiDrawIndirect() const { return multiDrawIndirect; }
+        bool supportsDrawIndirectCount() const { return drawIndirectCount; }
+        bool supportsDrawIndirectFirstInstance() const { return drawIndirectFirstInstance; }
+        bool supportsPipelineStatistics() const { return pipelineStatistics; }
+        bool supportsBindless() const { return bindless; }
+        bool isHeadless() const { return window == nullptr; }
+        VkDeviceSize getDeviceMemoryUsage();  // 0 without VK_EXT_memory_budget
+
+        // Graphics queue timeline: every submission signals the next value, so one counter orders all GPU work.
+        // Initializer lists keep the per-frame submit free of heap allocations
+        static constexpr uint32_t MAX_SUBMIT_SIGNALS = 4;
+        uint64_t submitGraphics(std::initializer_list<VkCommandBuffer> commandBuffers, std::initializer_list<VkSemaphore> waitSemaphores = {},
+            std::initializer_list<VkPipelineStageFlags> waitStages = {}, std::initializer_list<VkSemaphore> signalSemaphores = {});
+        void waitForTimeline(uint64_t value);
+        uint64_t getCompletedTimelineValue();
+        uint64_t getLastSubmittedTimelineValue();
+        VkSemaphore getTimeline() const { return timeline; }
+
         VkPhysicalDeviceProperties properties;
 
 
@@ -72,6 +104,9 @@ namespace lve {
         void pickPhysicalDevice();
         void createLogicalDevice();
         void createCommandPool();
+        void createPipelineCache();
+        void savePipelineCache();
+        void createTimeline();
 
         // helper functions
         bool isDeviceSuitable(VkPhysicalDevice device);
@@ -81,21 +116,37 @@ namespace lve {
         void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
         void hasGflwRequiredInstanceExtensions();
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool hasDeviceExtension(VkPhysicalDevice device, const char* extensionName);
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-        LveWindow& window;
+        LveWindow* window;
         VkCommandPool commandPool;
 
         VkDevice device_;
-        VkSurfaceKHR surface_;
+        VkSurfaceKHR surface_ = VK_NULL_HANDLE;
         VkQueue graphicsQueue_;
-        VkQueue presentQueue_;
+        VkQueue presentQueue_ = VK_NULL_HANDLE;
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+        size_t pipelineCacheLoadedBytes = 0;  // from PIPELINE_CACHE_PATH, 0 when missing or stale
+        VkSemaphore timeline = VK_NULL_HANDLE;
+        uint64_t lastSubmittedValue = 0;
+        std::mutex submitMutex;
+
+        std::unique_ptr<LveGeometryPool> geometryPool;
+        std::unique_ptr<LveShaderLibrary> shaderLibrary;
+        std::unique_ptr<LveDeletionQueue> deletionQueue;
+        bool multiDrawIndirect = false;
+        bool drawIndirectCount = false;
+        bool drawIndirectFirstInstance = false;
+        bool pipelineStatistics = false;
+        bool bindless = false;
+        bool memoryBudget = false;
 
         const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
-        const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+        std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
     };
 
 }  // namespace lve
\ No newline at end of file
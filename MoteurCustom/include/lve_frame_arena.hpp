@@ -0,0 +1,67 @@
+#pragma once
+
+//std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+    // Bump allocator for CPU data that lives for one frame: one arena per thread, all reset together at the start of the frame.
+    // Each arena is a std::pmr::memory_resource, so std::pmr containers can build temporary lists without the global heap.
+    // Deallocation is a no-op; nothing allocated from it may outlive the frame
+    class LveFrameArena {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        class ThreadArena : public std::pmr::memory_resource {
+        public:
+            explicit ThreadArena(size_t blockSize) : blockSize{ blockSize } {}
+
+            void reset();
+            size_t usedBytes() const { return used; }
+            size_t capacity() const;
+
+        private:
+            void* do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void*, size_t, size_t) override {}
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+            struct Block {
+                std::unique_ptr<std::byte[]> memory;
+                size_t size;
+            };
+
+            size_t blockSize;
+            std::vector<Block> blocks{};
+            size_t current = 0;  // block being filled
+            size_t offset = 0;  // in the current block
+            size_t used = 0;  // bytes handed out this frame, padding included
+        };
+
+        explicit LveFrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE) : blockSize{ blockSize } {}
+
+        LveFrameArena(const LveFrameArena&) = delete;
+        LveFrameArena& operator=(const LveFrameArena&) = delete;
+
+        ThreadArena& local();  // arena of the calling thread, created on first use
+        static std::pmr::memory_resource* resourceOf(LveFrameArena* arena);  // local arena, or the default resource when null
+        void reset();  // start of frame, while no other thread allocates from the arenas
+        size_t usedBytes() const;
+
+    private:
+        static std::atomic<uint64_t> nextId;
+
+        // keys the per-thread lookup instead of the address, which a later arena may reuse
+        const uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+        size_t blockSize;
+        mutable std::mutex threadsMutex;  // only taken by local() the first time a thread asks, and by reset()
+        std::vector<std::unique_ptr<ThreadArena>> threads{};
+    };
+
+    template<typename T>
+    using FrameVector = std::pmr::vector<T>;
+}
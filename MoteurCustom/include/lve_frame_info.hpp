@@ -7,6 +7,10 @@
 #include <vulkan/vulkan.h>
 
 namespace lve {
+    class ClusterCullSystem;
+    class LveDescriptorAllocator;
+    class LveFrameArena;
+    class LveTransientAllocator;
 
 #define MAX_LIGHTS 10
 
@@ -24,6 +28,12 @@ namespace lve {
         int numLights;
     };
 
+    // filled by the render systems when FrameInfo::stats is set
+    struct FrameStats {
+        uint32_t drawCalls = 0;  // vkCmdDraw* calls, an indirect call counts once
+        uint32_t objectsDrawn = 0;
+    };
+
     struct FrameInfo {
         int frameIndex;
         float frameTime;
@@ -31,5 +41,12 @@ namespace lve {
         LveCamera& camera;
         VkDescriptorSet globalDescriptorSet;
         LveGameObject::Map& gameObjects;
+        ClusterCullSystem* clusterCull = nullptr;
+        LveDescriptorAllocator* frameDescriptors = nullptr;  // reset every time this frame index comes back
+        VkDescriptorSet bindlessDescriptorSet = VK_NULL_HANDLE;
+        LveTransientAllocator* transient = nullptr;  // per-frame data, released when this frame index comes back
+        uint32_t globalUboOffset = 0;  // dynamic offset of GlobalUbo in globalDescriptorSet
+        FrameStats* stats = nullptr;
+        LveFrameArena* frameArena = nullptr;  // temporary CPU lists, reset at the start of every frame
     };
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+//std
+#include <chrono>
+
+namespace lve {
+    // Paces a loop to a target rate: sleeps for most of the wait, then spins for the last part
+    // so the OS timer granularity does not add jitter. On Windows the sleep uses a high resolution waitable timer,
+    // or a 1 ms system timer period when it is not available, so the spin stays short
+    class LveFrameLimiter {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        LveFrameLimiter(double targetFps = 0.0);
+        ~LveFrameLimiter();
+
+        LveFrameLimiter(const LveFrameLimiter&) = delete;
+        LveFrameLimiter& operator=(const LveFrameLimiter&) = delete;
+
+        void setTargetFps(double targetFps);
+        void wait();
+
+    private:
+        void sleepFor(Clock::duration duration);
+
+        Clock::duration period{};
+        Clock::time_point deadline{};
+        Clock::duration spinMargin{};
+        void* timer = nullptr;  // Windows waitable timer handle, null elsewhere or when unsupported
+    };
+}
@@ -42,6 +42,8 @@ namespace lve {
 
         static LveGameObject createGameObject() { static id_t currentId = 0; return LveGameObject{ currentId++ }; }
         static LveGameObject makePointLight(float intensity = 10.f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.f));
+        // same id, model and components: the render thread's copy of a simulated object
+        LveGameObject makeRenderProxy() const;
 
         LveGameObject(const LveGameObject&) = delete;
         LveGameObject& operator=(const LveGameObject&) = delete;
@@ -56,6 +58,8 @@ namespace lve {
         glm::vec3 color{};
         TransformComponent transform{};
         std::unique_ptr<PointLightComponent> pointLight = nullptr;
+        uint32_t lodIndex = 0;
+        uint32_t materialIndex = 0;  // bindless mode only
 
 
     private:
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+//std
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace lve {
+    // Sub-allocates the vertex, index and cluster data of every model into one device-local buffer each
+    class LveGeometryPool {
+    public:
+        enum class Heap { Vertex, Index, Cluster };
+
+        using Handle = uint32_t;
+        static constexpr Handle INVALID_HANDLE = ~0u;
+        static constexpr VkDeviceSize DEFAULT_VERTEX_CAPACITY = 64 * 1024 * 1024;
+        static constexpr VkDeviceSize DEFAULT_INDEX_CAPACITY = 32 * 1024 * 1024;
+        static constexpr VkDeviceSize DEFAULT_CLUSTER_CAPACITY = 4 * 1024 * 1024;
+
+        LveGeometryPool(LveDevice& device, VkDeviceSize vertexCapacity = DEFAULT_VERTEX_CAPACITY, VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY, VkDeviceSize clusterCapacity = DEFAULT_CLUSTER_CAPACITY);
+        ~LveGeometryPool();
+
+        LveGeometryPool(const LveGeometryPool&) = delete;
+        LveGeometryPool& operator=(const LveGeometryPool&) = delete;
+
+        Handle allocate(Heap heap, VkDeviceSize size, VkDeviceSize alignment);
+        void free(Heap heap, Handle handle);
+        void upload(Heap heap, Handle handle, const void* data, VkDeviceSize size);
+        VkDeviceSize getOffset(Heap heap, Handle handle) const { return heaps[static_cast<size_t>(heap)].allocations[handle].offset; }
+
+        // records at most one move per heap into the frame's command buffer, before any draw or cull of that frame:
+        // allocations move down into lower holes, or up to free space above when no hole fits so that their old range
+        // merges with the hole below it. No allocate() between this call and the frame submission: a grow would copy
+        // the buffer before the moves run
+        bool compactStep(VkCommandBuffer commandBuffer);
+
+        void bind(VkCommandBuffer commandBuffer, VkIndexType indexType);
+        void resetBindings() { boundCommandBuffer = VK_NULL_HANDLE; }
+
+        VkBuffer getBuffer(Heap heap) const { return heaps[static_cast<size_t>(heap)].buffer->getBuffer(); }
+        VkDeviceSize getCapacity(Heap heap) const { return heaps[static_cast<size_t>(heap)].capacity; }
+        VkDeviceSize getUsedBytes(Heap heap) const { return heaps[static_cast<size_t>(heap)].usedBytes; }
+
+    private:
+        struct Allocation {
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            VkDeviceSize alignment = 1;
+            bool live = false;
+        };
+
+        struct HeapStorage {
+            std::unique_ptr<LveBuffer> buffer;
+            VkDeviceSize capacity = 0;
+            VkDeviceSize usedBytes = 0;
+            VkBufferUsageFlags usage = 0;
+            std::map<VkDeviceSize, VkDeviceSize> freeBlocks{};
+            std::vector<Allocation> allocations{};
+            std::vector<Handle> freeHandles{};
+            uint32_t pendingMoves = 0;  // moves whose old range is not released yet
+        };
+
+        void createHeap(HeapStorage& storage, VkDeviceSize capacity, VkBufferUsageFlags usage);
+        void grow(HeapStorage& storage, VkDeviceSize minimumCapacity);
+        bool findBlock(const HeapStorage& storage, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize from, VkDeviceSize limit, VkDeviceSize& offset) const;
+        bool takeBlock(HeapStorage& storage, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize from, VkDeviceSize limit, VkDeviceSize& offset);
+        void releaseBlock(HeapStorage& storage, VkDeviceSize offset, VkDeviceSize size);
+        bool compactHeap(size_t heap, VkCommandBuffer commandBuffer, bool barrierRecorded);
+        void moveAllocation(size_t heap, Handle handle, VkDeviceSize newOffset, VkCommandBuffer commandBuffer, bool barrierRecorded);
+
+        LveDevice& lveDevice;
+        HeapStorage heaps[3];
+
+        VkCommandBuffer boundCommandBuffer = VK_NULL_HANDLE;
+        VkIndexType boundIndexType = VK_INDEX_TYPE_UINT32;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    // GPU time per scope from timestamp queries, read back without waiting when a frame index comes back
+    // (framesInFlight frames later). Scope names must be string literals, they are kept as pointers
+    class LveGpuProfiler {
+    public:
+        static constexpr uint32_t MAX_SCOPES = 16;  // including the whole-frame scope
+        static constexpr uint32_t HISTORY_SIZE = 120;
+
+        struct ScopeResult {
+            const char* name;
+            double milliseconds;
+        };
+
+        struct FrameResults {
+            uint64_t frameNumber = 0;
+            std::vector<ScopeResult> scopes{};  // scopes[0] is the whole frame
+            bool hasStatistics = false;  // pipeline statistics queries, when the device supports them
+            uint64_t vertexInvocations = 0;
+            uint64_t fragmentInvocations = 0;
+        };
+
+        struct ScopeHistory {
+            const char* name;
+            std::vector<float> milliseconds;  // ring buffer of HISTORY_SIZE frames, oldest at historyOffset
+        };
+
+        LveGpuProfiler(LveDevice& device, int framesInFlight);
+        ~LveGpuProfiler();
+
+        LveGpuProfiler(const LveGpuProfiler&) = delete;
+        LveGpuProfiler& operator=(const LveGpuProfiler&) = delete;
+
+        bool isEnabled() const { return timestampPool != VK_NULL_HANDLE; }
+        void beginFrame(VkCommandBuffer commandBuffer, int frameIndex);
+        void endFrame(VkCommandBuffer commandBuffer);
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+        const FrameResults& getResults() const { return results; }  // latest completed frame, frameNumber 0 until the first one
+        bool readPendingResults();  // after vkDeviceWaitIdle: reads the oldest frame not read yet into getResults()
+        const std::vector<ScopeHistory>& getHistory() const { return history; }
+        uint32_t getHistoryOffset() const { return historyOffset; }
+
+    private:
+        struct FrameQueries {
+            std::vector<const char*> scopeNames{};
+            uint64_t frameNumber = 0;
+            bool written = false;  // recorded and not read back yet
+        };
+
+        void readResults(int frameIndex);
+
+        LveDevice& lveDevice;
+        VkQueryPool timestampPool = VK_NULL_HANDLE;
+        VkQueryPool statisticsPool = VK_NULL_HANDLE;
+        std::vector<FrameQueries> frames{};
+        std::vector<uint64_t> timestamps{};  // readback scratch, 2 per scope
+        uint64_t timestampMask = ~0ull;  // timestampValidBits of the graphics queue family, the counter wraps past them
+        int currentFrame = 0;
+        uint64_t frameCounter = 0;
+
+        FrameResults results{};
+        std::vector<ScopeHistory> history{};
+        uint32_t historyOffset = 0;
+    };
+}
@@ -3,6 +3,12 @@
 #include "lve_window.hpp"
 #include "lve_swap_chain.hpp"
 #include "lve_renderer.hpp"
+#include "lve_gpu_profiler.hpp"
+#include "lve_latency_counter.hpp"
+#include "lve_profiler.hpp"
+
+//std
+#include <vector>
 
 namespace lve {
     class LveImgui {
@@ -17,15 +23,33 @@ namespace lve {
         float getScaleSliderValue(int xyz);
         float getRotationSliderValue(int xyz);
         float getPositionSliderValue(int xyz);
+        bool isInteracting() const;  // a widget is being edited or dragged
+        void setGpuProfiler(const LveGpuProfiler* profiler) { gpuProfiler = profiler; }
+        void setLatencyCounter(const LveLatencyCounter* counter) { latencyCounter = counter; }
 
 
     private:
         void initImGui();
         void initInspector();
+        void drawGpuTimings();
+        void drawInputLatency();
+        void drawCpuFlameView();
+        void captureCpuFrame();
+
+        // the flame view draws a capture of one frame, refreshed on demand or every CPU_CAPTURE_INTERVAL frames:
+        // collecting every ring each frame would distort the timings it shows
+        static constexpr uint32_t CPU_CAPTURE_INTERVAL = 60;
 
         LveWindow& lveWindow;
         LveDevice& lveDevice;
         LveRenderer& lveRenderer;
         VkDescriptorPool imguiPool;
+        const LveGpuProfiler* gpuProfiler = nullptr;
+        const LveLatencyCounter* latencyCounter = nullptr;
+        std::vector<LveProfiler::ThreadZones> cpuCapture{};
+        int64_t cpuCaptureStart = 0;
+        int64_t cpuCaptureEnd = 0;
+        uint32_t framesSinceCpuCapture = 0;
+        bool autoCpuCapture = true;
     };
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+//std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lve {
+    // Counts the jobs still running for a batch; wait() on it helps with other jobs instead of blocking
+    struct LveJobCounter {
+        std::atomic<uint32_t> pending{ 0 };
+
+        bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    // One worker per core plus the thread that created the system (the main thread). Each of them owns a Chase-Lev deque:
+    // the owner pushes and pops at the bottom, idle threads steal from the top. Main-thread jobs (GLFW, ImGui) go to a
+    // separate queue only the main thread runs, from wait() or runMainThreadJobs()
+    class LveJobSystem {
+    public:
+        using JobFunction = std::function<void()>;
+        static constexpr uint32_t DEQUE_CAPACITY = 4096;  // per thread, power of two; a full deque runs the job inline
+
+        explicit LveJobSystem(uint32_t workerCount = 0);  // 0: one worker per core, minus the main thread
+        ~LveJobSystem();
+
+        LveJobSystem(const LveJobSystem&) = delete;
+        LveJobSystem& operator=(const LveJobSystem&) = delete;
+
+        void schedule(JobFunction function, LveJobCounter& counter);
+        void scheduleOnMainThread(JobFunction function, LveJobCounter& counter);
+        void wait(LveJobCounter& counter);
+        void runMainThreadJobs();
+        // calls function(begin, end) on slices of at most grainSize items of [0, count), in parallel, and waits
+        void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& function);
+
+        uint32_t getThreadCount() const { return static_cast<uint32_t>(queues.size()); }
+        bool isMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+
+    private:
+        struct Job {
+            JobFunction function;
+            LveJobCounter* counter = nullptr;
+            std::atomic<bool> free{ true };  // set once the job has run, possibly on another thread
+        };
+
+        struct MainThreadJob {
+            JobFunction function;
+            LveJobCounter* counter;
+        };
+
+        // Chase-Lev work-stealing deque of fixed capacity ("Dynamic Circular Work-Stealing Deque", without the growth)
+        class WorkStealingDeque {
+        public:
+            bool push(Job* job);
+            Job* pop();
+            Job* steal();
+
+        private:
+            std::atomic<int64_t> top{ 0 };
+            std::atomic<int64_t> bottom{ 0 };
+            std::unique_ptr<std::atomic<Job*>[]> buffer{ new std::atomic<Job*>[DEQUE_CAPACITY] };
+        };
+
+        struct ThreadQueue {
+            WorkStealingDeque deque{};
+            std::unique_ptr<Job[]> jobs{ new Job[DEQUE_CAPACITY * 2] };  // ring of job slots, recycled by the owner
+            uint32_t nextJob = 0;
+        };
+
+        Job* allocateJob(ThreadQueue& queue, JobFunction&& function, LveJobCounter& counter);
+        Job* findJob(uint32_t threadIndex);
+        void execute(Job* job);
+        void workerLoop(uint32_t threadIndex);
+        int32_t currentThreadIndex() const;
+
+        std::thread::id mainThreadId;
+        std::vector<std::unique_ptr<ThreadQueue>> queues{};  // index 0 is the main thread
+        std::vector<std::thread> workers{};
+        std::atomic<bool> stopping{ false };
+
+        std::mutex sleepMutex;
+        std::condition_variable wakeCondition;
+        std::atomic<uint32_t> queuedJobs{ 0 };
+
+        std::mutex mainThreadMutex;
+        std::vector<MainThreadJob> mainThreadJobs{};
+        std::vector<MainThreadJob> mainThreadRunning{};  // swapped with mainThreadJobs so that jobs run outside the lock
+    };
+}
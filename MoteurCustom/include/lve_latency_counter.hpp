@@ -0,0 +1,50 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+//std
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace lve {
+    // Input-to-GPU latency: time from the arrival of an input event to the completion of the first frame that used it.
+    // Completion is observed by polling the device timeline once per loop, so each sample is an upper bound
+    class LveLatencyCounter {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr uint32_t MAX_PENDING = 8;
+        static constexpr uint32_t HISTORY_SIZE = 120;
+
+        LveLatencyCounter(LveDevice& device);
+
+        LveLatencyCounter(const LveLatencyCounter&) = delete;
+        LveLatencyCounter& operator=(const LveLatencyCounter&) = delete;
+
+        // right after LveRenderer::endFrame, for a frame that latched input which arrived at inputArrival
+        void frameSubmitted(Clock::time_point inputArrival);
+        void update();
+
+        uint64_t getSampleCount() const { return sampleCount; }
+        double getLastMilliseconds() const { return lastMilliseconds; }
+        double getAverageMilliseconds() const { return sampleCount > 0 ? totalMilliseconds / sampleCount : 0.0; }
+        const std::array<float, HISTORY_SIZE>& getHistory() const { return history; }
+        uint32_t getHistoryOffset() const { return historyOffset; }
+
+    private:
+        struct Pending {
+            uint64_t timelineValue;
+            Clock::time_point inputArrival;
+        };
+
+        LveDevice& lveDevice;
+        std::array<Pending, MAX_PENDING> pending{};
+        uint32_t pendingCount = 0;
+
+        std::array<float, HISTORY_SIZE> history{};
+        uint32_t historyOffset = 0;
+        uint64_t sampleCount = 0;
+        double lastMilliseconds = 0.0;
+        double totalMilliseconds = 0.0;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+//std
+#include <vector>
+
+namespace lve {
+    struct MeshOptimizationStats {
+        float acmrBefore = 0.f;
+        float acmrAfter = 0.f;
+        float atvrBefore = 0.f;
+        float atvrAfter = 0.f;
+        size_t bytesBefore = 0;
+        size_t bytesAfter = 0;
+    };
+
+    class LveMeshOptimizer {
+    public:
+        static constexpr uint32_t CACHE_SIZE = 16;
+        static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+        static constexpr uint32_t DEFAULT_LOD_COUNT = 4;
+        static constexpr uint32_t MAX_CLUSTER_VERTICES = 64;
+        static constexpr uint32_t MAX_CLUSTER_TRIANGLES = 124;
+
+        static MeshOptimizationStats optimize(LveModel::Builder& builder);
+
+        static void generateLods(LveModel::Builder& builder, uint32_t lodCount = DEFAULT_LOD_COUNT);
+        static void buildClusters(LveModel::Builder& builder);
+        static std::vector<uint32_t> simplify(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float* resultError = nullptr);
+
+        static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+        static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices, float threshold = OVERDRAW_THRESHOLD);
+        static void optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+        static float computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+        static float computeATVR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+        static size_t computeByteSize(const LveModel::Builder& builder, bool allowShortIndices);
+
+    private:
+        static LveModel::Cluster computeClusterBounds(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, size_t first, size_t count);
+        static size_t countTransformedVertices(const std::vector<uint32_t>& indices, size_t first, size_t count, size_t vertexCount, uint32_t cacheSize);
+    };
+}
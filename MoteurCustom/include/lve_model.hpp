@@ -1,6 +1,7 @@
 #pragma once
 #include "lve_device.hpp"
 #include "lve_buffer.hpp"
+#include "lve_geometry_pool.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -11,6 +12,11 @@
 #include <memory>
 #include <vector>
 namespace lve {
+    enum class VertexLayout {
+        Full,   // 44 bytes, float32 everywhere
+        Packed  // 20 bytes, see LveModel::PackedVertex
+    };
+
     class LveModel {
     public:
         struct Vertex {
@@ -18,17 +24,44 @@ namespace lve {
             glm::vec3 color;
             glm::vec3 normal;
             glm::vec2 uv;
-            static std::vector<VkVertexInputBindingDescription>getBindingDescriptions();
-            static std::vector<VkVertexInputAttributeDescription>getAttributeDescriptions();
+            static std::vector<VkVertexInputBindingDescription>getBindingDescriptions(VertexLayout layout = VertexLayout::Full);
+            static std::vector<VkVertexInputAttributeDescription>getAttributeDescriptions(VertexLayout layout = VertexLayout::Full);
 
             bool operator == (const Vertex& other)const {
                 return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
             }
         };
 
+        // position is unorm16 relative to the model bounds, normal is octahedral snorm16
+        struct PackedVertex {
+            uint16_t position[4];
+            int16_t normal[2];
+            uint8_t color[4];
+            uint16_t uv[2];
+        };
+
+        // range of the shared index buffer, error is in model space units
+        struct Lod {
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            float error;
+        };
+
+        // std430 layout, read by shaders/cluster_cull.comp
+        struct Cluster {
+            glm::vec4 boundingSphere;  // xyz center in model space, w radius
+            glm::vec4 cone;            // xyz axis, w cutoff (1 = never back-facing)
+            uint32_t firstIndex;       // in the model index range, always inside LOD 0
+            uint32_t indexCount;
+            uint32_t padding[2];
+        };
+
         struct Builder {
             std::vector<Vertex> vertices{};
             std::vector<uint32_t> indices{};
+            std::vector<Lod> lods{};
+            std::vector<Cluster> clusters{};
+            VertexLayout layout = VertexLayout::Full;
 
             void loadModel(const std::string& filepath);
         };
@@ -39,20 +72,51 @@ namespace lve {
         LveModel(const LveModel&) = delete;
         LveModel& operator=(const LveModel&) = delete;
 
-        static std::unique_ptr <LveModel> createModelFromFile(LveDevice& device, const std::string& filePath);
+        // verbose: prints the LODs, the mesh optimization statistics and the cluster count
+        static std::unique_ptr <LveModel> createModelFromFile(LveDevice& device, const std::string& filePath, VertexLayout layout = VertexLayout::Full, bool verbose = false);
         void bind(VkCommandBuffer commandBuffer);
-        void draw(VkCommandBuffer commandBuffer);
+        // firstInstance selects the per-object data read by the vertex shader
+        void draw(VkCommandBuffer commandBuffer, uint32_t lod = 0, uint32_t firstInstance = 0);
+
+        // 0xFFFF is left unused: it is the primitive restart index for 16-bit index buffers
+        static bool canUseShortIndices(size_t vertexCount) { return vertexCount < 65536; }
+
+        VertexLayout getVertexLayout() const { return vertexLayout; }
+        VkIndexType getIndexType() const { return indexType; }
+        glm::mat4 getDequantizeMatrix() const { return dequantizeMatrix; }
+        uint32_t getLodCount() const { return static_cast<uint32_t>(lods.size()); }
+        const Lod& getLod(uint32_t lod) const { return lods[lod]; }
+        // xyz is the center in model space, w the radius
+        glm::vec4 getBoundingSphere() const { return boundingSphere; }
 
+        uint32_t getClusterCount() const { return clusterCount; }
+        uint32_t getFirstCluster() const;
+        uint32_t getFirstIndex() const;
+        int32_t getVertexOffset() const;
 
     private:
         void createVertexBuffers(const std::vector<Vertex>& vertices);
+        void createPackedVertexBuffers(const std::vector<Vertex>& vertices);
+        void uploadVertices(const void* data, uint32_t vertexSize);
         void createIndexBuffers(const std::vector<uint32_t>& indices);
+        void createClusterBuffers(const std::vector<Cluster>& clusters);
+        void computeBoundingSphere(const std::vector<Vertex>& vertices);
 
         LveDevice& lveDevice;
-        std::unique_ptr<LveBuffer> vertexBuffer;
+        LveGeometryPool& geometryPool;  // taken at construction: the device must not create a new pool while tearing down
+        LveGeometryPool::Handle vertexAllocation = LveGeometryPool::INVALID_HANDLE;
+        uint32_t vertexStride = sizeof(Vertex);
         uint32_t vertexCount;
+        VertexLayout vertexLayout = VertexLayout::Full;
+        glm::mat4 dequantizeMatrix{ 1.f };
         bool hasIndexBuffer = false;
-        std::unique_ptr<LveBuffer> indexBuffer;
+        LveGeometryPool::Handle indexAllocation = LveGeometryPool::INVALID_HANDLE;
+        uint32_t indexSizeBytes = sizeof(uint32_t);
         uint32_t indexCount;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+        std::vector<Lod> lods{};
+        glm::vec4 boundingSphere{ 0.f };
+        LveGeometryPool::Handle clusterAllocation = LveGeometryPool::INVALID_HANDLE;
+        uint32_t clusterCount = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+    // Color and depth images rendered to instead of a swap chain when running headless.
+    // Mirrors the part of LveSwapChain the renderer uses, one image per frame in flight
+    class LveOffscreenTarget {
+    public:
+        static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+        LveOffscreenTarget(LveDevice& deviceRef, VkExtent2D extent, int framesInFlight);
+        ~LveOffscreenTarget();
+
+        LveOffscreenTarget(const LveOffscreenTarget&) = delete;
+        LveOffscreenTarget& operator=(const LveOffscreenTarget&) = delete;
+
+        VkFramebuffer getFrameBuffer(int index) { return framebuffers[index]; }
+        VkRenderPass getRenderPass() { return renderPass; }
+        VkImage getColorImage(int index) { return colorImages[index]; }
+        size_t imageCount() { return colorImages.size(); }
+        VkExtent2D getExtent() { return extent; }
+        float extentAspectRatio() { return static_cast<float>(extent.width) / static_cast<float>(extent.height); }
+
+        void waitForLastSubmission();
+        VkResult acquireNextImage(uint32_t* imageIndex);
+        VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
+        std::vector<uint8_t> readPixels(int index);
+        int getLastImageIndex() const;  // image written by the last submission
+
+        // regression checks on the last submitted frame, as binary PPM (RGB8) files
+        void saveLastFrame(const std::string& filepath);
+        size_t compareLastFrame(const std::string& filepath, uint8_t tolerance);  // pixels differing by more than tolerance
+
+    private:
+        void createImages();
+        void createRenderPass();
+        void createFramebuffers();
+        VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask);
+        VkFormat findDepthFormat();
+        std::vector<uint8_t> readLastFrame();
+
+        LveDevice& device;
+        VkExtent2D extent;
+        VkFormat depthFormat;
+
+        std::vector<VkImage> colorImages;
+        std::vector<VkDeviceMemory> colorImageMemorys;
+        std::vector<VkImageView> colorImageViews;
+        std::vector<VkImage> depthImages;
+        std::vector<VkDeviceMemory> depthImageMemorys;
+        std::vector<VkImageView> depthImageViews;
+        std::vector<VkFramebuffer> framebuffers;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+
+        std::vector<uint64_t> frameTimelineValues;  // device timeline value of the last submission per image
+        size_t currentFrame = 0;
+    };
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "lve_device.hpp"
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 namespace lve {
+    class LveShaderModule;
+
     struct PipeLineConfigInfo {
         PipeLineConfigInfo(const PipeLineConfigInfo&) = delete;
         PipeLineConfigInfo& operator=(const PipeLineConfigInfo&) = delete;
@@ -24,12 +29,19 @@ namespace lve {
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
+        // specialization constants shared by the vertex and fragment stages
+        std::vector<VkSpecializationMapEntry> specializationEntries{};
+        std::vector<uint8_t> specializationData{};
 
     };
 
+    // constantId -> raw 32-bit value, overrides the specialization constants of the PipeLineConfigInfo
+    using SpecializationPermutation = std::vector<std::pair<uint32_t, uint32_t>>;
+
     class LvePipeline {
     public:
         LvePipeline(LveDevice& device, const std::string& vertFilePath, const std::string& fragFilePath, const PipeLineConfigInfo& configInfo);
+        LvePipeline(LveDevice& device, const std::string& compFilePath, VkPipelineLayout pipelineLayout);
         ~LvePipeline();
 
         LvePipeline(const LvePipeline&) = delete;
@@ -37,17 +49,28 @@ namespace lve {
         LvePipeline() = default;
 
         void bind(VkCommandBuffer(commandBuffer));
+        void bind(VkCommandBuffer commandBuffer, const SpecializationPermutation& permutation);
+        VkPipeline getPermutation(const SpecializationPermutation& permutation);
         static void defaultPipeLineConfigInfo(PipeLineConfigInfo& configInfo);
         static void enableAlphaBlending(PipeLineConfigInfo& configInfo);
+        static void setSpecializationConstant(PipeLineConfigInfo& configInfo, uint32_t constantId, uint32_t value);
+        static void setSpecializationConstant(PipeLineConfigInfo& configInfo, uint32_t constantId, float value);
 
     private:
-        static std::vector<char> readFile(const std::string& filepath);
         void createGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipeLineConfigInfo& configInfo);
-        void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
+        VkPipeline buildGraphicsPipeline(const PipeLineConfigInfo& configInfo, const std::vector<uint8_t>& specializationData);
+        void createComputePipeline(const std::string& compFilepath, VkPipelineLayout pipelineLayout);
 
         LveDevice& lveDevice;
         VkPipeline graphicsPipeline;
-        VkShaderModule vertShaderModule;
-        VkShaderModule fragShaderModule;
+        VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        std::shared_ptr<LveShaderModule> vertShaderModule{};
+        std::shared_ptr<LveShaderModule> fragShaderModule{};
+        std::shared_ptr<LveShaderModule> compShaderModule{};
+
+        // copy of the configuration, used to build the permutations on demand
+        std::unique_ptr<PipeLineConfigInfo> permutationConfig{};
+        std::map<std::vector<uint8_t>, VkPipeline> permutations{};
+        std::vector<uint8_t> specializationScratch{};  // lookup key, reused so that bind() does not allocate
     };
 }
\ No newline at end of file
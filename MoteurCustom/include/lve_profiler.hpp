@@ -0,0 +1,107 @@
+#pragma once
+
+#include "lve_alloc_tracker.hpp"
+
+//std
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU zones: LVE_PROFILE_SCOPE("name") times the enclosing block, LVE_PROFILE_FUNCTION() the enclosing function.
+// Without LVE_ENABLE_PROFILER (defined in Debug builds) both expand to nothing
+#ifdef LVE_ENABLE_PROFILER
+#define LVE_PROFILE_CONCAT_INNER(a, b) a##b
+#define LVE_PROFILE_CONCAT(a, b) LVE_PROFILE_CONCAT_INNER(a, b)
+#define LVE_PROFILE_SCOPE(name) ::lve::LveProfileScope LVE_PROFILE_CONCAT(lveProfileScope, __LINE__){ name }
+#define LVE_PROFILE_FUNCTION() LVE_PROFILE_SCOPE(__FUNCTION__)
+#define LVE_PROFILE_FRAME() ::lve::LveProfiler::get().markFrame()
+#else
+#define LVE_PROFILE_SCOPE(name) ((void)0)
+#define LVE_PROFILE_FUNCTION() ((void)0)
+#define LVE_PROFILE_FRAME() ((void)0)
+#endif
+
+namespace lve {
+    // Collects zones in one ring buffer per thread: the owning thread is the only writer and publishes with a release store,
+    // readers copy without locking and drop whatever was overwritten meanwhile. Zone names must be string literals
+    class LveProfiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr uint32_t RING_SIZE = 1 << 14;  // zones kept per thread, power of two
+        static constexpr uint32_t FRAME_HISTORY = 64;
+
+        struct Zone {
+            const char* name;
+            int64_t start;  // nanoseconds since the profiler was created
+            int64_t end;
+            uint32_t depth;
+            uint64_t allocations;  // heap allocations inside the zone, only counted with LVE_TRACK_ALLOCATIONS
+            uint64_t allocatedBytes;
+        };
+
+        struct ThreadZones {
+            uint32_t threadId;
+            std::vector<Zone> zones;  // oldest first
+        };
+
+        static LveProfiler& get();
+
+        LveProfiler(const LveProfiler&) = delete;
+        LveProfiler& operator=(const LveProfiler&) = delete;
+
+        int64_t now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count(); }
+        uint32_t enterZone();
+        void leaveZone(const char* name, int64_t start, uint32_t depth, const LveAllocTracker::Counters& allocations = {});
+        void markFrame();
+
+        std::vector<ThreadZones> collect() const;
+        bool lastFrame(int64_t& start, int64_t& end) const;  // bounds of the last complete frame
+        bool exportChromeTrace(const std::string& filepath) const;
+
+    private:
+        struct ThreadBuffer {
+            uint32_t threadId;
+            std::unique_ptr<Zone[]> zones{ new Zone[RING_SIZE] };
+            std::atomic<uint64_t> head{ 0 };  // zones written so far
+            uint32_t depth = 0;  // owning thread only
+        };
+
+        LveProfiler() = default;
+        ThreadBuffer& threadBuffer();
+
+        Clock::time_point origin = Clock::now();
+        mutable std::mutex threadsMutex;  // only taken when a thread records its first zone and by readers
+        std::vector<std::unique_ptr<ThreadBuffer>> threads{};
+        std::atomic<int64_t> frameMarks[FRAME_HISTORY]{};
+        std::atomic<uint64_t> frameCount{ 0 };
+    };
+
+    class LveProfileScope {
+    public:
+#ifdef LVE_TRACK_ALLOCATIONS
+        explicit LveProfileScope(const char* name) : name{ name }, depth{ LveProfiler::get().enterZone() }, start{ LveProfiler::get().now() }, allocations{ LveAllocTracker::thread() } {}
+        ~LveProfileScope() {
+            LveAllocTracker::Counters end = LveAllocTracker::thread();
+            LveProfiler::get().leaveZone(name, start, depth, { end.allocations - allocations.allocations, end.bytes - allocations.bytes });
+        }
+#else
+        explicit LveProfileScope(const char* name) : name{ name }, depth{ LveProfiler::get().enterZone() }, start{ LveProfiler::get().now() } {}
+        ~LveProfileScope() { LveProfiler::get().leaveZone(name, start, depth); }
+#endif
+
+        LveProfileScope(const LveProfileScope&) = delete;
+        LveProfileScope& operator=(const LveProfileScope&) = delete;
+
+    private:
+        const char* name;
+        uint32_t depth;
+        int64_t start;
+#ifdef LVE_TRACK_ALLOCATIONS
+        LveAllocTracker::Counters allocations;
+#endif
+    };
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// lib
+#include <vulkan/vulkan.h>
+
+//std
+#include <string>
+
+namespace lve {
+    // Runtime trade-offs between latency, smoothness and power, read from the command line:
+    //   --frames-in-flight <1-3>  --present-mode <fifo|fifo_relaxed|mailbox|immediate>  --fps <target, 0 = unlimited>  --low-latency
+    //   --headless  --resolution <width>x<height>  --frames <count, 0 = until the window is closed>
+    //   --benchmark <report.json>  --baseline <report.json>  --tolerance <fraction>  --cubes <n>  --lights <n>  --models <n>
+    //   --trace <trace.json>  --workers <n, 0 = one per core>  --idle  --verbose
+    //   --capture <image.ppm>  --reference <image.ppm>  --image-tolerance <0-255>
+    struct LveRenderConfig {
+        static constexpr uint32_t DEFAULT_FRAME_COUNT = 600;
+
+        int framesInFlight = 2;
+        // MAX_ENUM when not given: mailbox, then immediate, then FIFO; a mode set explicitly falls back to FIFO when unsupported
+        VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+        double targetFps = 0.0;
+        bool lowLatency = false;  // wait for the GPU right before sampling input instead of at the start of recording
+        bool headless = false;  // no window, surface or swap chain: renders into offscreen images (CI, render farms, lavapipe)
+        VkExtent2D headlessExtent{ 1280, 720 };
+        uint32_t frameCount = 0;  // headless and benchmark runs default to DEFAULT_FRAME_COUNT
+        // headless regression check: the last frame is written to captureImage and/or compared to referenceImage,
+        // the run fails if any pixel channel differs by more than imageTolerance
+        std::string captureImage;
+        std::string referenceImage;
+        uint32_t imageTolerance = 2;
+
+        // benchmark: procedural scene, scripted camera and fixed time step, frame time percentiles written as JSON
+        std::string benchmarkReport;
+        std::string benchmarkBaseline;  // previous report; slower percentiles are flagged as regressions
+        double regressionTolerance = 0.10;
+        uint32_t benchmarkCubes = 1000;
+        uint32_t benchmarkLights = 10;  // clamped to MAX_LIGHTS
+        uint32_t benchmarkModels = 4;
+
+        uint32_t workerThreads = 0;  // job system threads besides the main thread
+        std::string traceFile;  // CPU zones written as a Chrome trace on exit, needs LVE_ENABLE_PROFILER
+        bool idleMode = false;  // render only when something changed, block on window events otherwise (editor, tooling)
+        bool verbose = false;  // mesh statistics per model, pipeline creation time and pipeline cache size; implied by benchmarks
+
+        bool isBenchmark() const { return !benchmarkReport.empty(); }
+        bool isVerbose() const { return verbose || isBenchmark(); }
+
+        static LveRenderConfig fromCommandLine(int argc, char* argv[]);
+        static const char* presentModeName(VkPresentModeKHR presentMode);
+    };
+}
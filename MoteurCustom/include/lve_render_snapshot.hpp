@@ -0,0 +1,34 @@
+#pragma once
+
+#include "lve_game_object.hpp"
+
+//std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+    // What the render thread needs from one simulation step: the state of every drawable object and light.
+    // Written by the simulation thread, read-only once published through an LveTripleBuffer.
+    // The camera is not part of it: the render thread latches it from the latest input right before submitting
+    struct RenderSnapshot {
+        struct ObjectState {
+            LveGameObject::id_t id;
+            glm::vec3 translation;
+            glm::vec3 scale;
+            glm::vec3 rotation;
+            glm::vec3 color;
+            float lightIntensity;  // point lights only
+
+            bool operator==(const ObjectState&) const = default;
+        };
+
+        uint64_t step = 0;  // simulation step that produced this snapshot
+        std::vector<ObjectState> objects;  // keeps its capacity from one step to the next
+        // last step whose state differed from the step before it, carried by every later snapshot until the next change:
+        // a reader that skipped snapshots still sees a change it did not render
+        uint64_t lastChangeStep = 0;
+
+        void capture(uint64_t simulationStep, LveGameObject::Map& gameObjects);
+        void apply(LveGameObject::Map& renderObjects) const;
+    };
+}
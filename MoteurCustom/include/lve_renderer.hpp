@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lve_device.hpp"
+#include "lve_offscreen_target.hpp"
 #include "lve_swap_chain.hpp"
 #include "lve_window.hpp"
 
@@ -13,17 +14,24 @@
 namespace lve {
     class LveRenderer {
     public:
-        LveRenderer(LveWindow& window, LveDevice& device);
+        LveRenderer(LveWindow& window, LveDevice& device, const LveRenderConfig& config = {});
+        LveRenderer(LveWindow* window, LveDevice& device, const LveRenderConfig& config = {});  // nullptr: renders offscreen at config.headlessExtent
         ~LveRenderer();
 
         LveRenderer(const LveRenderer&) = delete;
         LveRenderer& operator=(const LveRenderer&) = delete;
 
-        VkRenderPass getSwapChainRenderPass() const { return lveSwapChain->getRenderPass(); }
-        float getAspectRatio() const { return lveSwapChain->extentAspectRatio(); }
+        VkRenderPass getSwapChainRenderPass() const { return offscreenTarget ? offscreenTarget->getRenderPass() : lveSwapChain->getRenderPass(); }
+        float getAspectRatio() const { return offscreenTarget ? offscreenTarget->extentAspectRatio() : lveSwapChain->extentAspectRatio(); }
+        VkExtent2D getExtent() const { return offscreenTarget ? offscreenTarget->getExtent() : lveSwapChain->getSwapChainExtent(); }
+        LveOffscreenTarget* getOffscreenTarget() const { return offscreenTarget.get(); }
         bool isFreameInProgres() const { return isFrameStarted; }
         VkCommandBuffer getCurrentCommandBuffer() const { assert(isFrameStarted && "Cannot get command buffer when frame not in progress"); return commandBuffers[currentFrameIndex]; }
         int getFrameIndex()const { assert(isFrameStarted && "Cannot get frame index when frame not in progress"); return currentFrameIndex; }
+        int getFramesInFlight() const { return config.framesInFlight; }
+        const LveRenderConfig& getConfig() const { return config; }
+
+        void waitForLastFrame() { offscreenTarget ? offscreenTarget->waitForLastSubmission() : lveSwapChain->waitForLastSubmission(); }
 
         VkCommandBuffer beginFrame();
         void endFrame();
@@ -32,18 +40,28 @@ namespace lve {
 
 
     private:
+        // swap chain replaced on resize, kept until the frames recorded with it have completed
+        struct RetiredSwapChain {
+            std::shared_ptr<LveSwapChain> swapChain;
+            uint64_t timelineValue;  // device timeline value of the last submission that used it
+        };
+
         void createCommandBuffers();
         void freeCommandBuffers();
         void recreateSwapChain();
+        void releaseRetiredSwapChains();
 
 
-        LveWindow& lveWindow;
+        LveWindow* lveWindow;
         LveDevice& lveDevice;
+        LveRenderConfig config;
         std::unique_ptr<LveSwapChain> lveSwapChain;
+        std::unique_ptr<LveOffscreenTarget> offscreenTarget;
+        std::vector<RetiredSwapChain> retiredSwapChains{};
         std::vector<VkCommandBuffer> commandBuffers;
 
         uint32_t currentImageIndex;
-        int currentFrameIndex;
-        bool isFrameStarted;
+        int currentFrameIndex = 0;
+        bool isFrameStarted = false;
     };
 }
\ No newline at end of file
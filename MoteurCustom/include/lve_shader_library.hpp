@@ -0,0 +1,54 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+//std
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace lve {
+    class LveShaderModule {
+    public:
+        LveShaderModule(LveDevice& device, VkShaderModule shaderModule);
+        ~LveShaderModule();
+
+        LveShaderModule(const LveShaderModule&) = delete;
+        LveShaderModule& operator=(const LveShaderModule&) = delete;
+
+        VkShaderModule getShaderModule() const { return shaderModule; }
+
+    private:
+        LveDevice& lveDevice;
+        VkShaderModule shaderModule;
+    };
+
+    // Creates each shader module once per SPIR-V content; modules live as long as a pipeline holds them.
+    // Entries keep no copy of the code: they are found by hash and size, and confirmed by their path, or by comparing
+    // the mapped file of another path, so a collision never returns the wrong module
+    class LveShaderLibrary {
+    public:
+        LveShaderLibrary(LveDevice& device);
+        ~LveShaderLibrary();
+
+        LveShaderLibrary(const LveShaderLibrary&) = delete;
+        LveShaderLibrary& operator=(const LveShaderLibrary&) = delete;
+
+        std::shared_ptr<LveShaderModule> load(const std::string& filepath);
+        size_t getModuleCount();
+
+    private:
+        struct CachedModule {
+            std::string path;
+            size_t size;
+            std::weak_ptr<LveShaderModule> module;
+        };
+
+        static uint64_t hashCode(const uint32_t* code, size_t codeSize);
+
+        LveDevice& lveDevice;
+        std::mutex mutex;
+        std::unordered_multimap<uint64_t, CachedModule> modules{};
+    };
+}
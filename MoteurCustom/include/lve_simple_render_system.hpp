@@ -5,29 +5,85 @@
 #include "lve_pipeline.hpp"
 #include "lve_game_object.hpp"
 #include "lve_frame_info.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_cluster_cull_system.hpp"
+#include "lve_transient_allocator.hpp"
 
 //std
 #include <memory>
 #include <vector>
 
 namespace lve {
+    enum class AttenuationModel : uint32_t {
+        None,
+        InverseSquare,
+        Smooth  // 1 / (1 + d^2)
+    };
+
+    // selects the permutation of simple_shader.frag, each combination is a separate pipeline
+    struct LightingFeatures {
+        uint32_t maxLights = MAX_LIGHTS;
+        bool specular = true;
+        float shininess = 512.f;
+        AttenuationModel attenuation = AttenuationModel::InverseSquare;
+
+        bool operator==(const LightingFeatures&) const = default;
+    };
+
+    // per-object data, read by simple_shader.vert at gl_InstanceIndex: each draw selects its object with firstInstance
+    struct ObjectInstance {
+        glm::mat4 modelMatrix{ 1.f };
+        glm::mat3x4 normalMatrix{ 1.f };  // mat3 with vec4 columns, as laid out in the shader
+        uint32_t materialIndex = 0;
+        uint32_t padding[3]{};  // std430 array stride
+    };
+
+    class LveJobSystem;
+
     class SimpleRenderSystem {
     public:
-        SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+        static constexpr uint32_t DRAW_GRAIN_SIZE = 64;  // objects per job in prepareDraws
+
+        SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout bindlessSetLayout = VK_NULL_HANDLE);
         ~SimpleRenderSystem();
         SimpleRenderSystem(const SimpleRenderSystem&) = delete;
         SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
+        void prepareDraws(FrameInfo& frameInfo, LveJobSystem* jobSystem = nullptr);
+        // objects of the prepared frame drawn from the cluster lists, for ClusterCullSystem::cull
+        const std::vector<ClusterCullSystem::CullObject>& getClusterObjects() const { return clusterObjects; }
         void renderGameObjects(FrameInfo& frameInfo);
+        void setLighting(const LightingFeatures& features);
 
 
     private:
         double getCurrentTime();
-        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout bindlessSetLayout);
+        void bindPipeline(VkCommandBuffer commandBuffer, VertexLayout layout);
         void createPipeline(VkRenderPass renderPass);
+        uint32_t selectLod(LveGameObject& obj, const LveCamera& camera);
+        SpecializationPermutation lightingPermutation() const;
+
+        // per-object work done before recording (LOD, instance data), so that it can run on the job system
+        struct DrawPacket {
+            LveGameObject* object;
+            LveGameObject::id_t id;
+            uint32_t lod = 0;
+            bool clustered = false;  // drawn from the cluster lists
+        };
 
         LveDevice& lveDevice;
         std::unique_ptr<LvePipeline> lvePipeline;
+        std::unique_ptr<LvePipeline> packedPipeline;
         VkPipelineLayout pipelineLayout;
+        std::unique_ptr<LveDescriptorSetLayout> instanceSetLayout{};  // set 1, allocated every frame from FrameInfo::frameDescriptors
+        LightingFeatures lighting{};
+        SpecializationPermutation permutation{};  // rebuilt only when the lighting changes
+        std::vector<DrawPacket> drawPackets{};  // keeps its capacity from one frame to the next
+        std::vector<ClusterCullSystem::CullObject> clusterObjects{};
+        LveTransientAllocator::Allocation instances{};  // one ObjectInstance per draw packet
+        VertexLayout boundLayout = VertexLayout::Full;
+        bool drawsPrepared = false;
+        bool bindless = false;
     };
 }
\ No newline at end of file
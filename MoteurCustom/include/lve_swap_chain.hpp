@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lve_device.hpp"
+#include "lve_render_config.hpp"
 
 // vulkan headers
 #include <vulkan/vulkan.h>
@@ -13,10 +14,11 @@
 namespace lve {
     class LveSwapChain {
     public:
-        static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+        // upper bound, the actual count comes from LveRenderConfig::framesInFlight
+        static constexpr int MAX_FRAMES_IN_FLIGHT = 3;
 
-        LveSwapChain(LveDevice& deviceRef, VkExtent2D windowExtent);
-        LveSwapChain(LveDevice& deviceRef, VkExtent2D windowExtent, std::shared_ptr<LveSwapChain>previous);
+        LveSwapChain(LveDevice& deviceRef, VkExtent2D windowExtent, const LveRenderConfig& config = {});
+        LveSwapChain(LveDevice& deviceRef, VkExtent2D windowExtent, std::shared_ptr<LveSwapChain>previous, const LveRenderConfig& config = {});
         ~LveSwapChain();
 
         LveSwapChain(const LveSwapChain&) = delete;
@@ -34,6 +36,10 @@ namespace lve {
         bool compareSwapFormats(const LveSwapChain& swapChain) const { return swapChain.swapChainDepthFormat == swapChainDepthFormat && swapChain.swapChainImageFormat == swapChainImageFormat; }
 
         VkFormat findDepthFormat();
+        int getFramesInFlight() const { return framesInFlight; }
+        VkPresentModeKHR getPresentMode() const { return presentMode; }
+
+        void waitForLastSubmission();
         VkResult acquireNextImage(uint32_t* imageIndex);
         VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
 
@@ -46,6 +52,7 @@ namespace lve {
         void createRenderPass();
         void createFramebuffers();
         void createSyncObjects();
+        void takeSyncObjects(LveSwapChain& previous);
 
         // Helper functions
         VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
@@ -57,7 +64,7 @@ namespace lve {
         VkExtent2D swapChainExtent;
 
         std::vector<VkFramebuffer> swapChainFramebuffers;
-        VkRenderPass renderPass;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
 
         std::vector<VkImage> depthImages;
         std::vector<VkDeviceMemory> depthImageMemorys;
@@ -67,14 +74,17 @@ namespace lve {
 
         LveDevice& device;
         VkExtent2D windowExtent;
+        int framesInFlight;
+        VkPresentModeKHR preferredPresentMode;
+        VkPresentModeKHR presentMode;
 
         VkSwapchainKHR swapChain;
         std::shared_ptr<LveSwapChain>oldSwapChain;
 
         std::vector<VkSemaphore> imageAvailableSemaphores;
         std::vector<VkSemaphore> renderFinishedSemaphores;
-        std::vector<VkFence> inFlightFences;
-        std::vector<VkFence> imagesInFlight;
+        std::vector<uint64_t> frameTimelineValues;  // device timeline value of the last submission per frame slot
+        std::vector<uint64_t> imageTimelineValues;  // same, per swap chain image
         size_t currentFrame = 0;
     };
 
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "lve_job_system.hpp"
+
+//std
+#include <initializer_list>
+#include <string_view>
+#include <vector>
+
+namespace lve {
+    // Tasks declare the resources they read and write; a task runs after every earlier task it conflicts with
+    // (write/read, read/write or write/write on the same resource). Built once, run every frame on the job system
+    class LveTaskGraph {
+    public:
+        using TaskFunction = LveJobSystem::JobFunction;
+
+        // name must be a string literal (it is also the profiler zone); mainThread for tasks that call GLFW or ImGui
+        uint32_t addTask(const char* name, TaskFunction function, std::initializer_list<std::string_view> reads,
+            std::initializer_list<std::string_view> writes, bool mainThread = false);
+        void run(LveJobSystem& jobSystem);
+
+        uint32_t getTaskCount() const { return static_cast<uint32_t>(tasks.size()); }
+        const std::vector<uint32_t>& getDependents(uint32_t task) const { return tasks[task].dependents; }
+
+    private:
+        struct Task {
+            const char* name;
+            TaskFunction function;
+            std::vector<std::string_view> reads;
+            std::vector<std::string_view> writes;
+            bool mainThread;
+            std::vector<uint32_t> dependents{};
+            uint32_t dependencyCount = 0;
+        };
+
+        void scheduleTask(LveJobSystem& jobSystem, uint32_t task);
+
+        std::vector<Task> tasks{};
+        std::unique_ptr<std::atomic<uint32_t>[]> remaining{};  // dependencies not finished yet, per task, during run()
+        uint32_t remainingCapacity = 0;
+        LveJobCounter counter{};
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+//std
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace lve {
+    // Linear allocator over one persistently mapped buffer per frame in flight.
+    // Everything allocated during a frame is released at once by beginFrame, after the frame fence
+    class LveTransientAllocator {
+    public:
+        struct Allocation {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceSize offset = 0;
+            VkDeviceSize size = 0;
+            void* mapped = nullptr;
+
+            uint32_t dynamicOffset() const { return static_cast<uint32_t>(offset); }
+            VkDescriptorBufferInfo descriptorInfo() const { return { buffer, offset, size }; }
+        };
+
+        static constexpr VkDeviceSize DEFAULT_FRAME_CAPACITY = 4 * 1024 * 1024;
+        static constexpr VkBufferUsageFlags USAGE = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+            | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+        LveTransientAllocator(LveDevice& device, int frameCount, VkDeviceSize frameCapacity = DEFAULT_FRAME_CAPACITY);
+        ~LveTransientAllocator();
+        LveTransientAllocator(const LveTransientAllocator&) = delete;
+        LveTransientAllocator& operator=(const LveTransientAllocator&) = delete;
+
+        void beginFrame(int frameIndex);
+        Allocation allocate(VkDeviceSize size, VkDeviceSize alignment);
+        Allocation allocateUniform(VkDeviceSize size);
+        Allocation allocateStorage(VkDeviceSize size);
+        void flush();
+
+        template<typename T>
+        Allocation pushUniform(const T& data) {
+            Allocation allocation = allocateUniform(sizeof(T));
+            std::memcpy(allocation.mapped, &data, sizeof(T));
+            return allocation;
+        }
+
+        // same buffer for the whole frame, so descriptors can be written once per frame index
+        VkBuffer getBuffer(int frameIndex) const { return frameBuffers[frameIndex]->getBuffer(); }
+        VkDeviceSize getFrameCapacity() const { return frameCapacity; }
+        VkDeviceSize getUsedSize() const { return head; }
+
+    private:
+        LveDevice& lveDevice;
+        VkDeviceSize frameCapacity;
+        std::vector<std::unique_ptr<LveBuffer>> frameBuffers{};
+
+        int currentFrame = 0;
+        VkDeviceSize head = 0;
+        VkDeviceSize flushedHead = 0;
+    };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+//std
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace lve {
+    // Single producer, single consumer hand-off without locks: the producer fills the back slot and swaps it with the
+    // shared middle slot, the consumer swaps the middle slot with its front slot when it holds a newer value.
+    // Neither side ever waits for the other unless it asks to (lockstep runs)
+    template <typename T>
+    class LveTripleBuffer {
+    public:
+        LveTripleBuffer() = default;
+
+        LveTripleBuffer(const LveTripleBuffer&) = delete;
+        LveTripleBuffer& operator=(const LveTripleBuffer&) = delete;
+
+        // producer side
+        T& writeBuffer() { return slots[back]; }
+        void publish() {
+            uint8_t previous = swapMiddle(back | FRESH_BIT);
+            back = previous & INDEX_MASK;
+            middle.notify_all();
+        }
+        // blocks until the consumer took the last published value; false once closed
+        bool waitUntilConsumed() {
+            uint8_t current = middle.load(std::memory_order_acquire);
+            while ((current & FRESH_BIT) && !(current & CLOSED_BIT)) {
+                middle.wait(current, std::memory_order_acquire);
+                current = middle.load(std::memory_order_acquire);
+            }
+            return !(current & CLOSED_BIT);
+        }
+
+        // consumer side
+        const T& readBuffer() const { return slots[front]; }
+        // true if a newer value was published since the last update
+        bool update() {
+            if (!(middle.load(std::memory_order_relaxed) & FRESH_BIT)) {
+                return false;
+            }
+            uint8_t previous = swapMiddle(front);
+            front = previous & INDEX_MASK;
+            middle.notify_all();
+            return true;
+        }
+        // blocks until a newer value is published; false once closed
+        bool waitForUpdate() {
+            uint8_t current = middle.load(std::memory_order_acquire);
+            while (!(current & FRESH_BIT) && !(current & CLOSED_BIT)) {
+                middle.wait(current, std::memory_order_acquire);
+                current = middle.load(std::memory_order_acquire);
+            }
+            return update();
+        }
+
+        // wakes both sides for good, called when either one stops
+        void close() {
+            middle.fetch_or(CLOSED_BIT, std::memory_order_acq_rel);
+            middle.notify_all();
+        }
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 0x3;
+        static constexpr uint8_t FRESH_BIT = 0x4;
+        static constexpr uint8_t CLOSED_BIT = 0x8;
+
+        // keeps CLOSED_BIT, replaces the slot index and the fresh flag
+        uint8_t swapMiddle(uint8_t value) {
+            uint8_t expected = middle.load(std::memory_order_relaxed);
+            while (!middle.compare_exchange_weak(expected, static_cast<uint8_t>((expected & CLOSED_BIT) | value),
+                std::memory_order_acq_rel, std::memory_order_relaxed)) {
+            }
+            return expected;
+        }
+
+        std::array<T, 3> slots{};
+        alignas(64) uint8_t back = 0;  // producer only
+        alignas(64) std::atomic<uint8_t> middle{ 1 };
+        alignas(64) uint8_t front = 2;  // consumer only
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdio>
 #include <functional>
+#include <ostream>
 
 namespace lve {
 
@@ -11,4 +13,21 @@ namespace lve {
         (hashCombine(seed, rest), ...);
     };
 
+    // writes text as a quoted JSON string: quotes, backslashes and control characters are escaped
+    inline void writeJsonString(std::ostream& out, const char* text) {
+        out << '"';
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\') {
+                out << '\\' << *c;
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                out << escaped;
+            } else {
+                out << *c;
+            }
+        }
+        out << '"';
+    }
+
 }  // namespace lve
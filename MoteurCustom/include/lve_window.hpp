@@ -3,11 +3,14 @@
 #include <vulkan/vulkan.h>
 #define GLFW_INLCUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <string>
 
 namespace lve {
     class LveWindow {
     public:
+        using Clock = std::chrono::steady_clock;
+
         LveWindow(int w, int h, std::string name);
         ~LveWindow();
 
@@ -19,17 +22,29 @@ namespace lve {
         bool wasWindowResized() { return frambufferResized; }
         void resetWindowResizedFlag() { frambufferResized = false; }
         GLFWwindow* getGLFWwindow() const { return window; }
+        // arrival time of the first key event since the last call; false if none arrived
+        bool takeInputEvent(Clock::time_point& arrival);
+        // true if any input or resize event arrived since the last call (idle mode)
+        bool takeActivity();
 
         void createWindowSurface(VkInstance instance, VkSurfaceKHR* surface);
 
 
     private:
         static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+        static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+        static void cursorPosCallback(GLFWwindow* window, double x, double y);
+        static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+        static void scrollCallback(GLFWwindow* window, double x, double y);
+        static void markActivity(GLFWwindow* window);
         void initWindow();
 
         int width;
         int height;
         bool frambufferResized = false;
+        bool hasInputEvent = false;
+        bool hasActivity = false;
+        Clock::time_point inputEventTime{};
 
         std::string windowName;
         GLFWwindow* window;
@@ -20,6 +20,7 @@ namespace lve {
         PointLightSystem(const PointLightSystem&) = delete;
         PointLightSystem& operator=(const PointLightSystem&) = delete;
 
+        static void animateLights(LveGameObject::Map& gameObjects, float dt);  // simulation side
         void update(FrameInfo& frameInfo, GlobalUbo& ubo);
         void render(FrameInfo& frameInfo);
 
@@ -4,11 +4,10 @@
 #include <iostream>
 #include <stdexcept>
 
-int main() {
-    // Changer "lve_swap_chain.cpp" --> "chooseSwapSurfaceFormat()" en "..._SRGB" ou "..._UNORM"
-    lve::FirstApp app{};
-
+int main(int argc, char* argv[]) {
     try {
+        // Changer "lve_swap_chain.cpp" --> "chooseSwapSurfaceFormat()" en "..._SRGB" ou "..._UNORM"
+        lve::FirstApp app{ lve::LveRenderConfig::fromCommandLine(argc, argv) };
         app.run();
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -1,6 +1,14 @@
+@echo off
 echo Compile Shader
-C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\simple_shader.vert -o .\shaders\SPIR-V\simple_shader.vert.spv
-C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\simple_shader.frag -o .\shaders\SPIR-V\simple_shader.frag.spv
-C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\point_light.vert -o .\shaders\SPIR-V\point_light.vert.spv
-C:\VulkanSDK\1.3.268.0\Bin\glslc.exe .\shaders\point_light.frag -o .\shaders\SPIR-V\point_light.frag.spv
-pause
\ No newline at end of file
+rem chemins relatifs au projet, quel que soit le repertoire courant ; glslc du SDK installe s'il est connu
+cd /d "%~dp0.."
+set GLSLC=C:\VulkanSDK\1.3.268.0\Bin\glslc.exe
+if defined VULKAN_SDK set GLSLC=%VULKAN_SDK%\Bin\glslc.exe
+rem une erreur de compilation fait echouer la compilation du projet au lieu de laisser un .spv perime
+"%GLSLC%" .\shaders\simple_shader.vert -o .\shaders\SPIR-V\simple_shader.vert.spv || exit /b 1
+"%GLSLC%" .\shaders\simple_shader.frag -o .\shaders\SPIR-V\simple_shader.frag.spv || exit /b 1
+"%GLSLC%" -DBINDLESS .\shaders\simple_shader.frag -o .\shaders\SPIR-V\simple_shader_bindless.frag.spv || exit /b 1
+"%GLSLC%" .\shaders\point_light.vert -o .\shaders\SPIR-V\point_light.vert.spv || exit /b 1
+"%GLSLC%" .\shaders\point_light.frag -o .\shaders\SPIR-V\point_light.frag.spv || exit /b 1
+"%GLSLC%" .\shaders\cluster_cull.comp -o .\shaders\SPIR-V\cluster_cull.comp.spv || exit /b 1
+if not "%1"=="nopause" pause
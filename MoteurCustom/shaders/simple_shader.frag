@@ -1,11 +1,24 @@
 #version 450
 
+#ifdef BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
+
 layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragPosWorld;
 layout (location = 2) in vec3 fragNormalWorld;
+layout (location = 3) in vec2 fragUv;
+layout (location = 4) flat in uint fragMaterialIndex; // index in the bindless buffers, unused otherwise
 
 layout (location = 0) out vec4 outColor;
 
+// lighting permutation, set by SimpleRenderSystem (see LightingFeatures)
+layout(constant_id = 1) const int MAX_LIGHTS = 10;
+layout(constant_id = 2) const bool SPECULAR = true;
+layout(constant_id = 3) const float SHININESS = 512.0;
+// 0: none, 1: inverse square, 2: smooth inverse square (no peak close to the light)
+layout(constant_id = 4) const int ATTENUATION_MODEL = 1;
+
 struct PointLight {
   vec4 position; // ignore w
   vec4 color; // w is intensity
@@ -20,10 +33,14 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
   int numLights;
 } ubo;
 
-layout(push_constant) uniform Push {
-  mat4 modelMatrix;
-  mat4 normalMatrix;
-} push;
+#ifdef BINDLESS
+// compiled with -DBINDLESS: materials and textures come from the bindless set, see LveBindlessTable
+layout(set = 2, binding = 0) uniform sampler2D textures[];
+layout(set = 2, binding = 1) readonly buffer MaterialBuffer {
+  vec4 baseColor;
+  uint textureIndex; // 0xFFFFFFFF when the material has no texture
+} materials[];
+#endif
 
 void main() {
   vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
@@ -32,10 +49,17 @@ void main() {
 
   vec3 cameraPosWorld = ubo.invView[3].xyz;
   vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
-  for (int i = 0; i < ubo.numLights; i++) {
+  for (int i = 0; i < MAX_LIGHTS; i++) {
+    if (i >= ubo.numLights) break;
     PointLight light = ubo.pointLights[i];
     vec3 directionToLight = light.position.xyz - fragPosWorld;
-    float attenuation = 1.0 / dot(directionToLight, directionToLight); // distance squared
+    float distanceSquared = dot(directionToLight, directionToLight);
+    float attenuation = 1.0;
+    if (ATTENUATION_MODEL == 1) {
+      attenuation = 1.0 / distanceSquared;
+    } else if (ATTENUATION_MODEL == 2) {
+      attenuation = 1.0 / (1.0 + distanceSquared);
+    }
     directionToLight = normalize(directionToLight);
 
     float cosAngIncidence = max(dot(surfaceNormal, directionToLight), 0);
@@ -43,11 +67,22 @@ void main() {
 
     diffuseLight += intensity * cosAngIncidence;
     // specular lighting
-    vec3 halfAngle = normalize(directionToLight + viewDirection);
-    float blinnTerm = dot(surfaceNormal, halfAngle);
-    blinnTerm = clamp(blinnTerm, 0, 1);
-    blinnTerm = pow(blinnTerm, 512.0); // higher values -> sharper highlight
-    specularLight += intensity * blinnTerm;
+    if (SPECULAR) {
+      vec3 halfAngle = normalize(directionToLight + viewDirection);
+      float blinnTerm = dot(surfaceNormal, halfAngle);
+      blinnTerm = clamp(blinnTerm, 0, 1);
+      blinnTerm = pow(blinnTerm, SHININESS); // higher values -> sharper highlight
+      specularLight += intensity * blinnTerm;
+    }
+  }
+  vec3 surfaceColor = fragColor;
+#ifdef BINDLESS
+  vec4 baseColor = materials[nonuniformEXT(fragMaterialIndex)].baseColor;
+  uint textureIndex = materials[nonuniformEXT(fragMaterialIndex)].textureIndex;
+  if (textureIndex != 0xFFFFFFFFu) {
+    baseColor *= texture(textures[nonuniformEXT(textureIndex)], fragUv);
   }
-  outColor = vec4(diffuseLight * fragColor + specularLight * fragColor, 1.0);
+  surfaceColor *= baseColor.rgb;
+#endif
+  outColor = vec4(diffuseLight * surfaceColor + specularLight * surfaceColor, 1.0);
 }
\ No newline at end of file
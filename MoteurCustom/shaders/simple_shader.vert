@@ -1,5 +1,9 @@
 #version 450
 
+// packed layout: position is unorm16 in model bounds (dequantized by modelMatrix),
+// normal is octahedral snorm16 in normal.xy
+layout(constant_id = 0) const bool PACKED_VERTEX = false;
+
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
 layout(location = 2) in vec3 normal;
@@ -8,6 +12,8 @@ layout(location = 3) in vec2 uv;
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec3 fragPosWorld;
 layout(location = 2) out vec3 fragNormalWorld;
+layout(location = 3) out vec2 fragUv;
+layout(location = 4) flat out uint fragMaterialIndex;
 
 struct PointLight
 {
@@ -24,15 +30,33 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
   int numLights;
 } ubo;
 
-layout(push_constant) uniform Push {
+// one per object, selected by the firstInstance of the draw (see ObjectInstance)
+struct ObjectInstance {
   mat4 modelMatrix;
-  mat4 normalMatrix;
-} push;
+  mat3x4 normalMatrix; // mat3 stored with vec4 columns
+  uint materialIndex;  // index in the bindless buffers, unused otherwise
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer ObjectInstances {
+  ObjectInstance instances[];
+};
+
+vec3 octDecode(vec2 e) {
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if (n.z < 0.0) {
+    n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return normalize(n);
+}
 
 void main() {
-  vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+  vec3 vertexNormal = PACKED_VERTEX ? octDecode(normal.xy) : normal;
+  ObjectInstance instance = instances[gl_InstanceIndex];
+  vec4 positionWorld = instance.modelMatrix * vec4(position, 1.0);
   gl_Position = ubo.projection * ubo.view * positionWorld;
-  fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+  fragNormalWorld = normalize(mat3(instance.normalMatrix) * vertexNormal);
   fragPosWorld = positionWorld.xyz;
   fragColor = color;
+  fragUv = uv;
+  fragMaterialIndex = instance.materialIndex;
 }
\ No newline at end of file
@@ -2,17 +2,45 @@
 
 namespace lve {
     /// <summary>
-    /// Implmente la logique de dplacement et de rotation de l'objet en fonction des touches du clavier et du temps coul depuis la dernire mise  jour.
+    /// Lit l'état des touches de KeyMappings. Doit être appelé sur le thread principal, comme toute fonction d'entrée de GLFW
+    /// </summary>
+    /// <param name="window"></param>
+    /// <returns></returns>
+    uint32_t KeyboardMovementController::sampleActions(GLFWwindow* window) const {
+        uint32_t actions = 0;
+        if (glfwGetKey(window, keys.moveLeft) == GLFW_PRESS) actions |= MoveLeft;
+        if (glfwGetKey(window, keys.moveRight) == GLFW_PRESS) actions |= MoveRight;
+        if (glfwGetKey(window, keys.moveForward) == GLFW_PRESS) actions |= MoveForward;
+        if (glfwGetKey(window, keys.moveBackward) == GLFW_PRESS) actions |= MoveBackward;
+        if (glfwGetKey(window, keys.moveUp) == GLFW_PRESS) actions |= MoveUp;
+        if (glfwGetKey(window, keys.moveDown) == GLFW_PRESS) actions |= MoveDown;
+        if (glfwGetKey(window, keys.lookLeft) == GLFW_PRESS) actions |= LookLeft;
+        if (glfwGetKey(window, keys.lookRight) == GLFW_PRESS) actions |= LookRight;
+        if (glfwGetKey(window, keys.lookUp) == GLFW_PRESS) actions |= LookUp;
+        if (glfwGetKey(window, keys.lookDown) == GLFW_PRESS) actions |= LookDown;
+        return actions;
+    }
+    /// <summary>
+    /// Déplace l'objet d'après les touches enfoncées dans la fenêtre
     /// </summary>
     /// <param name="window"></param>
     /// <param name="dt"></param>
     /// <param name="gameObject"></param>
     void KeyboardMovementController::moveInPanelXZ(GLFWwindow* window, float dt, LveGameObject& gameObject) {
+        moveInPanelXZ(sampleActions(window), dt, gameObject);
+    }
+    /// <summary>
+    /// Implémente la logique de déplacement et de rotation de l'objet en fonction des touches du clavier et du temps écoulé depuis la dernière mise à jour.
+    /// </summary>
+    /// <param name="actions">touches enfoncées, voir sampleActions</param>
+    /// <param name="dt"></param>
+    /// <param name="gameObject"></param>
+    void KeyboardMovementController::moveInPanelXZ(uint32_t actions, float dt, LveGameObject& gameObject) {
         glm::vec3 rotate{ 0 };
-        if (glfwGetKey(window, keys.lookRight) == GLFW_PRESS) rotate.y += 1.0f;
-        if (glfwGetKey(window, keys.lookLeft) == GLFW_PRESS) rotate.y -= 1.0f;
-        if (glfwGetKey(window, keys.lookUp) == GLFW_PRESS) rotate.x += 1.0f;
-        if (glfwGetKey(window, keys.lookDown) == GLFW_PRESS) rotate.x -= 1.0f;
+        if (actions & LookRight) rotate.y += 1.0f;
+        if (actions & LookLeft) rotate.y -= 1.0f;
+        if (actions & LookUp) rotate.x += 1.0f;
+        if (actions & LookDown) rotate.x -= 1.0f;
 
         if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) {
             gameObject.transform.rotation += lookSpeed * dt * glm::normalize(rotate);
@@ -27,12 +55,12 @@ namespace lve {
         const glm::vec3 upDir{ 0.0f, -1.0f, 0.0f };
 
         glm::vec3 moveDir{ 0.0f };
-        if (glfwGetKey(window, keys.moveForward) == GLFW_PRESS) moveDir += forwardDir;
-        if (glfwGetKey(window, keys.moveBackward) == GLFW_PRESS) moveDir -= forwardDir;
-        if (glfwGetKey(window, keys.moveRight) == GLFW_PRESS) moveDir += rightDir;
-        if (glfwGetKey(window, keys.moveLeft) == GLFW_PRESS) moveDir -= rightDir;
-        if (glfwGetKey(window, keys.moveUp) == GLFW_PRESS) moveDir += upDir;
-        if (glfwGetKey(window, keys.moveDown) == GLFW_PRESS) moveDir -= upDir;
+        if (actions & MoveForward) moveDir += forwardDir;
+        if (actions & MoveBackward) moveDir -= forwardDir;
+        if (actions & MoveRight) moveDir += rightDir;
+        if (actions & MoveLeft) moveDir -= rightDir;
+        if (actions & MoveUp) moveDir += upDir;
+        if (actions & MoveDown) moveDir -= upDir;
 
         if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
             gameObject.transform.translation += moveSpeed * dt * glm::normalize(moveDir);
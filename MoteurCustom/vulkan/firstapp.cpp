@@ -1,9 +1,17 @@
 #include "firstapp.hpp"
 #include "lve_simple_render_system.hpp"
 #include "point_light_system.hpp"
+#include "lve_cluster_cull_system.hpp"
+#include "lve_bindless_table.hpp"
+#include "lve_transient_allocator.hpp"
+#include "lve_frame_arena.hpp"
+#include "lve_task_graph.hpp"
+#include "lve_frame_limiter.hpp"
 #include "lve_camera.hpp"
 #include "Keyboard_movement_controller.hpp"
 #include "lve_buffer.hpp"
+#include "lve_profiler.hpp"
+#include "lve_alloc_tracker.hpp"
 #include "Colision.hpp"
 
 //std
@@ -15,6 +23,9 @@
 #include <vector>
 #include <numeric>
 #include <iostream>
+#include <future>
+#include <cstring>
+#include <thread>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
@@ -31,133 +42,410 @@
 
 namespace lve {
 
-    FirstApp::FirstApp() {
-        globalPool = LveDescriptorPool::Builder(lveDevice).setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+    FirstApp::FirstApp(const LveRenderConfig& config) : renderConfig{ config } {
+        globalAllocator = LveDescriptorAllocator::Builder(lveDevice).setInitialSets(lveRenderer.getFramesInFlight())
+            .addPoolRatio(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.f)
             .build();
-        loadGameObjects();
+        // ensembles de descripteurs à durée de vie d'une trame, libérés en bloc au retour de la trame :
+        // ceux du culling des clusters, qui pointent sur des tampons remplacés quand ils s'agrandissent, et les données des objets
+        for (int i = 0; i < lveRenderer.getFramesInFlight(); i++) {
+            frameAllocators.push_back(LveDescriptorAllocator::Builder(lveDevice)
+                .addPoolRatio(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3.f)
+                .build());
+        }
+        if (lveImgui) {
+            lveImgui->setGpuProfiler(&gpuProfiler);
+            lveImgui->setLatencyCounter(&latencyCounter);
+        }
+        if (renderConfig.isBenchmark()) {
+            benchmark = std::make_unique<LveBenchmark>(lveDevice, renderConfig);
+            loadBenchmarkScene();
+        } else {
+            loadGameObjects();
+        }
     }
 
     FirstApp::~FirstApp() {}
 
     /// <summary>
-    /// Fonction principale pour excuter l'application, gre l'initialisation, la boucle principale, et la libration des ressources.
+    /// Fonction principale pour exécuter l'application, gère l'initialisation, la boucle principale, et la libération des ressources.
     /// </summary>
     void FirstApp::run() {
-        std::vector < std::unique_ptr<LveBuffer>>uboBuffers(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-        for (int i = 0; i < uboBuffers.size(); i++) {
-            uboBuffers[i] = std::make_unique<LveBuffer>(lveDevice, sizeof(GlobalUbo), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-            uboBuffers[i]->map();
-        }
-        auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice).addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+        // données temporaires de la trame (GlobalUbo, données par objet...) : l'UBO global est lu à un dynamic offset dans le tampon de la trame
+        LveTransientAllocator transientAllocator{ lveDevice, lveRenderer.getFramesInFlight() };
+        LveFrameArena frameArena{};
+        auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice).addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT)
             .build();
 
-        std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        std::vector<VkDescriptorSet> globalDescriptorSets(lveRenderer.getFramesInFlight());
         for (int i = 0; i < globalDescriptorSets.size(); i++) {
-            auto bufferInfo = uboBuffers[i]->descriptorInfo();
-            LveDescriptorWriter(*globalSetLayout, *globalPool)
+            VkDescriptorBufferInfo bufferInfo{ transientAllocator.getBuffer(i), 0, sizeof(GlobalUbo) };
+            LveDescriptorWriter(*globalSetLayout, *globalAllocator)
                 .writeBuffer(0, &bufferInfo)
                 .build(globalDescriptorSets[i]);
         }
 
+        // mode bindless (si le GPU supporte le descriptor indexing) : chaque matériau est une plage du tampon de matériaux,
+        // enregistrée dans la table bindless ; les objets ne portent que l'indice du matériau
+        std::unique_ptr<LveBindlessTable> bindlessTable{};
+        std::unique_ptr<LveBuffer> materialBuffer{};
+        if (lveDevice.supportsBindless()) {
+            bindlessTable = std::make_unique<LveBindlessTable>(lveDevice);
+            materialBuffer = std::make_unique<LveBuffer>(lveDevice, sizeof(BindlessMaterial), 1, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, lveDevice.properties.limits.minStorageBufferOffsetAlignment);
+            materialBuffer->map();
+            BindlessMaterial defaultMaterial{};
+            materialBuffer->writeToIndex(&defaultMaterial, 0);
+            materialBuffer->flushIndex(0);
+            uint32_t defaultMaterialIndex = bindlessTable->addBuffer(materialBuffer->descriptorInfoForIndex(0));
+            for (auto& kv : gameObjects) {
+                kv.second.materialIndex = defaultMaterialIndex;
+            }
+        }
+
         //SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
 
-        SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(),globalSetLayout->getDescriptorSetLayout() };
-        PointLightSystem pointLightSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(),globalSetLayout->getDescriptorSetLayout() };
+        // les pipelines des systèmes sont indépendants : ils sont créés en parallèle, le cache de pipelines du device est thread-safe
+        auto pipelinesStart = std::chrono::steady_clock::now();
+        VkRenderPass renderPass = lveRenderer.getSwapChainRenderPass();
+        VkDescriptorSetLayout globalLayout = globalSetLayout->getDescriptorSetLayout();
+        VkDescriptorSetLayout bindlessLayout = bindlessTable ? bindlessTable->getSetLayout() : VK_NULL_HANDLE;
+        auto simpleRenderSystemTask = std::async(std::launch::async, [&] { return std::make_unique<SimpleRenderSystem>(lveDevice, renderPass, globalLayout, bindlessLayout); });
+        auto pointLightSystemTask = std::async(std::launch::async, [&] { return std::make_unique<PointLightSystem>(lveDevice, renderPass, globalLayout); });
+        auto clusterCullSystemTask = std::async(std::launch::async, [&] { return std::make_unique<ClusterCullSystem>(lveDevice, globalLayout); });
+        auto simpleRenderSystem = simpleRenderSystemTask.get();
+        auto pointLightSystem = pointLightSystemTask.get();
+        auto clusterCullSystem = clusterCullSystemTask.get();
+        if (renderConfig.isVerbose()) {
+            std::cout << "Pipelines created in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelinesStart).count() << " ms"
+                << " (pipeline cache: " << lveDevice.getPipelineCacheLoadedBytes() << " bytes loaded)" << std::endl;
+        }
         LveCamera camera{};
-
         auto viewerObject = LveGameObject::createGameObject();
         viewerObject.transform.translation.z = -5.5f;
         viewerObject.transform.translation.y = -3.5f;
         viewerObject.transform.rotation.x = -0.5f;
-        KeyboardMovementController cameraController{};
-
-
-        double lag = 0.0, previous = getCurrentTime(), current = 0.0, secondeCount = 0.0f;
-        float gameObjectsIncrement = 1.0f;
-        int etatClavier = 0;
-        auto cubeMovement = gameObjects.find(0);
-        cubeMovement->second.transform.vitesse = { 0.016f, 0.016f, 0.f };
-        cubeMovement->second.transform.friction = 0.94f;
-        while (!lveWindow.shouldClose()) {
-            current = getCurrentTime();
-            lag += current - previous;
-            previous = current;
-
-            while (lag >= MS_PER_UPDATE) {
-                cameraController.moveInPanelXZ(lveWindow.getGLFWwindow(), (float)lag, viewerObject);
+        LveFrameLimiter frameLimiter{ renderConfig.targetFps };
+        LightingFeatures lighting{};
+
+        // préparation d'une trame en graphe de tâches : les lumières et les dessins n'ont pas de ressource en commun et
+        // s'exécutent en parallèle, l'envoi du GlobalUbo attend les lumières et les dessins (qui réservent aussi dans le tampon transitoire).
+        // L'enregistrement des commandes reste sur ce thread
+        FrameInfo* currentFrame = nullptr;
+        GlobalUbo ubo{};
+        LveTransientAllocator::Allocation globalUbo{};
+        LveTaskGraph frameGraph{};
+        frameGraph.addTask("PointLightSystem::update", [&]() { pointLightSystem->update(*currentFrame, ubo); }, { "lights" }, { "ubo" });
+        frameGraph.addTask("SimpleRenderSystem::prepareDraws", [&]() { simpleRenderSystem->prepareDraws(*currentFrame, &jobSystem); }, { "camera", "models" }, { "draws", "transient" });
+        frameGraph.addTask("GlobalUbo", [&]() {
+            lighting.maxLights = static_cast<uint32_t>(ubo.numLights);
+            simpleRenderSystem->setLighting(lighting);
+            // la place est réservée ici pour connaître le dynamic offset ; le contenu est écrit juste avant la soumission
+            globalUbo = transientAllocator.allocateUniform(sizeof(GlobalUbo));
+            currentFrame->globalUboOffset = globalUbo.dynamicOffset();
+        }, { "ubo" }, { "lighting", "transient" });
+
+        // à partir d'ici la simulation tourne sur son propre thread et gameObjects lui appartient : ce thread ne rend que
+        // ses propres copies des objets, mises à jour depuis le dernier instantané publié. La trame N est enregistrée et
+        // soumise pendant que la simulation calcule l'étape suivante
+        for (auto& kv : gameObjects) {
+            renderObjects.emplace(kv.first, kv.second.makeRenderProxy());
+        }
+        // headless et benchmark : une étape de simulation par trame rendue, aucune n'est sautée ni rendue deux fois
+        bool lockstep = renderConfig.headless || benchmark;
+        std::jthread simulationThread{ [this](std::stop_token stopToken) { simulate(stopToken); } };
+
+        uint32_t renderedFrames = 0;
+        bool hasSnapshot = false;
+        uint64_t renderedChangeStep = ~0ull;  // lastChangeStep du dernier instantané appliqué
+        // mode veille : rien n'est acquis, enregistré ni soumis tant que rien n'a changé (entrées, interface, objets, lumières)
+        uint32_t dirtyFrames = IDLE_GRACE_FRAMES;
+        double previous = getCurrentTime();
+        // la caméra suit les entrées au plus tard : une première fois avant le culling CPU, puis de nouveau juste avant
+        // la soumission, où la vue est écrite dans le GlobalUbo. Le déplacement intègre le temps écoulé depuis le dernier relevé
+        auto lastLatch = std::chrono::steady_clock::now();
+        auto latchCamera = [&]() {
+            auto now = std::chrono::steady_clock::now();
+            float dt = std::chrono::duration<float>(now - lastLatch).count();
+            lastLatch = now;
+            if (benchmark) {
+                benchmark->updateCamera(renderedFrames, camera);
+            } else {
+                if (lveWindow) {
+                    cameraController.moveInPanelXZ(lveWindow->getGLFWwindow(), dt, viewerObject);
+                }
                 camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
-
-
-                gameObjects.find(5)->second.transform.translation = {lveImgui.getPositionSliderValue(0), lveImgui.getPositionSliderValue(1), lveImgui.getPositionSliderValue(2)};
-                gameObjects.find(5)->second.transform.rotation = {lveImgui.getRotationSliderValue(0), lveImgui.getRotationSliderValue(1), lveImgui.getRotationSliderValue(2)};
-                gameObjects.find(5)->second.transform.scale = {lveImgui.getScaleSliderValue(0), lveImgui.getScaleSliderValue(1), lveImgui.getScaleSliderValue(2)};
-               
-
-                //petit test des colisions sur des cubes
-                for (auto items = gameObjects.find(1); items != gameObjects.cend(); items++) {
-                    if (cubeMovement->second.transform.colisionBox.isIntersectAABB(items->second.transform.colisionBox)) {
-                        cubeMovement->second.transform.bouncingAABB(items->second.transform.colisionBox);
-                        cubeMovement->second.transform.updateAcceleration();
-                    }
+            }
+            float aspect = lveRenderer.getAspectRatio();
+            //camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
+            camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
+        };
+        // headless : pas de fenêtre à fermer, on s'arrête après renderConfig.frameCount trames
+        auto keepRunning = [&]() {
+            bool framesLeft = renderConfig.frameCount == 0 || renderedFrames < renderConfig.frameCount;
+            return framesLeft && (!lveWindow || !lveWindow->shouldClose());
+        };
+        while (keepRunning()) {
+            LVE_PROFILE_FRAME();
+            latencyCounter.update();
+#ifdef LVE_TRACK_ALLOCATIONS
+            // le contrôle des régions sans allocation commence une fois les caches (permutations, pools) remplis
+            LveAllocTracker::markFrame();
+            LveAllocTracker::setEnforced(renderedFrames >= LveAllocTracker::WARMUP_FRAMES);
+#endif
+            if (renderConfig.idleMode && dirtyFrames == 0) {
+                // bloque jusqu'au prochain évènement de la fenêtre, ou jusqu'au réveil par la simulation
+                LVE_PROFILE_SCOPE("Idle");
+                glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+            } else {
+                LVE_PROFILE_SCOPE("FrameLimiter");
+                frameLimiter.wait();
+            }
+            if (renderConfig.lowLatency) {
+                // attend le GPU avant de lire les entrées, plutôt qu'au début de l'enregistrement : la trame part d'entrées plus récentes
+                lveRenderer.waitForLastFrame();
+            }
+            if (lveWindow) {
+                // GLFW ne se lit que sur le thread principal : les entrées sont relevées ici et transmises à la simulation
+                glfwPollEvents();
+                SimulationInput& input = inputs.writeBuffer();
+                input.spacePressed = glfwGetKey(lveWindow->getGLFWwindow(), GLFW_KEY_SPACE) == GLFW_PRESS;
+                input.hasSliders = lveImgui && !benchmark;
+                if (input.hasSliders) {
+                    input.sliderPosition = { lveImgui->getPositionSliderValue(0), lveImgui->getPositionSliderValue(1), lveImgui->getPositionSliderValue(2) };
+                    input.sliderRotation = { lveImgui->getRotationSliderValue(0), lveImgui->getRotationSliderValue(1), lveImgui->getRotationSliderValue(2) };
+                    input.sliderScale = { lveImgui->getScaleSliderValue(0), lveImgui->getScaleSliderValue(1), lveImgui->getScaleSliderValue(2) };
                 }
+                inputs.publish();
+            }
 
-                //Appelle de la fonction de dclaration sur le cube en mouvement toute les secondes
-                if (secondeCount >= 1) {
-                    cubeMovement->second.transform.updateAcceleration();
-                    secondeCount = 0.0f;
+            bool sceneChanged = false;
+            {
+                LVE_PROFILE_SCOPE("Snapshot");
+                // sans lockstep, le dernier instantané publié est rendu, ou le précédent si la simulation n'a pas avancé
+                bool fresh = (lockstep || !hasSnapshot) ? snapshots.waitForUpdate() : snapshots.update();
+                hasSnapshot = true;
+                if (fresh) {
+                    const RenderSnapshot& snapshot = snapshots.readBuffer();
+                    snapshot.apply(renderObjects);
+                    // comparé au dernier instantané lu, pas au précédent publié : les instantanés sautés comptent aussi
+                    sceneChanged = snapshot.lastChangeStep != renderedChangeStep;
+                    renderedChangeStep = snapshot.lastChangeStep;
                 }
+            }
+            if (renderConfig.idleMode) {
+                bool dirty = sceneChanged || lveWindow->takeActivity() || (lveImgui && lveImgui->isInteracting())
+                    || cameraController.sampleActions(lveWindow->getGLFWwindow()) != 0;
+                if (dirty) {
+                    dirtyFrames = IDLE_GRACE_FRAMES;
+                }
+                if (dirtyFrames == 0) {
+                    // trame sautée : la caméra ne doit pas rattraper le temps passé en veille au prochain relevé
+                    lastLatch = std::chrono::steady_clock::now();
+                    continue;
+                }
+                dirtyFrames--;
+            }
+            latchCamera();
 
-                //Fonction qui update les dplacement du cube
-                cubeMovement->second.transform.update();
-                
-                glfwPollEvents();
-
-                //Relance du cube lorsque l'on apuis sur la touche espace
-                //Dtection de l'instant o l'on releve la touche espace
-                if ((glfwGetKey(lveWindow.getGLFWwindow(), GLFW_KEY_SPACE)) == GLFW_RELEASE && etatClavier == GLFW_PRESS) {
-                    gameObjectsIncrement = -gameObjectsIncrement;
-                    etatClavier = GLFW_RELEASE;
+            double current = getCurrentTime();
+            float frameTime = lockstep ? static_cast<float>(MS_PER_UPDATE) : static_cast<float>(current - previous);
+            previous = current;
+            if (auto commandBuffer = lveRenderer.beginFrame()) {
+                LVE_PROFILE_SCOPE("Render");
+                int frameIndex = lveRenderer.getFrameIndex();
+                // beginFrame a attendu la fence de cette trame : ses ensembles ne sont plus utilisés par le GPU
+                frameAllocators[frameIndex]->reset();
+                transientAllocator.beginFrame(frameIndex);
+                // données CPU temporaires : rien de la trame précédente n'est encore utilisé
+                frameArena.reset();
+                FrameInfo frameInfo{ frameIndex, frameTime, commandBuffer, camera, globalDescriptorSets[frameIndex], renderObjects, clusterCullSystem.get(), frameAllocators[frameIndex].get(),
+                    bindlessTable ? bindlessTable->getDescriptorSet() : VK_NULL_HANDLE, &transientAllocator };
+                frameInfo.frameArena = &frameArena;
+                // déplace au plus une allocation de géométrie par trame pour résorber la fragmentation,
+                // avant que le graphe ne lise les offsets des modèles
+                lveDevice.getGeometryPool().compactStep(commandBuffer);
+                FrameStats frameStats{};
+                // les résultats lus ici sont ceux de la dernière trame de même indice, déjà terminée
+                gpuProfiler.beginFrame(commandBuffer, frameIndex);
+                if (benchmark) {
+                    frameInfo.stats = &frameStats;
+                    benchmark->beginFrame();
+                    benchmark->recordGpuResults(gpuProfiler.getResults());
                 }
 
-                if ((etatClavier = glfwGetKey(lveWindow.getGLFWwindow(), GLFW_KEY_SPACE)) == GLFW_PRESS) {
-                    cubeMovement->second.transform.setTranslation({ 0.01f * gameObjectsIncrement,  0.499f * gameObjectsIncrement, 2.5f });
-                    cubeMovement->second.transform.vitesse = { 0.016f,  0.016f , 0.0f };
+                //update
+                ubo = GlobalUbo{};
+                currentFrame = &frameInfo;
+                frameGraph.run(jobSystem);
+
+                //culling des clusters, hors de la render pass
+                uint32_t cullScope = gpuProfiler.beginScope(commandBuffer, "ClusterCull");
+                clusterCullSystem->cull(frameInfo, simpleRenderSystem->getClusterObjects());
+                gpuProfiler.endScope(commandBuffer, cullScope);
+
+                //render
+                lveRenderer.beginSwapChainRenderPass(commandBuffer);
+
+                // order matters
+                uint32_t scope = gpuProfiler.beginScope(commandBuffer, "SimpleRenderSystem");
+                simpleRenderSystem->renderGameObjects(frameInfo);
+                gpuProfiler.endScope(commandBuffer, scope);
+                scope = gpuProfiler.beginScope(commandBuffer, "PointLightSystem");
+                pointLightSystem->render(frameInfo);
+                gpuProfiler.endScope(commandBuffer, scope);
+                if (lveImgui) {
+                    scope = gpuProfiler.beginScope(commandBuffer, "ImGui");
+                    lveImgui->renderImGui(commandBuffer);
+                    gpuProfiler.endScope(commandBuffer, scope);
                 }
 
-                float aspect = lveRenderer.getAspectRatio();
-                //camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
-                camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 100.f);
-                if (auto commandBuffer = lveRenderer.beginFrame()) {
-                    int frameIndex = lveRenderer.getFrameIndex();
-                    FrameInfo frameInfo{ frameIndex, static_cast<float>(lag), commandBuffer, camera, globalDescriptorSets[frameIndex], gameObjects };
+                lveRenderer.endSwapChainRenderPass(commandBuffer);
+                gpuProfiler.endFrame(commandBuffer);
+                if (benchmark) {
+                    benchmark->endFrame(frameStats);
+                }
 
-                    //update
-                    GlobalUbo ubo{};
+                // late latch : dernières entrées, puis vue écrite dans le GlobalUbo déjà référencé par les commandes.
+                // Le culling CPU a utilisé le premier relevé, l'écart est d'une fraction de trame
+                LveWindow::Clock::time_point inputArrival{};
+                bool latchedInput = false;
+                {
+                    LVE_PROFILE_SCOPE("LateLatch");
+                    if (lveWindow) {
+                        glfwPollEvents();
+                        latchedInput = lveWindow->takeInputEvent(inputArrival);
+                    }
+                    latchCamera();
                     ubo.projection = camera.getProjection();
                     ubo.view = camera.getView();
                     ubo.inverseView = camera.getInverseView();
-                    pointLightSystem.update(frameInfo, ubo);
-                    uboBuffers[frameIndex]->writeToBuffer(&ubo);
-                    uboBuffers[frameIndex]->flush();
+                    std::memcpy(globalUbo.mapped, &ubo, sizeof(GlobalUbo));
+                }
+                // seules les plages écrites pendant la trame sont flushées, avant la soumission
+                transientAllocator.flush();
+                lveRenderer.endFrame();
+                if (latchedInput) {
+                    latencyCounter.frameSubmitted(inputArrival);
+                }
+                renderedFrames++;
+            }
+        }
+        if (benchmark) {
+            benchmark->endRun();
+        }
+        // réveille la simulation si elle attend que son instantané soit lu, puis attend la fin de son étape
+        simulationThread.request_stop();
+        simulationThread.join();
+        vkDeviceWaitIdle(lveDevice.getDevice());
+#ifdef LVE_ENABLE_PROFILER
+        if (!renderConfig.traceFile.empty() && !LveProfiler::get().exportChromeTrace(renderConfig.traceFile)) {
+            std::cout << "failed to write trace: " << renderConfig.traceFile << std::endl;
+        }
+#else
+        if (!renderConfig.traceFile.empty()) {
+            std::cout << "--trace ignored: build without LVE_ENABLE_PROFILER" << std::endl;
+        }
+#endif
+        if (latencyCounter.getSampleCount() > 0) {
+            std::cout << "Input latency: " << latencyCounter.getAverageMilliseconds() << " ms average over " << latencyCounter.getSampleCount() << " inputs" << std::endl;
+        }
+        if (LveOffscreenTarget* offscreenTarget = lveRenderer.getOffscreenTarget()) {
+            if (!renderConfig.captureImage.empty()) {
+                offscreenTarget->saveLastFrame(renderConfig.captureImage);
+            }
+            if (!renderConfig.referenceImage.empty()) {
+                size_t different = offscreenTarget->compareLastFrame(renderConfig.referenceImage, static_cast<uint8_t>(renderConfig.imageTolerance));
+                if (different > 0) {
+                    throw std::runtime_error("rendered image differs from " + renderConfig.referenceImage + " on " + std::to_string(different) + " pixels!");
+                }
+            }
+        }
+        if (benchmark && !benchmark->finish(lveRenderer.getExtent(), gpuProfiler)) {
+            throw std::runtime_error("benchmark regressed against " + renderConfig.benchmarkBaseline + "!");
+        }
+    }
 
-                    //render
-                    lveRenderer.beginSwapChainRenderPass(commandBuffer);
+    /// <summary>
+    /// Boucle de simulation, sur son propre thread : un pas fixe de MS_PER_UPDATE (colisions, cube, lumières),
+    /// puis un instantané publié pour le rendu. Cadencée à 60 pas par seconde, sauf en lockstep où elle attend que
+    /// le rendu ait pris l'instantané précédent : elle a alors une étape d'avance sur la trame enregistrée
+    /// </summary>
+    /// <param name="stopToken"></param>
+    void FirstApp::simulate(std::stop_token stopToken) {
+        bool lockstep = renderConfig.headless || benchmark;
+        // le thread de rendu demande l'arrêt : la simulation ne doit pas rester bloquée sur un instantané jamais lu
+        std::stop_callback closeSnapshots{ stopToken, [this]() { snapshots.close(); } };
+        LveFrameLimiter tickLimiter{ lockstep ? 0.0 : SECOND / MS_PER_UPDATE };
+
+        double secondeCount = 0.0;
+        float gameObjectsIncrement = 1.0f;
+        bool spaceWasPressed = false;
+        std::vector<RenderSnapshot::ObjectState> previousObjects{};
+        uint64_t lastChangeStep = 0;
+        auto cubeMovement = gameObjects.find(0);
+        cubeMovement->second.transform.vitesse = { 0.016f, 0.016f, 0.f };
+        cubeMovement->second.transform.friction = 0.94f;
+
+        for (uint64_t step = 0; !stopToken.stop_requested(); step++) {
+            tickLimiter.wait();
+            LVE_PROFILE_SCOPE("Update");
+            inputs.update();
+            const SimulationInput& input = inputs.readBuffer();
 
-                    // order matters
-                    simpleRenderSystem.renderGameObjects(frameInfo);
-                    pointLightSystem.render(frameInfo);
-                    lveImgui.renderImGui(commandBuffer);
+            if (input.hasSliders) {
+                gameObjects.find(5)->second.transform.translation = input.sliderPosition;
+                gameObjects.find(5)->second.transform.rotation = input.sliderRotation;
+                gameObjects.find(5)->second.transform.scale = input.sliderScale;
+            }
 
-                    lveRenderer.endSwapChainRenderPass(commandBuffer);
-                    lveRenderer.endFrame();
+            //petit test des colisions sur des cubes
+            for (auto items = gameObjects.find(1); items != gameObjects.cend(); items++) {
+                if (cubeMovement->second.transform.colisionBox.isIntersectAABB(items->second.transform.colisionBox)) {
+                    cubeMovement->second.transform.bouncingAABB(items->second.transform.colisionBox);
+                    cubeMovement->second.transform.updateAcceleration();
                 }
-               /* secondeCount += lag;*/
-                lag -= MS_PER_UPDATE;
             }
 
+            //Appelle de la fonction de décélaration sur le cube en mouvement toute les secondes
+            if (secondeCount >= 1) {
+                cubeMovement->second.transform.updateAcceleration();
+                secondeCount = 0.0f;
+            }
+
+            //Fonction qui update les déplacement du cube
+            cubeMovement->second.transform.update();
+
+            //Relance du cube lorsque l'on apuis sur la touche espace
+            //Détection de l'instant où l'on releve la touche espace
+            if (!input.spacePressed && spaceWasPressed) {
+                gameObjectsIncrement = -gameObjectsIncrement;
+            }
+            if (input.spacePressed) {
+                cubeMovement->second.transform.setTranslation({ 0.01f * gameObjectsIncrement,  0.499f * gameObjectsIncrement, 2.5f });
+                cubeMovement->second.transform.vitesse = { 0.016f,  0.016f , 0.0f };
+            }
+            spaceWasPressed = input.spacePressed;
+
+            PointLightSystem::animateLights(gameObjects, static_cast<float>(MS_PER_UPDATE));
+
+            RenderSnapshot& snapshot = snapshots.writeBuffer();
+            snapshot.capture(step, gameObjects);
+            // comparé à l'étape précédente, gardée ici : le slot réutilisé contient une étape plus ancienne
+            bool changed = step == 0 || snapshot.objects != previousObjects;
+            if (changed) {
+                lastChangeStep = step;
+                previousObjects = snapshot.objects;
+            }
+            snapshot.lastChangeStep = lastChangeStep;
+            snapshots.publish();
+            if (changed && renderConfig.idleMode) {
+                // le rendu peut être bloqué dans glfwWaitEventsTimeout ; glfwPostEmptyEvent peut être appelée depuis n'importe quel thread
+                glfwPostEmptyEvent();
+            }
+            if (lockstep && !snapshots.waitUntilConsumed()) {
+                break;
+            }
         }
-        vkDeviceWaitIdle(lveDevice.getDevice());
     }
 
     /// <summary>
@@ -217,12 +505,12 @@ namespace lve {
     }
 
     /// <summary>
-    /// chargement de tous les objects de la scne
+    /// chargement de tous les objects de la scène
     /// </summary>
     void FirstApp::loadGameObjects() {
         loadCubesCollision();
 
-        std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/NOEL1.obj");
+        std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/NOEL1.obj", VertexLayout::Packed, renderConfig.isVerbose());
         auto gameObject = LveGameObject::createGameObject();
         gameObject.model = lveModel;
         gameObject.transform.translation = { .0f,1.5f,.0f };
@@ -230,14 +518,14 @@ namespace lve {
 
         gameObjects.emplace(gameObject.getId(), std::move(gameObject));
 
-        lveModel = LveModel::createModelFromFile(lveDevice, "models/quad_model.obj");
+        lveModel = LveModel::createModelFromFile(lveDevice, "models/quad_model.obj", VertexLayout::Full, renderConfig.isVerbose());
         auto floor = LveGameObject::createGameObject();
         floor.model = lveModel;
         floor.transform.translation = { 0.f, .5f, 0.f };
         floor.transform.scale = { 3.f, 3.f, 3.f };
         gameObjects.emplace(floor.getId(), std::move(floor));
 
-        // cercle de lumire
+        // cercle de lumière
         std::vector<glm::vec3> lightColors{
             {1.f, .1f, .1f},
             {.1f, .1f, 1.f},
@@ -256,13 +544,22 @@ namespace lve {
         }
     }
 
+    /// <summary>
+    /// Scène du benchmark : les cubes de la démo des collisions (la boucle les anime), puis la scène procédurale
+    /// </summary>
+    void FirstApp::loadBenchmarkScene() {
+        loadCubesCollision();
+        std::shared_ptr<LveModel> cubeModel = createCubeModel(lveDevice, { .0f, .0f, .0f });
+        std::shared_ptr<LveModel> objModel = renderConfig.benchmarkModels > 0 ? LveModel::createModelFromFile(lveDevice, LveBenchmark::MODEL_PATH, VertexLayout::Packed, renderConfig.isVerbose()) : nullptr;
+        benchmark->buildScene(gameObjects, cubeModel, objModel);
+    }
     /// <summary>
     /// Chargement des cubes pour la demo des colisions 
     /// </summary>
     void FirstApp::loadCubesCollision() {
         std::shared_ptr<LveModel> lveModel = createCubeModel(lveDevice, { .0f, -4.f, -5.f });
 
-        //cube au centre de l'crant
+        //cube au centre de l'écrant
         auto cube = LveGameObject::createGameObject();
         cube.model = lveModel;
         cube.transform.setTransform({ 0.0f,0.5f,2.5f }, { .5f,.5f,.5f });
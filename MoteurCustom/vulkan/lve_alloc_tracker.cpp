@@ -0,0 +1,137 @@
+#include "lve_alloc_tracker.hpp"
+
+//std
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace lve {
+    // compteurs du thread : types triviaux, donc utilisables depuis operator new sans initialisation dynamique
+    static thread_local LveAllocTracker::Counters threadCounters{};
+    static thread_local LveAllocTracker::Counters frameStartCounters{};
+    static thread_local const char* noAllocRegion = nullptr;
+    static std::atomic<uint64_t> lastFrameAllocations{ 0 };
+    static std::atomic<uint64_t> lastFrameBytes{ 0 };
+    static std::atomic<bool> enforced{ false };
+
+    /// <summary>
+    /// Compte une allocation du thread courant ; dans une région sans allocation (et si le contrôle est actif), échoue sur un assert
+    /// </summary>
+    /// <param name="size"></param>
+    static void recordAllocation(std::size_t size) {
+        threadCounters.allocations++;
+        threadCounters.bytes += size;
+        if (noAllocRegion && enforced.load(std::memory_order_relaxed)) {
+            std::fprintf(stderr, "allocation of %zu bytes inside steady-state region %s\n", size, noAllocRegion);
+            assert(false && "Heap allocation inside a steady-state region");
+        }
+    }
+
+    LveAllocTracker::Counters LveAllocTracker::thread() {
+        return threadCounters;
+    }
+    /// <summary>
+    /// Termine la trame du thread appelant (la boucle principale) : les allocations depuis l'appel précédent deviennent lastFrame()
+    /// </summary>
+    void LveAllocTracker::markFrame() {
+        lastFrameAllocations.store(threadCounters.allocations - frameStartCounters.allocations, std::memory_order_relaxed);
+        lastFrameBytes.store(threadCounters.bytes - frameStartCounters.bytes, std::memory_order_relaxed);
+        frameStartCounters = threadCounters;
+    }
+
+    LveAllocTracker::Counters LveAllocTracker::lastFrame() {
+        return { lastFrameAllocations.load(std::memory_order_relaxed), lastFrameBytes.load(std::memory_order_relaxed) };
+    }
+    /// <summary>
+    /// Active le contrôle des régions sans allocation, une fois les caches remplis (voir WARMUP_FRAMES)
+    /// </summary>
+    /// <param name="value"></param>
+    void LveAllocTracker::setEnforced(bool value) {
+        enforced.store(value, std::memory_order_relaxed);
+    }
+
+    bool LveAllocTracker::isEnforced() {
+        return enforced.load(std::memory_order_relaxed);
+    }
+
+    void LveAllocTracker::enterNoAlloc(const char* name) {
+        noAllocRegion = name;
+    }
+
+    void LveAllocTracker::leaveNoAlloc(const char* previous) {
+        noAllocRegion = previous;
+    }
+
+    const char* LveAllocTracker::currentNoAlloc() {
+        return noAllocRegion;
+    }
+}
+
+#ifdef LVE_TRACK_ALLOCATIONS
+// remplacement des opérateurs globaux : toutes les allocations C++ du processus passent par recordAllocation
+static void* trackedAlloc(std::size_t size) {
+    lve::recordAllocation(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* trackedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+    lve::recordAllocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+static void trackedAlignedFree(void* ptr) {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    if (void* ptr = trackedAlloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAlloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = trackedAlignedAlloc(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { trackedAlignedFree(ptr); }
+#endif
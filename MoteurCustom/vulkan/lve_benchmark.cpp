@@ -0,0 +1,276 @@
+#include "lve_benchmark.hpp"
+#include "lve_utils.hpp"
+
+//std
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+// lib
+#include <glm/gtc/constants.hpp>
+
+namespace lve {
+    LveBenchmark::LveBenchmark(LveDevice& device, const LveRenderConfig& config) : lveDevice{ device }, config{ config } {
+        if (!lveDevice.properties.limits.timestampComputeAndGraphics) {
+            std::cout << "benchmark: timestamps not supported, GPU times will be missing" << std::endl;
+        }
+    }
+
+    /// <summary>
+    /// Ajoute la scène procédurale : une grille de config.benchmarkCubes cubes (un seul modèle partagé),
+    /// un anneau de config.benchmarkLights lumières et config.benchmarkModels instances du modèle OBJ. Aucun aléatoire :
+    /// deux exécutions avec les mêmes options rendent exactement la même chose
+    /// </summary>
+    /// <param name="gameObjects"></param>
+    /// <param name="cubeModel"></param>
+    /// <param name="objModel">peut être nul si config.benchmarkModels vaut 0</param>
+    void LveBenchmark::buildScene(LveGameObject::Map& gameObjects, std::shared_ptr<LveModel> cubeModel, std::shared_ptr<LveModel> objModel) {
+        uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(config.benchmarkCubes))));
+        float half = 0.5f * CUBE_SPACING * static_cast<float>(side == 0 ? 0 : side - 1);
+        sceneRadius = half + 5.f;
+
+        for (uint32_t i = 0; i < config.benchmarkCubes; i++) {
+            auto cube = LveGameObject::createGameObject();
+            cube.model = cubeModel;
+            glm::vec3 position{ CUBE_SPACING * (i % side) - half, 1.f, CUBE_SPACING * (i / side) - half };
+            cube.transform.setTransform(position, { .5f, .5f, .5f });
+            gameObjects.emplace(cube.getId(), std::move(cube));
+        }
+
+        uint32_t lightCount = std::min(config.benchmarkLights, static_cast<uint32_t>(MAX_LIGHTS));
+        for (uint32_t i = 0; i < lightCount; i++) {
+            auto pointLight = LveGameObject::makePointLight(0.5f);
+            float angle = glm::two_pi<float>() * i / lightCount;
+            pointLight.color = { 0.5f + 0.5f * std::cos(angle), 0.5f + 0.5f * std::sin(angle), 1.f };
+            pointLight.transform.translation = { 0.6f * sceneRadius * std::cos(angle), -1.5f, 0.6f * sceneRadius * std::sin(angle) };
+            gameObjects.emplace(pointLight.getId(), std::move(pointLight));
+        }
+
+        for (uint32_t i = 0; objModel && i < config.benchmarkModels; i++) {
+            auto gameObject = LveGameObject::createGameObject();
+            gameObject.model = objModel;
+            float angle = glm::two_pi<float>() * i / config.benchmarkModels;
+            gameObject.transform.translation = { 0.3f * sceneRadius * std::cos(angle), .5f, 0.3f * sceneRadius * std::sin(angle) };
+            gameObject.transform.scale = { .5f, .5f, .5f };
+            gameObjects.emplace(gameObject.getId(), std::move(gameObject));
+        }
+    }
+    /// <summary>
+    /// Caméra scriptée : un tour complet autour de la scène sur config.frameCount trames, en regardant le centre
+    /// </summary>
+    /// <param name="frame"></param>
+    /// <param name="camera"></param>
+    void LveBenchmark::updateCamera(uint32_t frame, LveCamera& camera) const {
+        float angle = glm::two_pi<float>() * frame / std::max(config.frameCount, 1u);
+        glm::vec3 position{ sceneRadius * std::cos(angle), -0.4f * sceneRadius, sceneRadius * std::sin(angle) };
+        camera.setViewTarget(position, glm::vec3{ 0.f });
+    }
+    /// <summary>
+    /// Début d'une trame, après LveRenderer::beginFrame. Le temps CPU est la durée d'une itération complète de la boucle :
+    /// celui de la trame précédente (frameNumber - 1) est relevé ici, celui de la dernière par endRun
+    /// </summary>
+    void LveBenchmark::beginFrame() {
+        auto now = Clock::now();
+        if (frameNumber > 0 && isMeasured(frameNumber - 1)) {
+            cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+        }
+        frameStart = now;
+        peakDeviceMemory = std::max(peakDeviceMemory, lveDevice.getDeviceMemoryUsage());
+    }
+    /// <summary>
+    /// Fin d'une trame, avant LveRenderer::endFrame : garde le nombre d'appels de dessin
+    /// </summary>
+    /// <param name="stats"></param>
+    void LveBenchmark::endFrame(const FrameStats& stats) {
+        if (isMeasured(frameNumber)) {
+            drawCalls.push_back(static_cast<double>(stats.drawCalls));
+        }
+        frameNumber++;
+    }
+    /// <summary>
+    /// Garde les temps GPU par scope et les statistiques de pipeline d'une trame terminée, une seule fois par trame.
+    /// Les résultats arrivent avec quelques trames de retard ; les trames de chauffe sont ignorées
+    /// </summary>
+    /// <param name="results"></param>
+    void LveBenchmark::recordGpuResults(const LveGpuProfiler::FrameResults& results) {
+        if (results.frameNumber == lastGpuFrame) {
+            return;
+        }
+        lastGpuFrame = results.frameNumber;
+        // frameNumber du profileur commence à 1
+        if (results.frameNumber == 0 || !isMeasured(static_cast<uint32_t>(results.frameNumber - 1))) {
+            return;
+        }
+        for (size_t i = 0; i < results.scopes.size(); i++) {
+            if (i >= gpuScopeMs.size()) {
+                gpuScopeMs.push_back({ results.scopes[i].name, {} });
+            }
+            gpuScopeMs[i].second.push_back(results.scopes[i].milliseconds);
+        }
+        if (results.hasStatistics) {
+            vertexInvocations.push_back(static_cast<double>(results.vertexInvocations));
+            fragmentInvocations.push_back(static_cast<double>(results.fragmentInvocations));
+        }
+    }
+    /// <summary>
+    /// Relève le temps CPU de la dernière trame, qu'aucun beginFrame ne suivra
+    /// </summary>
+    void LveBenchmark::endRun() {
+        if (frameNumber > 0 && isMeasured(frameNumber - 1)) {
+            cpuFrameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+        }
+    }
+    /// <summary>
+    /// Trie les échantillons et retourne moyenne, médiane, 90e et 99e centiles (rang le plus proche) et maximum
+    /// </summary>
+    /// <param name="samples"></param>
+    /// <returns></returns>
+    LveBenchmark::Percentiles LveBenchmark::computePercentiles(std::vector<double> samples) {
+        Percentiles result{};
+        if (samples.empty()) {
+            return result;
+        }
+        std::sort(samples.begin(), samples.end());
+        auto at = [&](double percentile) {
+            size_t rank = static_cast<size_t>(std::ceil(percentile * samples.size()));
+            return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+        };
+        result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        result.p50 = at(0.50);
+        result.p90 = at(0.90);
+        result.p99 = at(0.99);
+        result.max = samples.back();
+        return result;
+    }
+    /// <summary>
+    /// Lit la valeur numérique key dans l'objet section d'un rapport écrit par finish(). Pas un parseur JSON général :
+    /// il suffit pour le format plat de nos rapports. Retourne NaN si la section n'est pas un objet (null par exemple)
+    /// ou si la valeur est absente ou n'est pas un nombre
+    /// </summary>
+    /// <param name="json"></param>
+    /// <param name="section"></param>
+    /// <param name="key"></param>
+    /// <returns></returns>
+    double LveBenchmark::readJsonNumber(const std::string& json, const std::string& section, const std::string& key) {
+        constexpr double missing = std::numeric_limits<double>::quiet_NaN();
+        size_t sectionStart = json.find("\"" + section + "\"");
+        if (sectionStart == std::string::npos) {
+            return missing;
+        }
+        size_t sectionColon = json.find(':', sectionStart);
+        size_t sectionOpen = sectionColon == std::string::npos ? sectionColon : json.find_first_not_of(" \t\r\n", sectionColon + 1);
+        if (sectionOpen == std::string::npos || json[sectionOpen] != '{') {
+            return missing;
+        }
+        size_t sectionEnd = json.find('}', sectionOpen);
+        size_t keyStart = json.find("\"" + key + "\"", sectionOpen);
+        if (keyStart == std::string::npos || keyStart > sectionEnd) {
+            return missing;
+        }
+        const char* valueStart = json.c_str() + json.find(':', keyStart) + 1;
+        char* valueEnd = nullptr;
+        double value = std::strtod(valueStart, &valueEnd);
+        return valueEnd == valueStart ? missing : value;
+    }
+    /// <summary>
+    /// À appeler après la boucle, GPU au repos : relève les temps GPU des trames encore en vol à l'arrêt, écrit le rapport JSON
+    /// dans config.benchmarkReport et le compare à config.benchmarkBaseline s'il y en a une.
+    /// Retourne false si un centile dépasse celui de la référence de plus de config.regressionTolerance
+    /// </summary>
+    /// <param name="extent"></param>
+    /// <param name="gpuProfiler"></param>
+    /// <returns></returns>
+    bool LveBenchmark::finish(VkExtent2D extent, LveGpuProfiler& gpuProfiler) {
+        while (gpuProfiler.readPendingResults()) {
+            recordGpuResults(gpuProfiler.getResults());
+        }
+        bool hasGpuTimes = !gpuScopeMs.empty();
+        Percentiles cpu = computePercentiles(cpuFrameMs);
+        Percentiles gpu = hasGpuTimes ? computePercentiles(gpuScopeMs[0].second) : Percentiles{};
+        Percentiles draws = computePercentiles(drawCalls);
+
+        std::vector<std::string> regressions{};
+        if (!config.benchmarkBaseline.empty()) {
+            std::ifstream baselineFile{ config.benchmarkBaseline };
+            if (!baselineFile.is_open()) {
+                throw std::runtime_error("failed to open benchmark baseline: " + config.benchmarkBaseline);
+            }
+            std::stringstream buffer;
+            buffer << baselineFile.rdbuf();
+            std::string baseline = buffer.str();
+
+            auto compare = [&](const char* section, const char* key, double current) {
+                double reference = readJsonNumber(baseline, section, key);
+                if (!std::isnan(reference) && reference > 0.0 && current > reference * (1.0 + config.regressionTolerance)) {
+                    regressions.push_back(std::string(section) + "." + key);
+                    std::cout << "regression: " << section << "." << key << " " << reference << " -> " << current << " ms" << std::endl;
+                }
+            };
+            compare("cpu_frame_ms", "p50", cpu.p50);
+            compare("cpu_frame_ms", "p99", cpu.p99);
+            if (hasGpuTimes) {
+                compare("gpu_frame_ms", "p50", gpu.p50);
+                compare("gpu_frame_ms", "p99", gpu.p99);
+            }
+        }
+
+        auto writePercentiles = [](std::ostream& out, const Percentiles& p) {
+            out << "{ \"mean\": " << p.mean << ", \"p50\": " << p.p50 << ", \"p90\": " << p.p90 << ", \"p99\": " << p.p99 << ", \"max\": " << p.max << " }";
+        };
+
+        std::ofstream report{ config.benchmarkReport };
+        if (!report.is_open()) {
+            throw std::runtime_error("failed to write benchmark report: " + config.benchmarkReport);
+        }
+        report << std::fixed << std::setprecision(4);
+        report << "{\n";
+        report << "  \"device\": ";
+        writeJsonString(report, lveDevice.properties.deviceName);
+        report << ",\n";
+        report << "  \"headless\": " << (config.headless ? "true" : "false") << ",\n";
+        report << "  \"resolution\": [" << extent.width << ", " << extent.height << "],\n";
+        report << "  \"frames\": " << frameNumber << ",\n";
+        report << "  \"warmup_frames\": " << WARMUP_FRAMES << ",\n";
+        report << "  \"scene\": { \"cubes\": " << config.benchmarkCubes << ", \"lights\": " << std::min(config.benchmarkLights, static_cast<uint32_t>(MAX_LIGHTS))
+            << ", \"models\": " << config.benchmarkModels << " },\n";
+        report << "  \"cpu_frame_ms\": ";
+        writePercentiles(report, cpu);
+        report << ",\n  \"gpu_frame_ms\": ";
+        if (!hasGpuTimes) {
+            report << "null";
+        } else {
+            writePercentiles(report, gpu);
+        }
+        report << ",\n  \"gpu_scopes_ms\": {";
+        for (size_t i = 1; i < gpuScopeMs.size(); i++) {
+            report << (i == 1 ? "\n    " : ",\n    ");
+            writeJsonString(report, gpuScopeMs[i].first);
+            report << ": ";
+            writePercentiles(report, computePercentiles(gpuScopeMs[i].second));
+        }
+        report << (gpuScopeMs.size() > 1 ? "\n  }" : "}");
+        report << ",\n  \"pipeline_statistics\": ";
+        if (vertexInvocations.empty()) {
+            report << "null";
+        } else {
+            report << "{ \"vertex_invocations\": " << computePercentiles(vertexInvocations).mean
+                << ", \"fragment_invocations\": " << computePercentiles(fragmentInvocations).mean << " }";
+        }
+        report << ",\n  \"draw_calls\": { \"mean\": " << draws.mean << ", \"max\": " << draws.max << " },\n";
+        report << "  \"device_memory_mb\": { \"peak\": " << static_cast<double>(peakDeviceMemory) / (1024.0 * 1024.0) << " },\n";
+        report << "  \"regressions\": [";
+        for (size_t i = 0; i < regressions.size(); i++) {
+            report << (i == 0 ? "" : ", ") << "\"" << regressions[i] << "\"";
+        }
+        report << "]\n}\n";
+
+        std::cout << "benchmark: cpu p50 " << cpu.p50 << " ms, p99 " << cpu.p99 << " ms, gpu p50 " << gpu.p50 << " ms -> " << config.benchmarkReport << std::endl;
+        return regressions.empty();
+    }
+}
@@ -0,0 +1,106 @@
+#include "lve_bindless_table.hpp"
+#include "lve_deletion_queue.hpp"
+
+//std
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+    /// <summary>
+    /// Crée l'ensemble global du mode bindless. Les deux tableaux sont partiellement liés (les emplacements vides ne sont jamais lus)
+    /// et modifiables après le bind, donc on peut ajouter une ressource pendant qu'une trame utilise l'ensemble
+    /// </summary>
+    /// <param name="device"></param>
+    LveBindlessTable::LveBindlessTable(LveDevice& device) : lveDevice{ device } {
+        assert(lveDevice.supportsBindless() && "Bindless table needs descriptor indexing");
+
+        VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        setLayout = LveDescriptorSetLayout::Builder(lveDevice)
+            .addBinding(TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT, MAX_TEXTURES)
+            .addBinding(BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT, MAX_BUFFERS)
+            .setBindingFlags(TEXTURE_BINDING, flags)
+            .setBindingFlags(BUFFER_BINDING, flags)
+            .build();
+
+        pool = LveDescriptorPool::Builder(lveDevice).setMaxSets(1)
+            .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_BUFFERS)
+            .build();
+
+        if (!pool->allocateDescriptor(setLayout->getDescriptorSetLayout(), descriptorSet)) {
+            throw std::runtime_error("failed to allocate bindless descriptor set!");
+        }
+    }
+
+    LveBindlessTable::~LveBindlessTable() {}
+    /// <summary>
+    /// Ajoute une texture au tableau et retourne son indice, à transmettre au shader
+    /// </summary>
+    /// <param name="imageInfo"></param>
+    /// <returns></returns>
+    uint32_t LveBindlessTable::addTexture(VkDescriptorImageInfo imageInfo) {
+        uint32_t index = acquire(*textures, MAX_TEXTURES);
+        LveDescriptorWriter(*setLayout, *pool)
+            .writeImage(TEXTURE_BINDING, &imageInfo, index)
+            .overwrite(descriptorSet);
+        return index;
+    }
+    /// <summary>
+    /// Ajoute un tampon de stockage (ou une plage d'un tampon) au tableau et retourne son indice
+    /// </summary>
+    /// <param name="bufferInfo"></param>
+    /// <returns></returns>
+    uint32_t LveBindlessTable::addBuffer(VkDescriptorBufferInfo bufferInfo) {
+        uint32_t index = acquire(*buffers, MAX_BUFFERS);
+        LveDescriptorWriter(*setLayout, *pool)
+            .writeBuffer(BUFFER_BINDING, &bufferInfo, index)
+            .overwrite(descriptorSet);
+        return index;
+    }
+    /// <summary>
+    /// Rend l'indice d'une texture réutilisable, une fois terminées les trames en vol qui peuvent encore le lire
+    /// </summary>
+    /// <param name="index"></param>
+    void LveBindlessTable::removeTexture(uint32_t index) {
+        assert(index < textures->next && "Texture index was never allocated");
+        release(textures, index);
+    }
+    /// <summary>
+    /// Rend l'indice d'un tampon réutilisable, une fois terminées les trames en vol qui peuvent encore le lire
+    /// </summary>
+    /// <param name="index"></param>
+    void LveBindlessTable::removeBuffer(uint32_t index) {
+        assert(index < buffers->next && "Buffer index was never allocated");
+        release(buffers, index);
+    }
+    /// <summary>
+    /// Remet l'indice dans la liste libre par la file de destruction : avec UPDATE_AFTER_BIND, réécrire tout de suite
+    /// l'emplacement modifierait un descripteur qu'une trame en vol lit peut-être encore
+    /// </summary>
+    /// <param name="slots"></param>
+    /// <param name="index"></param>
+    void LveBindlessTable::release(const std::shared_ptr<Slots>& slots, uint32_t index) {
+        lveDevice.getDeletionQueue().defer([slots, index]() {
+            slots->freeIndices.push_back(index);
+        });
+    }
+    /// <summary>
+    /// Retourne un indice libéré si possible, sinon le prochain indice jamais utilisé
+    /// </summary>
+    /// <param name="slots"></param>
+    /// <param name="capacity"></param>
+    /// <returns></returns>
+    uint32_t LveBindlessTable::acquire(Slots& slots, uint32_t capacity) {
+        if (!slots.freeIndices.empty()) {
+            uint32_t index = slots.freeIndices.back();
+            slots.freeIndices.pop_back();
+            return index;
+        }
+        if (slots.next >= capacity) {
+            throw std::runtime_error("bindless table is full!");
+        }
+        return slots.next++;
+    }
+}
@@ -1,4 +1,5 @@
 #include "lve_buffer.hpp"
+#include "lve_deletion_queue.hpp"
 
  // std
 #include <cassert>
@@ -17,7 +18,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Retourne l'alignement minimum ncessaire pour tre compatible avec minOffsetAlignment
+    /// Retourne l'alignement minimum nécessaire pour être compatible avec minOffsetAlignment
     /// </summary>
     /// <param name="instanceSize"></param>
     /// <param name="minOffsetAlignment"></param>
@@ -43,12 +44,15 @@ namespace lve {
         device.createBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, memory);
     }
     /// <summary>
-    /// Destructeur de la classe LveBuffer
+    /// Destructeur de la classe LveBuffer.
+    /// La destruction du tampon et de sa mémoire est différée jusqu'à la fin de la trame qui peut encore le lire
     /// </summary>
     LveBuffer::~LveBuffer() {
         unmap();
-        vkDestroyBuffer(lveDevice.getDevice(), buffer, nullptr);
-        vkFreeMemory(lveDevice.getDevice(), memory, nullptr);
+        lveDevice.getDeletionQueue().defer([device = lveDevice.getDevice(), buffer = buffer, memory = memory]() {
+            vkDestroyBuffer(device, buffer, nullptr);
+            vkFreeMemory(device, memory, nullptr);
+        });
     }
 
     /**
@@ -62,7 +66,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Mappe une plage de mmoire de ce tampon
+    /// Mappe une plage de mémoire de ce tampon
     /// </summary>
     /// <param name="size"></param>
     /// <param name="offset"></param>
@@ -79,7 +83,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Dsapprouve une plage de mmoire mappe
+    /// Désapprouve une plage de mémoire mappée
     /// </summary>
     void LveBuffer::unmap() {
         if (mapped) {
@@ -99,7 +103,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Copie les donnes spcifies dans le tampon mapp
+    /// Copie les données spécifiées dans le tampon mappé
     /// </summary>
     /// <param name="data"></param>
     /// <param name="size"></param>
@@ -129,7 +133,7 @@ namespace lve {
      */
 
     /// <summary>
-    ///  Flush une plage de mmoire du tampon pour la rendre visible pour le priphrique
+    ///  Flush une plage de mémoire du tampon pour la rendre visible pour le périphérique
     /// </summary>
     /// <param name="size"></param>
     /// <param name="offset"></param>
@@ -156,7 +160,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Invalide une plage de mmoire du tampon pour la rendre visible pour l'hte
+    /// Invalide une plage de mémoire du tampon pour la rendre visible pour l'hôte
     /// </summary>
     /// <param name="size"></param>
     /// <param name="offset"></param>
@@ -180,7 +184,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Cre une structure VkDescriptorBufferInfo pour la plage spcifie
+    /// Crée une structure VkDescriptorBufferInfo pour la plage spécifiée
     /// </summary>
     /// <param name="size"></param>
     /// <param name="offset"></param>
@@ -198,7 +202,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Copie une quantit spcifie de donnes dans le tampon  un indice donn
+    /// Copie une quantité spécifiée de données dans le tampon à un indice donné
     /// </summary>
     /// <param name="data"></param>
     /// <param name="index"></param>
@@ -214,7 +218,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Flush la plage de mmoire du tampon  l'indice spcifi
+    /// Flush la plage de mémoire du tampon à l'indice spécifié
     /// </summary>
     /// <param name="index"></param>
     /// <returns></returns>
@@ -231,7 +235,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Cre une structure VkDescriptorBufferInfo pour l'instance  l'indice spcifi
+    /// Crée une structure VkDescriptorBufferInfo pour l'instance à l'indice spécifié
     /// </summary>
     /// <param name="index"></param>
     /// <returns></returns>
@@ -250,7 +254,7 @@ namespace lve {
      */
 
     /// <summary>
-    /// Invalide la plage de mmoire du tampon  l'indice spcifi
+    /// Invalide la plage de mémoire du tampon à l'indice spécifié
     /// </summary>
     /// <param name="index"></param>
     /// <returns></returns>
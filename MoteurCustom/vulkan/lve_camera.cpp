@@ -4,7 +4,7 @@
 #include <limits>
 namespace lve {
     /// <summary>
-    /// Dfinit une projection orthographique pour la camra
+    /// Définit une projection orthographique pour la caméra
     /// </summary>
     /// <param name="left"></param>
     /// <param name="right"></param>
@@ -22,7 +22,7 @@ namespace lve {
         projectionMatrix[3][2] = -near / (far - near);
     }
     /// <summary>
-    /// Dfinit une projection en perspective pour la camra
+    /// Définit une projection en perspective pour la caméra
     /// </summary>
     /// <param name="fovy"></param>
     /// <param name="aspect"></param>
@@ -39,7 +39,7 @@ namespace lve {
         projectionMatrix[3][2] = -(far * near) / (far - near);
     }
     /// <summary>
-    /// Dfinit la direction de vue de la camra
+    /// Définit la direction de vue de la caméra
     /// </summary>
     /// <param name="position"></param>
     /// <param name="direction"></param>
@@ -78,7 +78,7 @@ namespace lve {
         inverseViewMatrix[3][2] = position.z;
     }
     /// <summary>
-    /// Dfinit la cible de vue de la camra
+    /// Définit la cible de vue de la caméra
     /// </summary>
     /// <param name="position"></param>
     /// <param name="target"></param>
@@ -87,7 +87,7 @@ namespace lve {
         setViewDirection(position, target - position, up);
     }
     /// <summary>
-    ///  Dfinit la vue de la camra en utilisant des angles YXZ
+    ///  Définit la vue de la caméra en utilisant des angles YXZ
     /// </summary>
     /// <param name="position"></param>
     /// <param name="rotation"></param>
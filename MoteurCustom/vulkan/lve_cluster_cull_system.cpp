@@ -0,0 +1,221 @@
+#include "lve_cluster_cull_system.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_frame_arena.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+    struct ClusterCullPushConstantData {
+        glm::mat4 modelMatrix{ 1.f };
+        uint32_t firstCluster = 0;
+        uint32_t clusterCount = 0;
+        uint32_t firstCommand = 0;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        float scale = 1.f;
+        uint32_t coneCulling = 0;
+        uint32_t list = 0;
+        uint32_t instanceIndex = 0;
+    };
+    /// <summary>
+    /// Prend une référence à un objet LveDevice et le layout de l'ensemble de descripteurs global (set 0, qui contient les matrices de la caméra).
+    /// Crée le layout de l'ensemble de descripteurs du culling (set 1), le pipeline layout et le pipeline de calcul
+    /// </summary>
+    /// <param name="device"></param>
+    /// <param name="globalSetLayout"></param>
+    ClusterCullSystem::ClusterCullSystem(LveDevice& device, VkDescriptorSetLayout globalSetLayout)
+        : lveDevice{ device }, supported{ device.supportsDrawIndirectCount() && device.supportsMultiDrawIndirect() && device.supportsDrawIndirectFirstInstance() } {
+        createDescriptors();
+        createPipelineLayout(globalSetLayout);
+        createPipeline();
+    }
+    /// <summary>
+    /// Détruit le pipeline layout Vulkan ; les tampons sont libérés avec leurs propriétaires
+    /// </summary>
+    ClusterCullSystem::~ClusterCullSystem() {
+        vkDestroyPipelineLayout(lveDevice.getDevice(), pipelineLayout, nullptr);
+    }
+    /// <summary>
+    /// Crée le layout de l'ensemble de descripteurs du culling : binding 0 = tas des clusters du pool de géométrie,
+    /// binding 1 = tampon des commandes de dessin indirectes de la trame, binding 2 = nombre de commandes visibles par liste.
+    /// L'ensemble lui-même est alloué à chaque trame dans l'allocateur de la trame, ces tampons pouvant être remplacés (agrandissement)
+    /// </summary>
+    void ClusterCullSystem::createDescriptors() {
+        cullSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+            .build();
+
+        indirectBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        indirectCapacities.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT, 0);
+        countBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    }
+    /// <summary>
+    /// Crée la mise en page du pipeline de calcul : set 0 global, set 1 culling, et les constantes de poussée de l'objet traité
+    /// </summary>
+    /// <param name="globalSetLayout"></param>
+    void ClusterCullSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ClusterCullPushConstantData);
+
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, cullSetLayout->getDescriptorSetLayout() };
+
+        VkPipelineLayoutCreateInfo pipelineLayoutinfo{};
+        pipelineLayoutinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutinfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+        pipelineLayoutinfo.pSetLayouts = descriptorSetLayouts.data();
+        pipelineLayoutinfo.pushConstantRangeCount = 1;
+        pipelineLayoutinfo.pPushConstantRanges = &pushConstantRange;
+        if (vkCreatePipelineLayout(lveDevice.getDevice(), &pipelineLayoutinfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout!");
+        }
+    }
+
+    void ClusterCullSystem::createPipeline() {
+        assert(pipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+        lvePipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/cluster_cull.comp.spv", pipelineLayout);
+    }
+    /// <summary>
+    /// S'assure que le tampon indirect de la trame peut contenir commandCount commandes (agrandi par doublement)
+    /// et crée au premier passage son tampon de compteurs. La trame frameIndex a déjà attendu sa barrière (fence),
+    /// ses anciens tampons ne sont plus utilisés par le GPU
+    /// </summary>
+    /// <param name="frameIndex"></param>
+    /// <param name="commandCount"></param>
+    void ClusterCullSystem::prepareFrame(int frameIndex, uint32_t commandCount) {
+        if (commandCount > indirectCapacities[frameIndex]) {
+            uint32_t capacity = std::max({ commandCount, indirectCapacities[frameIndex] * 2, INITIAL_COMMAND_CAPACITY });
+            indirectBuffers[frameIndex] = std::make_unique<LveBuffer>(lveDevice, sizeof(VkDrawIndexedIndirectCommand), capacity,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            indirectCapacities[frameIndex] = capacity;
+        }
+        if (!countBuffers[frameIndex]) {
+            countBuffers[frameIndex] = std::make_unique<LveBuffer>(lveDevice, sizeof(uint32_t), LIST_COUNT,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        }
+        currentIndirectBuffer = indirectBuffers[frameIndex]->getBuffer();
+        currentCountBuffer = countBuffers[frameIndex]->getBuffer();
+    }
+    /// <summary>
+    /// À appeler avant beginSwapChainRenderPass (un dispatch n'est pas permis dans une render pass).
+    /// Les objets sont répartis en listes selon le format de vertex et le type d'indices de leur modèle ; chaque liste réserve
+    /// la place de tous les clusters de ses objets. Pour chaque objet, lance un invocation par cluster qui teste la sphère contre
+    /// le frustum et le cône de normales contre la position de la caméra. Seuls les clusters visibles écrivent une commande,
+    /// à la place obtenue par un atomicAdd sur le compteur de la liste (remis à zéro avant le dispatch), avec firstInstance = instanceIndex
+    /// de l'objet. Le cône n'est utilisé que si l'échelle de l'objet est uniforme.
+    /// Une barrière rend les commandes et les compteurs visibles à l'étape de dessin indirect
+    /// </summary>
+    /// <param name="frameInfo"></param>
+    /// <param name="objects">objets au niveau de détail 0 dont le modèle a des clusters</param>
+    void ClusterCullSystem::cull(FrameInfo& frameInfo, const std::vector<CullObject>& objects) {
+        lists = {};
+        if (!supported || objects.empty()) {
+            return;
+        }
+        for (const auto& cullObject : objects) {
+            const LveModel& model = *cullObject.object->model;
+            lists[listIndex(model.getVertexLayout(), model.getIndexType())].capacity += model.getClusterCount();
+        }
+        uint32_t commandCount = 0;
+        for (auto& list : lists) {
+            list.firstCommand = commandCount;
+            commandCount += list.capacity;
+        }
+        prepareFrame(frameInfo.frameIndex, commandCount);
+
+        // ensemble de la trame, rendu en bloc quand l'indice de trame revient
+        assert(frameInfo.frameDescriptors != nullptr && "Cluster culling needs the frame descriptor allocator");
+        VkDescriptorBufferInfo clusterInfo{ lveDevice.getGeometryPool().getBuffer(LveGeometryPool::Heap::Cluster), 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo commandInfo{ currentIndirectBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorBufferInfo countInfo{ currentCountBuffer, 0, VK_WHOLE_SIZE };
+        VkDescriptorSet cullDescriptorSet;
+        bool allocated = LveDescriptorWriter(*cullSetLayout, *frameInfo.frameDescriptors, LveFrameArena::resourceOf(frameInfo.frameArena))
+            .writeBuffer(0, &clusterInfo)
+            .writeBuffer(1, &commandInfo)
+            .writeBuffer(2, &countInfo)
+            .build(cullDescriptorSet);
+        if (!allocated) {
+            throw std::runtime_error("failed to allocate cluster culling descriptor set!");
+        }
+
+        vkCmdFillBuffer(frameInfo.commandBuffer, currentCountBuffer, 0, VK_WHOLE_SIZE, 0);
+        VkBufferMemoryBarrier resetBarrier{};
+        resetBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        resetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        resetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        resetBarrier.buffer = currentCountBuffer;
+        resetBarrier.offset = 0;
+        resetBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(frameInfo.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &resetBarrier, 0, nullptr);
+
+        lvePipeline->bind(frameInfo.commandBuffer);
+        VkDescriptorSet descriptorSets[] = { frameInfo.globalDescriptorSet, cullDescriptorSet };
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 2, descriptorSets, 1, &frameInfo.globalUboOffset);
+
+        for (const auto& cullObject : objects) {
+            auto& obj = *cullObject.object;
+
+            glm::vec3 scale = glm::abs(obj.transform.scale);
+            float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+            float minScale = glm::min(scale.x, glm::min(scale.y, scale.z));
+
+            ClusterCullPushConstantData push{};
+            push.modelMatrix = obj.transform.mat4();
+            push.firstCluster = obj.model->getFirstCluster();
+            push.clusterCount = obj.model->getClusterCount();
+            push.list = listIndex(obj.model->getVertexLayout(), obj.model->getIndexType());
+            push.firstCommand = lists[push.list].firstCommand;
+            push.firstIndex = obj.model->getFirstIndex();
+            push.vertexOffset = obj.model->getVertexOffset();
+            push.scale = maxScale;
+            push.coneCulling = maxScale - minScale <= maxScale * 0.001f ? 1 : 0;
+            push.instanceIndex = cullObject.instanceIndex;
+
+            vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCullPushConstantData), &push);
+            vkCmdDispatch(frameInfo.commandBuffer, (push.clusterCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        }
+
+        VkBufferMemoryBarrier barriers[2]{};
+        VkBuffer buffers[] = { currentIndirectBuffer, currentCountBuffer };
+        for (uint32_t i = 0; i < 2; i++) {
+            barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barriers[i].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[i].buffer = buffers[i];
+            barriers[i].offset = 0;
+            barriers[i].size = VK_WHOLE_SIZE;
+        }
+        vkCmdPipelineBarrier(frameInfo.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr, 2, barriers, 0, nullptr);
+    }
+    /// <summary>
+    /// Dessine les clusters visibles de tous les objets d'une liste (format de vertex et type d'indices) en un seul appel,
+    /// dont le nombre de dessins est lu sur le GPU. Le pipeline du format et le tampon d'indices du type doivent être liés.
+    /// Retourne le nombre d'appels de dessin émis, 0 si la liste est vide
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="layout"></param>
+    /// <param name="indexType"></param>
+    /// <returns></returns>
+    uint32_t ClusterCullSystem::drawClusters(VkCommandBuffer commandBuffer, VertexLayout layout, VkIndexType indexType) {
+        const DrawList& list = lists[listIndex(layout, indexType)];
+        if (list.capacity == 0) {
+            return 0;
+        }
+
+        const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        uint32_t maxDrawCount = std::min(list.capacity, lveDevice.properties.limits.maxDrawIndirectCount);
+        vkCmdDrawIndexedIndirectCount(commandBuffer, currentIndirectBuffer, static_cast<VkDeviceSize>(list.firstCommand) * stride,
+            currentCountBuffer, listIndex(layout, indexType) * sizeof(uint32_t), maxDrawCount, stride);
+        return 1;
+    }
+}
@@ -0,0 +1,85 @@
+#include "lve_deletion_queue.hpp"
+
+namespace lve {
+    LveDeletionQueue::LveDeletionQueue(LveDevice& device) : lveDevice{ device } {}
+    /// <summary>
+    /// Détruit tout ce qui reste, après avoir attendu le GPU
+    /// </summary>
+    LveDeletionQueue::~LveDeletionQueue() {
+        flush();
+    }
+    /// <summary>
+    /// Enregistre la destruction d'une ressource. Elle n'est exécutée qu'une fois terminée la trame soumise après cet appel :
+    /// la ressource peut encore être référencée par les commandes de la trame en cours d'enregistrement
+    /// </summary>
+    /// <param name="destroy"></param>
+    void LveDeletionQueue::defer(std::function<void()> destroy) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        unstamped.push_back(std::move(destroy));
+    }
+    /// <summary>
+    /// Associe les destructions en attente à la valeur de timeline de la trame qui vient d'être soumise.
+    /// Une soumission intermédiaire (transfert) ne doit pas servir : la trame qui utilise la ressource serait encore en vol
+    /// </summary>
+    /// <param name="timelineValue"></param>
+    void LveDeletionQueue::retire(uint64_t timelineValue) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        for (auto& destroy : unstamped) {
+            entries.push_back({ timelineValue, std::move(destroy) });
+        }
+        unstamped.clear();
+    }
+    /// <summary>
+    /// Exécute au plus maxDestructions destructions dont la trame est terminée ; le reste attend l'appel suivant.
+    /// Les fonctions sont appelées hors du verrou, elles peuvent elles-mêmes différer d'autres destructions
+    /// </summary>
+    /// <param name="maxDestructions"></param>
+    void LveDeletionQueue::collect(size_t maxDestructions) {
+        uint64_t completed = lveDevice.getCompletedTimelineValue();
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            while (!entries.empty() && ready.size() < maxDestructions && entries.front().timelineValue <= completed) {
+                ready.push_back(std::move(entries.front().destroy));
+                entries.pop_front();
+            }
+        }
+        for (auto& destroy : ready) {
+            destroy();
+        }
+    }
+    /// <summary>
+    /// Attend la fin de tout ce qui a été soumis puis détruit toutes les ressources en attente, y compris celles différées pendant la destruction
+    /// </summary>
+    void LveDeletionQueue::flush() {
+        lveDevice.waitForTimeline(lveDevice.getLastSubmittedTimelineValue());
+        while (true) {
+            std::vector<std::function<void()>> ready;
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                for (auto& entry : entries) {
+                    ready.push_back(std::move(entry.destroy));
+                }
+                for (auto& destroy : unstamped) {
+                    ready.push_back(std::move(destroy));
+                }
+                entries.clear();
+                unstamped.clear();
+            }
+            if (ready.empty()) {
+                return;
+            }
+            for (auto& destroy : ready) {
+                destroy();
+            }
+        }
+    }
+    /// <summary>
+    /// Nombre de destructions pas encore exécutées
+    /// </summary>
+    /// <returns></returns>
+    size_t LveDeletionQueue::pendingCount() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        return entries.size() + unstamped.size();
+    }
+}
@@ -1,6 +1,7 @@
 #include "lve_descriptors.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 
@@ -9,7 +10,7 @@ namespace lve {
     // *************** Descriptor Set Layout Builder *********************
 
     /// <summary>
-    /// Ajoute une liaison au descripteur avec les spcifications fournies
+    /// Ajoute une liaison au descripteur avec les spécifications fournies
     /// </summary>
     /// <param name="binding"></param>
     /// <param name="descriptorType"></param>
@@ -27,46 +28,117 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Construit un objet LveDescriptorSetLayout avec les liaisons ajoutes
+    /// Définit les drapeaux de descriptor indexing d'une liaison déjà ajoutée.
+    /// Si une liaison est UPDATE_AFTER_BIND, le layout doit être alloué dans un pool créé avec VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT
+    /// </summary>
+    /// <param name="binding"></param>
+    /// <param name="flags"></param>
+    /// <returns></returns>
+    LveDescriptorSetLayout::Builder& LveDescriptorSetLayout::Builder::setBindingFlags(uint32_t binding, VkDescriptorBindingFlags flags) {
+        assert(bindings.count(binding) == 1 && "Binding flags set on a binding that does not exist");
+        bindingFlags[binding] = flags;
+        return *this;
+    }
+    /// <summary>
+    /// Construit un objet LveDescriptorSetLayout avec les liaisons ajoutées
     /// </summary>
     /// <returns></returns>
     std::unique_ptr<LveDescriptorSetLayout> LveDescriptorSetLayout::Builder::build() const {
-        return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings);
+        return std::make_unique<LveDescriptorSetLayout>(lveDevice, bindings, bindingFlags);
     }
 
     // *************** Descriptor Set Layout *********************
     
     /// <summary>
-    /// Cre un objet LveDescriptorSetLayout avec les liaisons spcifies
+    /// Crée un objet LveDescriptorSetLayout avec les liaisons spécifiées
     /// </summary>
     /// <param name="lveDevice"></param>
     /// <param name="bindings"></param>
-    LveDescriptorSetLayout::LveDescriptorSetLayout(LveDevice& lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings) : lveDevice{ lveDevice }, bindings{ bindings } {
+    /// <param name="bindingFlags"></param>
+    LveDescriptorSetLayout::LveDescriptorSetLayout(LveDevice& lveDevice, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings, std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags) : lveDevice{ lveDevice }, bindings{ bindings } {
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
+        bool updateAfterBind = false;
         for (auto kv : bindings) {
             setLayoutBindings.push_back(kv.second);
+            VkDescriptorBindingFlags flags = bindingFlags.count(kv.first) ? bindingFlags[kv.first] : 0;
+            setLayoutBindingFlags.push_back(flags);
+            updateAfterBind |= (flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) != 0;
         }
 
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+        descriptorSetLayoutInfo.flags = updateAfterBind ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT : 0;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
         if (vkCreateDescriptorSetLayout(lveDevice.getDevice(), &descriptorSetLayoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create descriptor set layout!");
         }
+        createUpdateTemplate();
     }
     /// <summary>
-    ///  Libre les ressources alloues
+    ///  Libère les ressources allouées
     /// </summary>
     LveDescriptorSetLayout::~LveDescriptorSetLayout() {
+        if (updateTemplate != VK_NULL_HANDLE) {
+            vkDestroyDescriptorUpdateTemplate(lveDevice.getDevice(), updateTemplate, nullptr);
+        }
         vkDestroyDescriptorSetLayout(lveDevice.getDevice(), descriptorSetLayout, nullptr);
     }
+    /// <summary>
+    /// Crée le descriptor update template du layout : une entrée par liaison, dans l'ordre des liaisons,
+    /// qui lit un LveDescriptorInfo par liaison. Les layouts sans liaison (un template vide est invalide) ou avec des tableaux
+    /// de descripteurs gardent vkUpdateDescriptorSets
+    /// </summary>
+    void LveDescriptorSetLayout::createUpdateTemplate() {
+        if (bindings.empty()) {
+            return;
+        }
+        std::vector<uint32_t> sortedBindings{};
+        for (auto& kv : bindings) {
+            if (kv.second.descriptorCount != 1) {
+                return;
+            }
+            sortedBindings.push_back(kv.first);
+        }
+        std::sort(sortedBindings.begin(), sortedBindings.end());
+
+        std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+        for (uint32_t i = 0; i < sortedBindings.size(); i++) {
+            VkDescriptorUpdateTemplateEntry entry{};
+            entry.dstBinding = sortedBindings[i];
+            entry.dstArrayElement = 0;
+            entry.descriptorCount = 1;
+            entry.descriptorType = bindings[sortedBindings[i]].descriptorType;
+            entry.offset = i * sizeof(LveDescriptorInfo);
+            entry.stride = sizeof(LveDescriptorInfo);
+            entries.push_back(entry);
+            templateSlots[sortedBindings[i]] = i;
+        }
+
+        VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+        templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+        templateInfo.pDescriptorUpdateEntries = entries.data();
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        templateInfo.descriptorSetLayout = descriptorSetLayout;
+
+        if (vkCreateDescriptorUpdateTemplate(lveDevice.getDevice(), &templateInfo, nullptr, &updateTemplate) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor update template!");
+        }
+    }
 
     // *************** Descriptor Pool Builder *********************
     
     /// <summary>
-    /// Ajoute une taille de pool pour un type de descripteur spcifi
+    /// Ajoute une taille de pool pour un type de descripteur spécifié
     /// </summary>
     /// <param name="descriptorType"></param>
     /// <param name="count"></param>
@@ -76,7 +148,7 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Dfinit les drapeaux du pool de descripteurs
+    /// Définit les drapeaux du pool de descripteurs
     /// </summary>
     /// <param name="flags"></param>
     /// <returns></returns>
@@ -85,7 +157,7 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Dfinit le nombre maximal d'ensembles de descripteurs pouvant tre allous
+    /// Définit le nombre maximal d'ensembles de descripteurs pouvant être alloués
     /// </summary>
     /// <param name="count"></param>
     /// <returns></returns>
@@ -94,7 +166,7 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Construit un objet LveDescriptorPool avec les paramtres spcifis
+    /// Construit un objet LveDescriptorPool avec les paramètres spécifiés
     /// </summary>
     /// <returns></returns>
     std::unique_ptr<LveDescriptorPool> LveDescriptorPool::Builder::build() const {
@@ -104,7 +176,7 @@ namespace lve {
     // *************** Descriptor Pool *********************
 
     /// <summary>
-    /// Cre un objet LveDescriptorPool avec les paramtres spcifis
+    /// Crée un objet LveDescriptorPool avec les paramètres spécifiés
     /// </summary>
     /// <param name="lveDevice"></param>
     /// <param name="maxSets"></param>
@@ -123,13 +195,13 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Libre les ressources alloues
+    /// Libère les ressources allouées
     /// </summary>
     LveDescriptorPool::~LveDescriptorPool() {
         vkDestroyDescriptorPool(lveDevice.getDevice(), descriptorPool, nullptr);
     }
     /// <summary>
-    /// Alloue un ensemble de descripteurs  partir du pool
+    /// Alloue un ensemble de descripteurs à partir du pool
     /// </summary>
     /// <param name="descriptorSetLayout"></param>
     /// <param name="descriptor"></param>
@@ -149,14 +221,14 @@ namespace lve {
         return true;
     }
     /// <summary>
-    /// Libre des ensembles de descripteurs du pool
+    /// Libère des ensembles de descripteurs du pool
     /// </summary>
     /// <param name="descriptors"></param>
     void LveDescriptorPool::freeDescriptors(std::vector<VkDescriptorSet>& descriptors) const {
         vkFreeDescriptorSets(lveDevice.getDevice(), descriptorPool, static_cast<uint32_t>(descriptors.size()), descriptors.data());
     }
     /// <summary>
-    /// Rinitialise le pool de descripteurs
+    /// Réinitialise le pool de descripteurs
     /// </summary>
     void LveDescriptorPool::resetPool() {
         vkResetDescriptorPool(lveDevice.getDevice(), descriptorPool, 0);
@@ -170,31 +242,161 @@ namespace lve {
     }
 
 
+    // *************** Descriptor Allocator Builder *********************
+
+    /// <summary>
+    /// Ajoute un type de descripteur et le nombre moyen de descripteurs de ce type par ensemble
+    /// </summary>
+    /// <param name="descriptorType"></param>
+    /// <param name="descriptorsPerSet"></param>
+    /// <returns></returns>
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::addPoolRatio(VkDescriptorType descriptorType, float descriptorsPerSet) {
+        ratios.push_back({ descriptorType, descriptorsPerSet });
+        return *this;
+    }
+    /// <summary>
+    /// Définit le nombre d'ensembles du premier pool
+    /// </summary>
+    /// <param name="count"></param>
+    /// <returns></returns>
+    LveDescriptorAllocator::Builder& LveDescriptorAllocator::Builder::setInitialSets(uint32_t count) {
+        initialSets = count;
+        return *this;
+    }
+    /// <summary>
+    /// Construit un objet LveDescriptorAllocator avec les paramètres spécifiés
+    /// </summary>
+    /// <returns></returns>
+    std::unique_ptr<LveDescriptorAllocator> LveDescriptorAllocator::Builder::build() const {
+        return std::make_unique<LveDescriptorAllocator>(lveDevice, ratios, initialSets);
+    }
+
+    // *************** Descriptor Allocator *********************
+
+    /// <summary>
+    /// Crée un allocateur vide ; le premier pool est créé à la première allocation
+    /// </summary>
+    /// <param name="lveDevice"></param>
+    /// <param name="ratios"></param>
+    /// <param name="initialSets"></param>
+    LveDescriptorAllocator::LveDescriptorAllocator(LveDevice& lveDevice, const std::vector<std::pair<VkDescriptorType, float>>& ratios, uint32_t initialSets)
+        : lveDevice{ lveDevice }, ratios{ ratios }, setsPerPool{ std::max(initialSets, 1u) } {}
+    /// <summary>
+    /// Libère tous les pools de la chaîne
+    /// </summary>
+    LveDescriptorAllocator::~LveDescriptorAllocator() {
+        for (auto pool : readyPools) {
+            vkDestroyDescriptorPool(lveDevice.getDevice(), pool, nullptr);
+        }
+        for (auto pool : fullPools) {
+            vkDestroyDescriptorPool(lveDevice.getDevice(), pool, nullptr);
+        }
+    }
+    /// <summary>
+    /// Retourne un pool qui a encore de la place, ou en crée un nouveau deux fois plus grand que le précédent
+    /// </summary>
+    /// <returns></returns>
+    VkDescriptorPool LveDescriptorAllocator::acquirePool() {
+        if (!readyPools.empty()) {
+            return readyPools.back();
+        }
+
+        std::vector<VkDescriptorPoolSize> poolSizes{};
+        for (auto& [type, ratio] : ratios) {
+            poolSizes.push_back({ type, std::max(static_cast<uint32_t>(ratio * setsPerPool), 1u) });
+        }
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        descriptorPoolInfo.pPoolSizes = poolSizes.data();
+        descriptorPoolInfo.maxSets = setsPerPool;
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(lveDevice.getDevice(), &descriptorPoolInfo, nullptr, &pool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+        setsPerPool = std::min(setsPerPool * 2, MAX_SETS_PER_POOL);
+        readyPools.push_back(pool);
+        return pool;
+    }
+    /// <summary>
+    /// Alloue un ensemble de descripteurs. Si le pool courant est plein, il passe dans la liste des pools pleins
+    /// et l'allocation est retentée une fois dans un nouveau pool
+    /// </summary>
+    /// <param name="descriptorSetLayout"></param>
+    /// <param name="descriptor"></param>
+    /// <returns></returns>
+    bool LveDescriptorAllocator::allocateDescriptor(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
+        allocInfo.descriptorSetCount = 1;
+
+        allocInfo.descriptorPool = acquirePool();
+        VkResult result = vkAllocateDescriptorSets(lveDevice.getDevice(), &allocInfo, &descriptor);
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+            fullPools.push_back(readyPools.back());
+            readyPools.pop_back();
+
+            allocInfo.descriptorPool = acquirePool();
+            result = vkAllocateDescriptorSets(lveDevice.getDevice(), &allocInfo, &descriptor);
+        }
+        return result == VK_SUCCESS;
+    }
+    /// <summary>
+    /// Réinitialise tous les pools : tous les ensembles alloués deviennent invalides.
+    /// À appeler seulement quand le GPU n'utilise plus ces ensembles (après la fence de la frame)
+    /// </summary>
+    void LveDescriptorAllocator::reset() {
+        for (auto pool : readyPools) {
+            vkResetDescriptorPool(lveDevice.getDevice(), pool, 0);
+        }
+        for (auto pool : fullPools) {
+            vkResetDescriptorPool(lveDevice.getDevice(), pool, 0);
+            readyPools.push_back(pool);
+        }
+        fullPools.clear();
+    }
+
+
     // *************** Descriptor Writer *********************
     
     /// <summary>
-    /// Cre un objet LveDescriptorWriter avec un layout de descripteur et un pool
+    /// Crée un objet LveDescriptorWriter avec un layout de descripteur et un pool
     /// </summary>
     /// <param name="setLayout"></param>
     /// <param name="pool"></param>
-    LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorPool& pool) : setLayout{ setLayout }, pool{ pool } {}
+    /// <param name="memory">mémoire des écritures en attente</param>
+    LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorPool& pool, std::pmr::memory_resource* memory)
+        : setLayout{ setLayout }, pool{ &pool }, writes{ memory } {}
+    /// <summary>
+    /// Crée un objet LveDescriptorWriter qui alloue ses ensembles dans un LveDescriptorAllocator
+    /// </summary>
+    /// <param name="setLayout"></param>
+    /// <param name="allocator"></param>
+    /// <param name="memory">mémoire des écritures en attente</param>
+    LveDescriptorWriter::LveDescriptorWriter(LveDescriptorSetLayout& setLayout, LveDescriptorAllocator& allocator, std::pmr::memory_resource* memory)
+        : setLayout{ setLayout }, allocator{ &allocator }, writes{ memory } {}
     /// <summary>
-    /// Ajoute une criture de descripteur pour un tampon
+    /// Ajoute une écriture de descripteur pour un tampon
     /// </summary>
     /// <param name="binding"></param>
     /// <param name="bufferInfo"></param>
+    /// <param name="arrayElement">élément visé quand la liaison est un tableau de descripteurs</param>
     /// <returns></returns>
-    LveDescriptorWriter& LveDescriptorWriter::writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo) {
+    LveDescriptorWriter& LveDescriptorWriter::writeBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement) {
         assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
 
         auto& bindingDescription = setLayout.bindings[binding];
 
-        assert(bindingDescription.descriptorCount == 1 && "Binding single descriptor info, but binding expects multiple");
+        assert(arrayElement < bindingDescription.descriptorCount && "Array element out of the binding range");
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         write.descriptorType = bindingDescription.descriptorType;
         write.dstBinding = binding;
+        write.dstArrayElement = arrayElement;
         write.pBufferInfo = bufferInfo;
         write.descriptorCount = 1;
 
@@ -202,22 +404,24 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Ajoute une criture de descripteur pour une image
+    /// Ajoute une écriture de descripteur pour une image
     /// </summary>
     /// <param name="binding"></param>
     /// <param name="imageInfo"></param>
+    /// <param name="arrayElement">élément visé quand la liaison est un tableau de descripteurs</param>
     /// <returns></returns>
-    LveDescriptorWriter& LveDescriptorWriter::writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo) {
+    LveDescriptorWriter& LveDescriptorWriter::writeImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement) {
         assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
 
         auto& bindingDescription = setLayout.bindings[binding];
 
-        assert(bindingDescription.descriptorCount == 1 && "Binding single descriptor info, but binding expects multiple");
+        assert(arrayElement < bindingDescription.descriptorCount && "Array element out of the binding range");
 
         VkWriteDescriptorSet write{};
         write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
         write.descriptorType = bindingDescription.descriptorType;
         write.dstBinding = binding;
+        write.dstArrayElement = arrayElement;
         write.pImageInfo = imageInfo;
         write.descriptorCount = 1;
 
@@ -225,12 +429,14 @@ namespace lve {
         return *this;
     }
     /// <summary>
-    /// Alloue un ensemble de descripteurs  partir du pool et effectue les critures
+    /// Alloue un ensemble de descripteurs à partir du pool et effectue les écritures
     /// </summary>
     /// <param name="set"></param>
     /// <returns></returns>
     bool LveDescriptorWriter::build(VkDescriptorSet& set) {
-        bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
+        bool success = pool != nullptr
+            ? pool->allocateDescriptor(setLayout.getDescriptorSetLayout(), set)
+            : allocator->allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
         if (!success) {
             return false;
         }
@@ -238,14 +444,43 @@ namespace lve {
         return true;
     }
     /// <summary>
-    /// Effectue les critures sur un ensemble de descripteurs existant
+    /// Effectue les écritures sur un ensemble de descripteurs existant. Quand chaque liaison est écrite exactement une fois,
+    /// passe par le descriptor update template du layout (un seul appel, pas de VkWriteDescriptorSet à parcourir) ;
+    /// sinon une liaison oubliée recevrait des données périmées, les écritures passent par vkUpdateDescriptorSets
     /// </summary>
     /// <param name="set"></param>
     void LveDescriptorWriter::overwrite(VkDescriptorSet& set) {
+        bool coversTemplate = setLayout.updateTemplate != VK_NULL_HANDLE && writes.size() == setLayout.templateSlots.size();
+        if (coversTemplate) {
+            std::pmr::vector<bool> written(writes.size(), false, writes.get_allocator());
+            for (auto& write : writes) {
+                auto slot = setLayout.templateSlots.find(write.dstBinding);
+                if (slot == setLayout.templateSlots.end() || write.dstArrayElement != 0 || write.descriptorCount != 1 || written[slot->second]) {
+                    coversTemplate = false;
+                    break;
+                }
+                written[slot->second] = true;
+            }
+        }
+        if (coversTemplate) {
+            std::pmr::vector<LveDescriptorInfo> data(writes.size(), writes.get_allocator());
+            for (auto& write : writes) {
+                auto& slot = data[setLayout.templateSlots[write.dstBinding]];
+                if (write.pBufferInfo != nullptr) {
+                    slot.buffer = *write.pBufferInfo;
+                }
+                else {
+                    slot.image = *write.pImageInfo;
+                }
+            }
+            vkUpdateDescriptorSetWithTemplate(setLayout.lveDevice.getDevice(), set, setLayout.updateTemplate, data.data());
+            return;
+        }
+
         for (auto& write : writes) {
             write.dstSet = set;
         }
-        vkUpdateDescriptorSets(pool.lveDevice.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        vkUpdateDescriptorSets(setLayout.lveDevice.getDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
 
 }  // namespace lve
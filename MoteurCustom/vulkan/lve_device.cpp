@@ -1,7 +1,14 @@
 #include "lve_device.hpp"
+#include "lve_bindless_table.hpp"
+#include "lve_deletion_queue.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_shader_library.hpp"
 
 // std headers
+#include <cassert>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -10,6 +17,17 @@
 
 namespace lve {
 
+    // en-tête ajouté devant les données du cache de pipelines sur le disque
+    struct PipelineCacheFileHeader {
+        uint32_t magic;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+    };
+    static constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x4350564C;  // "LVPC"
+
     // local callback functions
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
         std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
@@ -34,21 +52,43 @@ namespace lve {
     }
 
     /// <summary>
-    ///   Initialise un objet LveDevice en crant l'instance Vulkan, le dbogueur, la surface, le priphrique physique, le priphrique logique et le pool de commandes
+    ///   Initialise un objet LveDevice en créant l'instance Vulkan, le débogueur, la surface, le périphérique physique, le périphérique logique et le pool de commandes
+    /// </summary>
+    /// <param name="window"></param>
+    LveDevice::LveDevice(LveWindow& window) : LveDevice{ &window } {}
+    /// <summary>
+    /// Sans fenêtre (window nul), le device est headless : ni surface, ni file de présentation, ni extension de swap chain.
+    /// Il peut alors tourner sur un pilote logiciel (lavapipe) sur une machine sans GPU ni serveur graphique
     /// </summary>
     /// <param name="window"></param>
-    LveDevice::LveDevice(LveWindow& window) : window{ window } {
+    LveDevice::LveDevice(LveWindow* window) : window{ window } {
+        if (isHeadless()) {
+            deviceExtensions.clear();
+        }
         createInstance();
         setupDebugMessenger();
         createSurface();
         pickPhysicalDevice();
         createLogicalDevice();
         createCommandPool();
+        createPipelineCache();
+        createTimeline();
+        deletionQueue = std::make_unique<LveDeletionQueue>(*this);
+        // créée ici plutôt qu'au premier appel : les pipelines sont construits depuis plusieurs threads
+        shaderLibrary = std::make_unique<LveShaderLibrary>(*this);
     }
     /// <summary>
-    ///  Libre les ressources alloues par l'objet LveDevice
+    ///  Libère les ressources allouées par l'objet LveDevice
     /// </summary>
     LveDevice::~LveDevice() {
+        // les modèles différés rendent leurs plages au pool : vidé avant lui, puis une dernière fois pour les tampons du pool
+        deletionQueue->flush();
+        geometryPool.reset();
+        shaderLibrary.reset();
+        deletionQueue.reset();
+        savePipelineCache();
+        vkDestroyPipelineCache(device_, pipelineCache, nullptr);
+        vkDestroySemaphore(device_, timeline, nullptr);
         vkDestroyCommandPool(device_, commandPool, nullptr);
         vkDestroyDevice(device_, nullptr);
 
@@ -56,11 +96,14 @@ namespace lve {
             DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(instance, surface_, nullptr);
+        // headless : VK_KHR_surface n'est pas activée et aucune surface n'a été créée
+        if (surface_ != VK_NULL_HANDLE) {
+            vkDestroySurfaceKHR(instance, surface_, nullptr);
+        }
         vkDestroyInstance(instance, nullptr);
     }
     /// <summary>
-    ///  Cre l'instance Vulkan avec les extensions et les couches de validation
+    ///  Crée l'instance Vulkan avec les extensions et les couches de validation
     /// </summary>
     void LveDevice::createInstance() {
         if (enableValidationLayers && !checkValidationLayerSupport()) {
@@ -73,7 +116,7 @@ namespace lve {
         appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName = "No Engine";
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion = VK_API_VERSION_1_0;
+        appInfo.apiVersion = VK_API_VERSION_1_2;
 
         VkInstanceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -102,7 +145,7 @@ namespace lve {
         hasGflwRequiredInstanceExtensions();
     }
     /// <summary>
-    /// Slectionne le priphrique physique appropri
+    /// Sélectionne le périphérique physique appropri
     /// </summary>
     void LveDevice::pickPhysicalDevice() {
         uint32_t deviceCount = 0;
@@ -129,13 +172,16 @@ namespace lve {
         std::cout << "physical device: " << properties.deviceName << std::endl;
     }
     /// <summary>
-    /// Cre le priphrique logique avec les files d'attente requises
+    /// Crée le périphérique logique avec les files d'attente requises
     /// </summary>
     void LveDevice::createLogicalDevice() {
         QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentFamily };
+        std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily };
+        if (!isHeadless()) {
+            uniqueQueueFamilies.insert(indices.presentFamily);
+        }
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -147,18 +193,86 @@ namespace lve {
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+        multiDrawIndirect = supportedFeatures.multiDrawIndirect == VK_TRUE;
+        drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+        pipelineStatistics = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        // optionnel : avec drawIndirectCount, nécessaire au culling des clusters (un draw indirect par liste de clusters)
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        // optionnel : les commandes des clusters désignent les données de leur objet par firstInstance
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+        // optionnel : invocations de vertex et de fragment par trame dans le profileur GPU
+        deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+        // fonctionnalités Vulkan 1.2 : timeline semaphore (obligatoire, vérifié par isDeviceSuitable)
+        // et descriptor indexing (optionnel, mode bindless : tableaux de descripteurs mis à jour après le bind)
+        VkPhysicalDeviceVulkan12Features supported12{};
+        supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &supported12;
+        vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+
+        bindless = supported12.runtimeDescriptorArray && supported12.descriptorBindingPartiallyBound
+            && supported12.shaderSampledImageArrayNonUniformIndexing && supported12.shaderStorageBufferArrayNonUniformIndexing
+            && supported12.descriptorBindingSampledImageUpdateAfterBind && supported12.descriptorBindingStorageBufferUpdateAfterBind
+            && supported12.descriptorBindingUpdateUnusedWhilePending;
+        if (bindless) {
+            // les deux tableaux sont visibles de tous les étages : la capacité de la table doit tenir dans les limites par étage
+            VkPhysicalDeviceVulkan12Properties properties12{};
+            properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+            VkPhysicalDeviceProperties2 properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &properties12;
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+            bindless = properties12.maxPerStageDescriptorUpdateAfterBindSampledImages >= LveBindlessTable::MAX_TEXTURES
+                && properties12.maxPerStageDescriptorUpdateAfterBindSamplers >= LveBindlessTable::MAX_TEXTURES
+                && properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers >= LveBindlessTable::MAX_BUFFERS
+                && properties12.maxPerStageUpdateAfterBindResources >= LveBindlessTable::MAX_TEXTURES + LveBindlessTable::MAX_BUFFERS;
+            if (!bindless) {
+                std::cout << "Bindless disabled: update-after-bind limits below " << LveBindlessTable::MAX_TEXTURES
+                    << " textures / " << LveBindlessTable::MAX_BUFFERS << " buffers" << std::endl;
+            }
+        }
+
+        VkPhysicalDeviceVulkan12Features enabled12{};
+        enabled12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        enabled12.timelineSemaphore = VK_TRUE;
+        // optionnel : le nombre de clusters visibles est lu sur le GPU par vkCmdDrawIndexedIndirectCount
+        drawIndirectCount = supported12.drawIndirectCount == VK_TRUE;
+        enabled12.drawIndirectCount = supported12.drawIndirectCount;
+        if (bindless) {
+            enabled12.runtimeDescriptorArray = VK_TRUE;
+            enabled12.descriptorBindingPartiallyBound = VK_TRUE;
+            enabled12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            enabled12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+            enabled12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            enabled12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            enabled12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+        }
+
+        // optionnel : mémoire utilisée par tas, pour les rapports de benchmark
+        std::vector<const char*> extensions = deviceExtensions;
+        memoryBudget = hasDeviceExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        if (memoryBudget) {
+            extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+        }
 
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext = &enabled12;
 
         createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames = extensions.data();
 
         // might not really be necessary anymore because device specific validation layers
         // have been deprecated
@@ -174,10 +288,101 @@ namespace lve {
         }
 
         vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
-        vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+        if (!isHeadless()) {
+            vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+        }
     }
     /// <summary>
-    /// Cre le pool de commandes pour le priphrique
+    /// Crée le cache de pipelines partagé par tous les LvePipeline, pré-rempli avec PIPELINE_CACHE_PATH s'il existe.
+    /// Le fichier n'est utilisé que s'il a été écrit par le même GPU (vendorID, deviceID, UUID du cache) et la même version du pilote ;
+    /// sinon on repart d'un cache vide, le pilote recompilera les shaders
+    /// </summary>
+    void LveDevice::createPipelineCache() {
+        std::vector<char> initialData{};
+        std::ifstream file(PIPELINE_CACHE_PATH, std::ios::binary);
+        if (file.is_open()) {
+            PipelineCacheFileHeader header{};
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            bool valid = file.gcount() == sizeof(header)
+                && header.magic == PIPELINE_CACHE_MAGIC
+                && header.vendorID == properties.vendorID
+                && header.deviceID == properties.deviceID
+                && header.driverVersion == properties.driverVersion
+                && std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0
+                && header.dataSize >= sizeof(VkPipelineCacheHeaderVersionOne);
+            if (valid) {
+                initialData.resize(static_cast<size_t>(header.dataSize));
+                file.read(initialData.data(), initialData.size());
+                valid = static_cast<size_t>(file.gcount()) == initialData.size();
+            }
+            if (valid) {
+                // le pilote fait aussi cette vérification, mais certains acceptent mal des données d'un autre GPU
+                VkPipelineCacheHeaderVersionOne vulkanHeader{};
+                std::memcpy(&vulkanHeader, initialData.data(), sizeof(vulkanHeader));
+                valid = vulkanHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+                    && vulkanHeader.vendorID == properties.vendorID
+                    && vulkanHeader.deviceID == properties.deviceID
+                    && std::memcmp(vulkanHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+            }
+            if (!valid) {
+                std::cout << "Pipeline cache " << PIPELINE_CACHE_PATH << " is stale, starting empty" << std::endl;
+                initialData.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = initialData.size();
+        cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+        if (vkCreatePipelineCache(device_, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+        pipelineCacheLoadedBytes = initialData.size();
+    }
+    /// <summary>
+    /// Écrit le contenu du cache de pipelines sur le disque, précédé de PipelineCacheFileHeader.
+    /// Le fichier est d'abord écrit à côté puis renommé, pour ne jamais laisser un cache tronqué si l'application est interrompue
+    /// </summary>
+    void LveDevice::savePipelineCache() {
+        if (pipelineCache == VK_NULL_HANDLE) {
+            return;
+        }
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(device_, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+            return;
+        }
+        std::vector<char> data(dataSize);
+        if (vkGetPipelineCacheData(device_, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+            return;
+        }
+
+        PipelineCacheFileHeader header{};
+        header.magic = PIPELINE_CACHE_MAGIC;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+        header.dataSize = dataSize;
+
+        std::string temporaryPath = std::string(PIPELINE_CACHE_PATH) + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "failed to write pipeline cache " << temporaryPath << std::endl;
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(data.data(), dataSize);
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, PIPELINE_CACHE_PATH, error);
+        if (error) {
+            std::cerr << "failed to replace pipeline cache: " << error.message() << std::endl;
+        }
+    }
+    /// <summary>
+    /// Crée le pool de commandes pour le périphérique
     /// </summary>
     void LveDevice::createCommandPool() {
         QueueFamilyIndices queueFamilyIndices = findPhysicalQueueFamilies();
@@ -192,13 +397,16 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Cre la surface pour la fentre associe au priphrique
+    /// Crée la surface pour la fenêtre associée au périphérique
     /// </summary>
     void LveDevice::createSurface() {
-        window.createWindowSurface(instance, &surface_);
+        if (isHeadless()) {
+            return;
+        }
+        window->createWindowSurface(instance, &surface_);
     }
     /// <summary>
-    /// Vrifie si le priphrique physique est adapt  l'application
+    /// Vérifie si le périphérique physique est adapté à l'application
     /// </summary>
     /// <param name="device"></param>
     /// <returns></returns>
@@ -207,8 +415,9 @@ namespace lve {
 
         bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported) {
+        // headless : pas de surface, donc pas de chaîne d'échanges ni de file de présentation à vérifier
+        bool swapChainAdequate = isHeadless();
+        if (extensionsSupported && !isHeadless()) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -216,10 +425,28 @@ namespace lve {
         VkPhysicalDeviceFeatures supportedFeatures;
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
-        return indices.isComplete() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
+        // Vulkan 1.2 pour les descriptor update templates et les timeline semaphores
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(device, &deviceProperties);
+        bool apiSupported = deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+
+        bool timelineSupported = false;
+        if (apiSupported) {
+            VkPhysicalDeviceVulkan12Features features12{};
+            features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            VkPhysicalDeviceFeatures2 features2{};
+            features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext = &features12;
+            vkGetPhysicalDeviceFeatures2(device, &features2);
+            timelineSupported = features12.timelineSemaphore == VK_TRUE;
+        }
+
+        bool queuesFound = isHeadless() ? indices.graphicsFamilyHasValue : indices.isComplete();
+
+        return queuesFound && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy && apiSupported && timelineSupported;
     }
     /// <summary>
-    /// Initialise la structure de cration pour le dbogueur
+    /// Initialise la structure de création pour le débogueur
     /// </summary>
     /// <param name="createInfo"></param>
     void LveDevice::populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
@@ -231,7 +458,7 @@ namespace lve {
         createInfo.pUserData = nullptr;  // Optional
     }
     /// <summary>
-    /// Configure le dbogueur
+    /// Configure le débogueur
     /// </summary>
     void LveDevice::setupDebugMessenger() {
         if (!enableValidationLayers) return;
@@ -242,7 +469,7 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Vrifie la disponibilit des couches de validation
+    /// Vérifie la disponibilité des couches de validation
     /// </summary>
     /// <returns></returns>
     bool LveDevice::checkValidationLayerSupport() {
@@ -270,15 +497,18 @@ namespace lve {
         return true;
     }
     /// <summary>
-    /// Rcupre les extensions Vulkan ncessaires
+    /// Récupère les extensions Vulkan nécessaires
     /// </summary>
     /// <returns></returns>
     std::vector<const char*> LveDevice::getRequiredExtensions() {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        std::vector<const char*> extensions{};
+        // GLFW n'est pas initialisé en headless, aucune extension de surface n'est nécessaire
+        if (!isHeadless()) {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers) {
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -287,7 +517,7 @@ namespace lve {
         return extensions;
     }
     /// <summary>
-    /// Vrifie la disponibilit des extensions ncessaires  GLFW
+    /// Vérifie la disponibilité des extensions nécessaires à GLFW
     /// </summary>
     void LveDevice::hasGflwRequiredInstanceExtensions() {
         uint32_t extensionCount = 0;
@@ -312,7 +542,7 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Vrifie la disponibilit des extensions pour le priphrique physique
+    /// Vérifie la disponibilité des extensions pour le périphérique physique
     /// </summary>
     /// <param name="device"></param>
     /// <returns></returns>
@@ -332,7 +562,27 @@ namespace lve {
         return requiredExtensions.empty();
     }
     /// <summary>
-    /// Trouve les files d'attente ncessaires pour le priphrique physique
+    /// Indique si le périphérique physique propose une extension optionnelle
+    /// </summary>
+    /// <param name="device"></param>
+    /// <param name="extensionName"></param>
+    /// <returns></returns>
+    bool LveDevice::hasDeviceExtension(VkPhysicalDevice device, const char* extensionName) {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions) {
+            if (strcmp(extension.extensionName, extensionName) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    /// <summary>
+    /// Trouve les files d'attente nécessaires pour le périphérique physique
     /// </summary>
     /// <param name="device"></param>
     /// <returns></returns>
@@ -352,12 +602,14 @@ namespace lve {
                 indices.graphicsFamilyHasValue = true;
             }
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+            if (surface_ != VK_NULL_HANDLE) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+            }
             if (queueFamily.queueCount > 0 && presentSupport) {
                 indices.presentFamily = i;
                 indices.presentFamilyHasValue = true;
             }
-            if (indices.isComplete()) {
+            if (indices.isComplete() || (isHeadless() && indices.graphicsFamilyHasValue)) {
                 break;
             }
 
@@ -367,7 +619,7 @@ namespace lve {
         return indices;
     }
     /// <summary>
-    /// Interroge le support de la chane de balayage pour le priphrique physique
+    /// Interroge le support de la chaîne de balayage pour le périphérique physique
     /// </summary>
     /// <param name="device"></param>
     /// <returns></returns>
@@ -393,7 +645,7 @@ namespace lve {
         return details;
     }
     /// <summary>
-    ///  Trouve le format support
+    ///  Trouve le format supporté
     /// </summary>
     /// <param name="candidates"></param>
     /// <param name="tiling"></param>
@@ -414,7 +666,7 @@ namespace lve {
         throw std::runtime_error("failed to find supported format!");
     }
     /// <summary>
-    /// Trouve le type de mmoire appropri
+    /// Trouve le type de mémoire approprié
     /// </summary>
     /// <param name="typeFilter"></param>
     /// <param name="properties"></param>
@@ -431,7 +683,7 @@ namespace lve {
         throw std::runtime_error("failed to find suitable memory type!");
     }
     /// <summary>
-    /// Cre un tampon Vulkan
+    /// Crée un tampon Vulkan
     /// </summary>
     /// <param name="size"></param>
     /// <param name="usage"></param>
@@ -485,41 +737,172 @@ namespace lve {
         return commandBuffer;
     }
     /// <summary>
-    /// Soumet et libre un tampon de commandes  utilisation unique
+    /// Soumet et libère un tampon de commandes à utilisation unique
     /// </summary>
     /// <param name="commandBuffer"></param>
     void LveDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
         vkEndCommandBuffer(commandBuffer);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphicsQueue_);
+        // attend seulement cette soumission, pas les trames en vol sur la même file
+        waitForTimeline(submitGraphics({ commandBuffer }));
 
         vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
     }
     /// <summary>
-    /// Copie les donnes d'un tampon  un autre
+    /// Crée le timeline semaphore de la file graphique. Sa valeur est le nombre de soumissions terminées par le GPU :
+    /// attentes CPU, fin des transferts, destructions différées et relectures se règlent toutes sur ce même compteur
+    /// </summary>
+    void LveDevice::createTimeline() {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+
+        VkSemaphoreCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeInfo;
+
+        if (vkCreateSemaphore(device_, &createInfo, nullptr, &timeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timeline semaphore!");
+        }
+    }
+    /// <summary>
+    /// Soumet des tampons de commandes sur la file graphique et y ajoute le signal du timeline semaphore.
+    /// Les sémaphores binaires restent possibles pour l'acquisition et la présentation de la swap chain.
+    /// Retourne la valeur du timeline qui sera atteinte quand le GPU aura fini ces commandes
+    /// </summary>
+    /// <param name="commandBuffers"></param>
+    /// <param name="waitSemaphores"></param>
+    /// <param name="waitStages"></param>
+    /// <param name="signalSemaphores"></param>
+    /// <returns></returns>
+    uint64_t LveDevice::submitGraphics(std::initializer_list<VkCommandBuffer> commandBuffers, std::initializer_list<VkSemaphore> waitSemaphores,
+        std::initializer_list<VkPipelineStageFlags> waitStages, std::initializer_list<VkSemaphore> signalSemaphores) {
+        assert(waitSemaphores.size() == waitStages.size() && "Each wait semaphore needs a wait stage");
+        assert(signalSemaphores.size() <= MAX_SUBMIT_SIGNALS && "Too many signal semaphores");
+
+        // tableaux sur la pile : le timeline est ajouté après les sémaphores binaires, dont les valeurs sont ignorées
+        VkSemaphore signals[MAX_SUBMIT_SIGNALS + 1]{};
+        uint64_t signalValues[MAX_SUBMIT_SIGNALS + 1]{};
+        uint32_t signalCount = 0;
+        for (VkSemaphore semaphore : signalSemaphores) {
+            signals[signalCount++] = semaphore;
+        }
+        signals[signalCount] = timeline;
+
+        // la valeur est réservée et la soumission faite sous le même verrou pour que le timeline reste croissant
+        std::lock_guard<std::mutex> lock{ submitMutex };
+        signalValues[signalCount++] = ++lastSubmittedValue;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = signalCount;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+        submitInfo.pWaitSemaphores = waitSemaphores.begin();
+        submitInfo.pWaitDstStageMask = waitStages.begin();
+        submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+        submitInfo.pCommandBuffers = commandBuffers.begin();
+        submitInfo.signalSemaphoreCount = signalCount;
+        submitInfo.pSignalSemaphores = signals;
+
+        if (vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            --lastSubmittedValue;
+            throw std::runtime_error("failed to submit command buffer!");
+        }
+        return lastSubmittedValue;
+    }
+    /// <summary>
+    /// Bloque le CPU jusqu'à ce que le timeline atteigne value. Ne fait rien si c'est déjà le cas
+    /// </summary>
+    /// <param name="value"></param>
+    void LveDevice::waitForTimeline(uint64_t value) {
+        if (value == 0 || getCompletedTimelineValue() >= value) {
+            return;
+        }
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timeline;
+        waitInfo.pValues = &value;
+
+        if (vkWaitSemaphores(device_, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("failed to wait for timeline semaphore!");
+        }
+    }
+    /// <summary>
+    /// Valeur atteinte par le timeline : toutes les soumissions jusqu'à celle-ci sont terminées
+    /// </summary>
+    /// <returns></returns>
+    uint64_t LveDevice::getCompletedTimelineValue() {
+        uint64_t value = 0;
+        vkGetSemaphoreCounterValue(device_, timeline, &value);
+        return value;
+    }
+    /// <summary>
+    /// Valeur qui sera atteinte quand tout ce qui a été soumis jusqu'ici sera terminé
+    /// </summary>
+    /// <returns></returns>
+    uint64_t LveDevice::getLastSubmittedTimelineValue() {
+        std::lock_guard<std::mutex> lock{ submitMutex };
+        return lastSubmittedValue;
+    }
+    /// <summary>
+    /// Mémoire utilisée par ce processus sur tous les tas du périphérique, d'après VK_EXT_memory_budget (0 si l'extension manque)
+    /// </summary>
+    /// <returns></returns>
+    VkDeviceSize LveDevice::getDeviceMemoryUsage() {
+        if (!memoryBudget) {
+            return 0;
+        }
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+        memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        memoryProperties.pNext = &budget;
+        vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &memoryProperties);
+
+        VkDeviceSize usage = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++) {
+            usage += budget.heapUsage[i];
+        }
+        return usage;
+    }
+    /// <summary>
+    /// Retourne le pool de géométrie partagé par tous les modèles, créé au premier appel
+    /// </summary>
+    /// <returns></returns>
+    LveGeometryPool& LveDevice::getGeometryPool() {
+        if (!geometryPool) {
+            geometryPool = std::make_unique<LveGeometryPool>(*this);
+        }
+        return *geometryPool;
+    }
+    /// <summary>
+    /// Copie les données d'un tampon à un autre
     /// </summary>
     /// <param name="srcBuffer"></param>
     /// <param name="dstBuffer"></param>
     /// <param name="size"></param>
-    void LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    /// <param name="srcOffset"></param>
+    /// <param name="dstOffset"></param>
+    void LveDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset) {
         VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0;  // Optional
-        copyRegion.dstOffset = 0;  // Optional
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
         copyRegion.size = size;
         vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
         endSingleTimeCommands(commandBuffer);
     }
     /// <summary>
-    /// Copie les donnes d'un tampon  une image
+    /// Copie les données d'un tampon à une image
     /// </summary>
     /// <param name="buffer"></param>
     /// <param name="image"></param>
@@ -546,7 +929,7 @@ namespace lve {
         endSingleTimeCommands(commandBuffer);
     }
     /// <summary>
-    /// Cre une image Vulkan avec des informations spcifies
+    /// Crée une image Vulkan avec des informations spécifiées
     /// </summary>
     /// <param name="imageInfo"></param>
     /// <param name="properties"></param>
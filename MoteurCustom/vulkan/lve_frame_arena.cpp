@@ -0,0 +1,101 @@
+#include "lve_frame_arena.hpp"
+
+//std
+#include <algorithm>
+#include <unordered_map>
+
+namespace lve {
+    std::atomic<uint64_t> LveFrameArena::nextId{ 0 };
+    /// <summary>
+    /// Arène du thread appelant. Un thread n'est associé qu'à une arène par LveFrameArena : la table thread_local
+    /// évite de prendre le verrou après le premier appel. Elle est indexée par l'identifiant unique de l'instance,
+    /// pas par son adresse : une LveFrameArena recréée à la même adresse ne retrouve pas les arènes détruites
+    /// </summary>
+    /// <returns></returns>
+    LveFrameArena::ThreadArena& LveFrameArena::local() {
+        thread_local std::unordered_map<uint64_t, ThreadArena*> arenas{};
+        auto it = arenas.find(id);
+        if (it != arenas.end()) {
+            return *it->second;
+        }
+        std::lock_guard<std::mutex> lock{ threadsMutex };
+        threads.push_back(std::make_unique<ThreadArena>(blockSize));
+        arenas[id] = threads.back().get();
+        return *threads.back();
+    }
+    /// <summary>
+    /// Ressource à passer aux conteneurs std::pmr : l'arène du thread si elle existe, sinon le tas (new/delete)
+    /// </summary>
+    /// <param name="arena"></param>
+    /// <returns></returns>
+    std::pmr::memory_resource* LveFrameArena::resourceOf(LveFrameArena* arena) {
+        return arena ? &arena->local() : std::pmr::get_default_resource();
+    }
+    /// <summary>
+    /// Remet toutes les arènes à zéro. À appeler en début de trame, quand plus aucun thread n'utilise ce qui a été alloué à la trame précédente
+    /// </summary>
+    void LveFrameArena::reset() {
+        std::lock_guard<std::mutex> lock{ threadsMutex };
+        for (auto& arena : threads) {
+            arena->reset();
+        }
+    }
+
+    size_t LveFrameArena::usedBytes() const {
+        std::lock_guard<std::mutex> lock{ threadsMutex };
+        size_t total = 0;
+        for (const auto& arena : threads) {
+            total += arena->usedBytes();
+        }
+        return total;
+    }
+    /// <summary>
+    /// Réserve bytes octets alignés dans le bloc courant, ou dans un nouveau bloc (au moins blockSize) s'il n'y a plus la place
+    /// </summary>
+    /// <param name="bytes"></param>
+    /// <param name="alignment"></param>
+    /// <returns></returns>
+    void* LveFrameArena::ThreadArena::do_allocate(size_t bytes, size_t alignment) {
+        while (current < blocks.size()) {
+            Block& block = blocks[current];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+            size_t aligned = ((base + offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+            if (aligned + bytes <= block.size) {
+                used += aligned + bytes - offset;
+                offset = aligned + bytes;
+                return block.memory.get() + aligned;
+            }
+            current++;
+            offset = 0;
+        }
+
+        // le bloc est alloué avec new[] : l'alignement garanti est celui de max_align_t, on prévoit la marge pour les alignements plus grands
+        size_t size = std::max(blockSize, bytes + alignment);
+        blocks.push_back({ std::make_unique<std::byte[]>(size), size });
+        current = blocks.size() - 1;
+        offset = 0;
+        return do_allocate(bytes, alignment);
+    }
+    /// <summary>
+    /// Repart du premier bloc. Si la trame a débordé sur plusieurs blocs, ils sont remplacés par un seul bloc de leur taille totale :
+    /// après quelques trames, une trame typique tient dans un bloc et l'arène n'alloue plus rien
+    /// </summary>
+    void LveFrameArena::ThreadArena::reset() {
+        if (blocks.size() > 1) {
+            size_t total = capacity();
+            blocks.clear();
+            blocks.push_back({ std::make_unique<std::byte[]>(total), total });
+        }
+        current = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    size_t LveFrameArena::ThreadArena::capacity() const {
+        size_t total = 0;
+        for (const auto& block : blocks) {
+            total += block.size;
+        }
+        return total;
+    }
+}
@@ -0,0 +1,104 @@
+#include "lve_frame_limiter.hpp"
+
+//std
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+namespace lve {
+    // marge d'attente active ; elle grandit si le système réveille le thread en retard, sans dépasser le plafond :
+    // au-delà, le limiteur passerait la trame à attendre activement et monopoliserait le processeur
+    static constexpr std::chrono::microseconds MIN_SPIN_MARGIN{ 1000 };
+    static constexpr std::chrono::microseconds MAX_SPIN_MARGIN{ 4000 };
+
+    /// <summary>
+    /// Sous Windows, crée un timer haute résolution (Windows 10 1803 et plus) : sleep_for seul arrondit au tick système (~15,6 ms)
+    /// </summary>
+    /// <param name="targetFps"></param>
+    LveFrameLimiter::LveFrameLimiter(double targetFps) {
+#ifdef _WIN32
+        timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+        setTargetFps(targetFps);
+    }
+
+    LveFrameLimiter::~LveFrameLimiter() {
+#ifdef _WIN32
+        if (timer) {
+            CloseHandle(timer);
+        }
+#endif
+    }
+    /// <summary>
+    /// Change la cadence visée ; 0 désactive le limiteur
+    /// </summary>
+    /// <param name="targetFps"></param>
+    void LveFrameLimiter::setTargetFps(double targetFps) {
+        period = targetFps > 0.0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps))
+            : Clock::duration::zero();
+        deadline = Clock::now() + period;
+        spinMargin = MIN_SPIN_MARGIN;
+    }
+    /// <summary>
+    /// Attend l'échéance de la trame : sleep jusqu'à spinMargin avant l'échéance, puis attente active.
+    /// spinMargin suit le retard de réveil mesuré (avec une décroissance lente), pour ne dormir que quand c'est sûr.
+    /// Si la boucle a pris plus d'une période de retard, l'échéance repart de maintenant au lieu d'enchaîner les trames
+    /// </summary>
+    void LveFrameLimiter::wait() {
+        if (period == Clock::duration::zero()) {
+            return;
+        }
+
+        auto now = Clock::now();
+        if (now - deadline > period) {
+            deadline = now;
+        }
+
+        auto remaining = deadline - now;
+        if (remaining > spinMargin) {
+            auto requested = remaining - spinMargin;
+            sleepFor(requested);
+            auto overshoot = (Clock::now() - now) - requested;
+            spinMargin = std::clamp<Clock::duration>(std::max<Clock::duration>(overshoot, spinMargin - spinMargin / 16), MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+        }
+
+        while (Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        deadline += period;
+    }
+    /// <summary>
+    /// Dort pendant duration. Sous Windows : avec le timer haute résolution s'il existe, sinon en abaissant
+    /// la période du timer système à 1 ms le temps du sleep
+    /// </summary>
+    /// <param name="duration"></param>
+    void LveFrameLimiter::sleepFor(Clock::duration duration) {
+#ifdef _WIN32
+        if (timer) {
+            // temps relatif : négatif, en unités de 100 ns
+            LARGE_INTEGER dueTime{};
+            dueTime.QuadPart = -std::max<LONGLONG>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100);
+            if (SetWaitableTimer(timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(timer, INFINITE);
+                return;
+            }
+        }
+        timeBeginPeriod(1);
+        std::this_thread::sleep_for(duration);
+        timeEndPeriod(1);
+#else
+        std::this_thread::sleep_for(duration);
+#endif
+    }
+}
@@ -139,4 +139,20 @@ namespace lve {
         gameObj.pointLight->lightIntensity = intensity;
         return gameObj;
     }
-}
\ No newline at end of file
+    /// <summary>
+    /// Copie de l'objet pour le thread de rendu, avec le même identifiant : le modèle est partagé, les composants sont dupliqués
+    /// </summary>
+    /// <returns></returns>
+    LveGameObject LveGameObject::makeRenderProxy() const {
+        LveGameObject proxy{ id };
+        proxy.model = model;
+        proxy.color = color;
+        proxy.transform = transform;
+        if (pointLight) {
+            proxy.pointLight = std::make_unique<PointLightComponent>(*pointLight);
+        }
+        proxy.lodIndex = lodIndex;
+        proxy.materialIndex = materialIndex;
+        return proxy;
+    }
+}
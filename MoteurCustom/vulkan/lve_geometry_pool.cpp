@@ -0,0 +1,306 @@
+#include "lve_geometry_pool.hpp"
+#include "lve_deletion_queue.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+    static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    /// <summary>
+    /// Crée les trois tampons du pool (vertices, indices et clusters), device-local, avec les capacités initiales demandées.
+    /// Le tas des clusters n'est lu que par la passe de culling en compute
+    /// </summary>
+    /// <param name="device"></param>
+    /// <param name="vertexCapacity"></param>
+    /// <param name="indexCapacity"></param>
+    /// <param name="clusterCapacity"></param>
+    LveGeometryPool::LveGeometryPool(LveDevice& device, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity, VkDeviceSize clusterCapacity) : lveDevice{ device } {
+        createHeap(heaps[static_cast<size_t>(Heap::Vertex)], vertexCapacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        createHeap(heaps[static_cast<size_t>(Heap::Index)], indexCapacity, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+        createHeap(heaps[static_cast<size_t>(Heap::Cluster)], clusterCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    }
+
+    LveGeometryPool::~LveGeometryPool() {}
+
+    void LveGeometryPool::createHeap(HeapStorage& storage, VkDeviceSize capacity, VkBufferUsageFlags usage) {
+        storage.usage = usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        storage.capacity = capacity;
+        storage.buffer = std::make_unique<LveBuffer>(lveDevice, capacity, 1, storage.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        storage.freeBlocks.clear();
+        storage.freeBlocks[0] = capacity;
+    }
+    /// <summary>
+    /// Réserve size octets dans le tas demandé, à un offset multiple de alignment.
+    /// Pour les vertices, l'alignement est la taille d'un vertex afin que offset / alignment donne directement le vertexOffset.
+    /// Le tampon est agrandi (copie GPU) si aucun bloc libre ne convient
+    /// </summary>
+    /// <param name="heap"></param>
+    /// <param name="size"></param>
+    /// <param name="alignment"></param>
+    /// <returns></returns>
+    LveGeometryPool::Handle LveGeometryPool::allocate(Heap heap, VkDeviceSize size, VkDeviceSize alignment) {
+        assert(size > 0 && alignment > 0 && "Geometry allocation must have a size and an alignment");
+        HeapStorage& storage = heaps[static_cast<size_t>(heap)];
+
+        VkDeviceSize offset = 0;
+        if (!takeBlock(storage, size, alignment, 0, storage.capacity, offset)) {
+            grow(storage, storage.capacity + size + alignment);
+            if (!takeBlock(storage, size, alignment, 0, storage.capacity, offset)) {
+                throw std::runtime_error("failed to allocate geometry from pool!");
+            }
+        }
+
+        Handle handle;
+        if (!storage.freeHandles.empty()) {
+            handle = storage.freeHandles.back();
+            storage.freeHandles.pop_back();
+        } else {
+            handle = static_cast<Handle>(storage.allocations.size());
+            storage.allocations.emplace_back();
+        }
+        storage.allocations[handle] = { offset, size, alignment, true };
+        storage.usedBytes += size;
+        return handle;
+    }
+    /// <summary>
+    /// Rend la plage au tas ; les blocs libres voisins sont fusionnés
+    /// </summary>
+    /// <param name="heap"></param>
+    /// <param name="handle"></param>
+    void LveGeometryPool::free(Heap heap, Handle handle) {
+        HeapStorage& storage = heaps[static_cast<size_t>(heap)];
+        assert(handle < storage.allocations.size() && storage.allocations[handle].live && "Invalid geometry handle");
+
+        Allocation& allocation = storage.allocations[handle];
+        releaseBlock(storage, allocation.offset, allocation.size);
+        storage.usedBytes -= allocation.size;
+        allocation.live = false;
+        storage.freeHandles.push_back(handle);
+    }
+    /// <summary>
+    /// Copie les données dans la plage de l'allocation en passant par un tampon temporaire visible par le CPU
+    /// </summary>
+    /// <param name="heap"></param>
+    /// <param name="handle"></param>
+    /// <param name="data"></param>
+    /// <param name="size"></param>
+    void LveGeometryPool::upload(Heap heap, Handle handle, const void* data, VkDeviceSize size) {
+        HeapStorage& storage = heaps[static_cast<size_t>(heap)];
+        const Allocation& allocation = storage.allocations[handle];
+        assert(size <= allocation.size && "Upload does not fit in the geometry allocation");
+
+        LveBuffer stagingBuffer{ lveDevice, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+        stagingBuffer.map();
+        stagingBuffer.writeToBuffer(const_cast<void*>(data));
+
+        lveDevice.copyBuffer(stagingBuffer.getBuffer(), storage.buffer->getBuffer(), size, 0, allocation.offset);
+    }
+    /// <summary>
+    /// Lie le tampon de vertex et le tampon d'indices du pool. Les appels redondants sur le même tampon de commandes sont ignorés,
+    /// seul un changement de type d'indice provoque un nouveau vkCmdBindIndexBuffer
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="indexType"></param>
+    void LveGeometryPool::bind(VkCommandBuffer commandBuffer, VkIndexType indexType) {
+        if (commandBuffer != boundCommandBuffer) {
+            VkBuffer buffers[] = { getBuffer(Heap::Vertex) };
+            VkDeviceSize offsets[] = { 0 };
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+            vkCmdBindIndexBuffer(commandBuffer, getBuffer(Heap::Index), 0, indexType);
+            boundCommandBuffer = commandBuffer;
+            boundIndexType = indexType;
+        } else if (indexType != boundIndexType) {
+            vkCmdBindIndexBuffer(commandBuffer, getBuffer(Heap::Index), 0, indexType);
+            boundIndexType = indexType;
+        }
+    }
+    /// <summary>
+    /// Compactage incrémental : déplace au plus une allocation par tas et par appel. Les copies sont enregistrées dans le tampon
+    /// de commandes de la trame, avant tout dessin et avant le culling : rien n'attend le GPU. L'ancienne plage n'est rendue
+    /// au tas qu'une fois cette trame terminée, les trames en vol la lisent encore.
+    /// Retourne true si quelque chose a été déplacé
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <returns></returns>
+    bool LveGeometryPool::compactStep(VkCommandBuffer commandBuffer) {
+        bool moved = false;
+        for (size_t heap = 0; heap < 3; heap++) {
+            moved = compactHeap(heap, commandBuffer, moved) || moved;
+        }
+        if (moved) {
+            // les copies doivent être visibles des lectures de vertices, d'indices et des shaders (clusters) de la trame
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+        return moved;
+    }
+    /// <summary>
+    /// Un pas de compactage d'un tas, qui est compact quand tout l'espace libre forme un seul bloc en haut du tampon.
+    /// Descente : l'allocation la plus haute qui tient dans un trou situé avant elle y est déplacée.
+    /// Si aucune ne tient (trous plus petits que les allocations au-dessus), l'allocation qui suit le premier trou récupérable
+    /// est remontée dans l'espace libre au-dessus d'elle : son ancienne plage fusionne avec le trou une fois libérée, et le pas
+    /// suivant l'y redescend, décalée de la taille du trou. Aucune remontée tant qu'un déplacement attend sa libération,
+    /// pour ne pas remonter d'autres allocations avant que la fusion ait eu lieu
+    /// </summary>
+    /// <param name="heap"></param>
+    /// <param name="commandBuffer"></param>
+    /// <param name="barrierRecorded">une copie d'un autre tas a déjà enregistré la barrière de début</param>
+    /// <returns></returns>
+    bool LveGeometryPool::compactHeap(size_t heap, VkCommandBuffer commandBuffer, bool barrierRecorded) {
+        HeapStorage& storage = heaps[heap];
+        if (storage.freeBlocks.empty()) {
+            return false;
+        }
+        VkDeviceSize firstHole = storage.freeBlocks.begin()->first;
+
+        Handle highest = INVALID_HANDLE;
+        VkDeviceSize highestOffset = 0;
+        for (Handle h = 0; h < storage.allocations.size(); h++) {
+            const Allocation& allocation = storage.allocations[h];
+            if (!allocation.live || allocation.offset < firstHole) continue;
+            VkDeviceSize offset = 0;
+            if ((highest == INVALID_HANDLE || allocation.offset > storage.allocations[highest].offset)
+                && findBlock(storage, allocation.size, allocation.alignment, 0, allocation.offset, offset)) {
+                highest = h;
+                highestOffset = offset;
+            }
+        }
+        if (highest != INVALID_HANDLE) {
+            const Allocation& allocation = storage.allocations[highest];
+            takeBlock(storage, allocation.size, allocation.alignment, highestOffset, allocation.offset, highestOffset);
+            moveAllocation(heap, highest, highestOffset, commandBuffer, barrierRecorded);
+            return true;
+        }
+
+        if (storage.pendingMoves > 0) {
+            return false;
+        }
+        for (const auto& [holeStart, holeSize] : storage.freeBlocks) {
+            // l'allocation qui suit le trou ; un trou qui n'est qu'un bourrage d'alignement ne la ferait pas descendre
+            Handle next = INVALID_HANDLE;
+            for (Handle h = 0; h < storage.allocations.size(); h++) {
+                const Allocation& allocation = storage.allocations[h];
+                if (allocation.live && allocation.offset > holeStart && (next == INVALID_HANDLE || allocation.offset < storage.allocations[next].offset)) {
+                    next = h;
+                }
+            }
+            if (next == INVALID_HANDLE) {
+                return false;  // rien au-dessus : c'est le dernier bloc libre, le tas est compact
+            }
+            const Allocation& allocation = storage.allocations[next];
+            if (alignUp(holeStart, allocation.alignment) >= allocation.offset) continue;
+
+            VkDeviceSize newOffset = 0;
+            if (takeBlock(storage, allocation.size, allocation.alignment, allocation.offset + allocation.size, storage.capacity, newOffset)) {
+                moveAllocation(heap, next, newOffset, commandBuffer, barrierRecorded);
+                return true;
+            }
+        }
+        return false;
+    }
+    /// <summary>
+    /// Enregistre la copie d'une allocation vers newOffset (déjà réservé) et diffère la libération de son ancienne plage
+    /// </summary>
+    void LveGeometryPool::moveAllocation(size_t heap, Handle handle, VkDeviceSize newOffset, VkCommandBuffer commandBuffer, bool barrierRecorded) {
+        HeapStorage& storage = heaps[heap];
+        Allocation& allocation = storage.allocations[handle];
+        if (!barrierRecorded) {
+            // la source peut être la destination d'une copie de la trame précédente
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = allocation.offset;
+        copyRegion.dstOffset = newOffset;
+        copyRegion.size = allocation.size;
+        vkCmdCopyBuffer(commandBuffer, storage.buffer->getBuffer(), storage.buffer->getBuffer(), 1, &copyRegion);
+
+        storage.pendingMoves++;
+        lveDevice.getDeletionQueue().defer([this, heap, offset = allocation.offset, size = allocation.size]() {
+            releaseBlock(heaps[heap], offset, size);
+            heaps[heap].pendingMoves--;
+        });
+        allocation.offset = newOffset;
+    }
+    /// <summary>
+    /// Premier bloc libre pouvant contenir size octets alignés entre from et limit, sans le réserver
+    /// </summary>
+    bool LveGeometryPool::findBlock(const HeapStorage& storage, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize from, VkDeviceSize limit, VkDeviceSize& offset) const {
+        for (auto it = storage.freeBlocks.begin(); it != storage.freeBlocks.end() && it->first < limit; ++it) {
+            VkDeviceSize blockEnd = it->first + it->second;
+            VkDeviceSize aligned = alignUp(std::max(it->first, from), alignment);
+            if (aligned + size > blockEnd || aligned + size > limit) continue;
+            offset = aligned;
+            return true;
+        }
+        return false;
+    }
+    /// <summary>
+    /// Réserve le premier bloc libre qui convient (voir findBlock) ; le bloc est découpé et les restes retournent dans la liste
+    /// </summary>
+    bool LveGeometryPool::takeBlock(HeapStorage& storage, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize from, VkDeviceSize limit, VkDeviceSize& offset) {
+        if (!findBlock(storage, size, alignment, from, limit, offset)) {
+            return false;
+        }
+        auto it = std::prev(storage.freeBlocks.upper_bound(offset));
+        VkDeviceSize blockStart = it->first;
+        VkDeviceSize blockEnd = it->first + it->second;
+        storage.freeBlocks.erase(it);
+        if (offset > blockStart) {
+            storage.freeBlocks[blockStart] = offset - blockStart;
+        }
+        if (offset + size < blockEnd) {
+            storage.freeBlocks[offset + size] = blockEnd - (offset + size);
+        }
+        return true;
+    }
+
+    void LveGeometryPool::releaseBlock(HeapStorage& storage, VkDeviceSize offset, VkDeviceSize size) {
+        auto it = storage.freeBlocks.emplace(offset, size).first;
+        auto next = std::next(it);
+        if (next != storage.freeBlocks.end() && it->first + it->second == next->first) {
+            it->second += next->second;
+            storage.freeBlocks.erase(next);
+        }
+        if (it != storage.freeBlocks.begin()) {
+            auto previous = std::prev(it);
+            if (previous->first + previous->second == it->first) {
+                previous->second += it->second;
+                storage.freeBlocks.erase(it);
+            }
+        }
+    }
+    /// <summary>
+    /// Remplace le tampon par un tampon au moins deux fois plus grand et y recopie le contenu existant ;
+    /// les offsets des allocations restent valides. L'ancien tampon est gardé jusqu'à la fin de la trame en cours :
+    /// les trames en vol et le tampon de commandes en cours d'enregistrement peuvent encore le référencer
+    /// </summary>
+    /// <param name="storage"></param>
+    /// <param name="minimumCapacity"></param>
+    void LveGeometryPool::grow(HeapStorage& storage, VkDeviceSize minimumCapacity) {
+        VkDeviceSize oldCapacity = storage.capacity;
+        VkDeviceSize newCapacity = std::max(oldCapacity * 2, minimumCapacity);
+
+        auto newBuffer = std::make_unique<LveBuffer>(lveDevice, newCapacity, 1, storage.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        lveDevice.copyBuffer(storage.buffer->getBuffer(), newBuffer->getBuffer(), oldCapacity);
+        std::shared_ptr<LveBuffer> oldBuffer = std::move(storage.buffer);
+        lveDevice.getDeletionQueue().defer([oldBuffer]() mutable { oldBuffer.reset(); });
+        storage.buffer = std::move(newBuffer);
+        storage.capacity = newCapacity;
+        releaseBlock(storage, oldCapacity, newCapacity - oldCapacity);
+        resetBindings();
+    }
+}
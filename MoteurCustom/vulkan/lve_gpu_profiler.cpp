@@ -0,0 +1,194 @@
+#include "lve_gpu_profiler.hpp"
+
+//std
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+    /// <summary>
+    /// Crée un pool de timestamps (2 par scope et par trame en vol) et, si le device le permet, un pool de statistiques de pipeline.
+    /// Sans timestampComputeAndGraphics, ou si la file graphique n'a aucun bit de timestamp valide, le profileur reste inactif et toutes ses fonctions ne font rien
+    /// </summary>
+    /// <param name="device"></param>
+    /// <param name="framesInFlight"></param>
+    LveGpuProfiler::LveGpuProfiler(LveDevice& device, int framesInFlight) : lveDevice{ device } {
+        frames.resize(framesInFlight);
+        for (auto& frame : frames) {
+            frame.scopeNames.reserve(MAX_SCOPES);
+        }
+        timestamps.resize(MAX_SCOPES * 2);
+        results.scopes.reserve(MAX_SCOPES);
+        if (!lveDevice.properties.limits.timestampComputeAndGraphics) {
+            return;
+        }
+        // les timestamps sont écrits sur la file graphique : seuls ses timestampValidBits bits de poids faible sont significatifs
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(lveDevice.getPhysicalDevice(), &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(lveDevice.getPhysicalDevice(), &familyCount, families.data());
+        uint32_t validBits = families[lveDevice.findPhysicalQueueFamilies().graphicsFamily].timestampValidBits;
+        if (validBits == 0) {
+            return;
+        }
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = static_cast<uint32_t>(framesInFlight) * MAX_SCOPES * 2;
+        if (vkCreateQueryPool(lveDevice.getDevice(), &poolInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+
+        if (lveDevice.supportsPipelineStatistics()) {
+            VkQueryPoolCreateInfo statisticsInfo{};
+            statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            statisticsInfo.queryCount = static_cast<uint32_t>(framesInFlight);
+            statisticsInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+            if (vkCreateQueryPool(lveDevice.getDevice(), &statisticsInfo, nullptr, &statisticsPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create pipeline statistics query pool!");
+            }
+        }
+    }
+
+    LveGpuProfiler::~LveGpuProfiler() {
+        vkDestroyQueryPool(lveDevice.getDevice(), statisticsPool, nullptr);
+        vkDestroyQueryPool(lveDevice.getDevice(), timestampPool, nullptr);
+    }
+    /// <summary>
+    /// À appeler juste après LveRenderer::beginFrame, hors render pass : la trame précédente de même indice est terminée,
+    /// ses résultats sont lus sans attente, puis ses requêtes sont réinitialisées et le scope de la trame entière commence
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="frameIndex"></param>
+    void LveGpuProfiler::beginFrame(VkCommandBuffer commandBuffer, int frameIndex) {
+        if (!isEnabled()) {
+            return;
+        }
+        readResults(frameIndex);
+
+        currentFrame = frameIndex;
+        FrameQueries& frame = frames[frameIndex];
+        frame.scopeNames.clear();
+        frame.frameNumber = ++frameCounter;
+        frame.written = false;
+
+        vkCmdResetQueryPool(commandBuffer, timestampPool, static_cast<uint32_t>(frameIndex) * MAX_SCOPES * 2, MAX_SCOPES * 2);
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkCmdResetQueryPool(commandBuffer, statisticsPool, static_cast<uint32_t>(frameIndex), 1);
+            vkCmdBeginQuery(commandBuffer, statisticsPool, static_cast<uint32_t>(frameIndex), 0);
+        }
+        beginScope(commandBuffer, "Frame");
+    }
+    /// <summary>
+    /// Termine le scope de la trame entière et la requête de statistiques ; à appeler hors render pass, avant LveRenderer::endFrame
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    void LveGpuProfiler::endFrame(VkCommandBuffer commandBuffer) {
+        if (!isEnabled()) {
+            return;
+        }
+        endScope(commandBuffer, 0);
+        if (statisticsPool != VK_NULL_HANDLE) {
+            vkCmdEndQuery(commandBuffer, statisticsPool, static_cast<uint32_t>(currentFrame));
+        }
+        frames[currentFrame].written = true;
+    }
+    /// <summary>
+    /// Écrit le timestamp de début d'un scope et retourne son indice, à passer à endScope.
+    /// Au-delà de MAX_SCOPES, le scope est ignoré (retourne MAX_SCOPES)
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="name">chaîne littérale</param>
+    /// <returns></returns>
+    uint32_t LveGpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+        FrameQueries& frame = frames[currentFrame];
+        if (!isEnabled() || frame.scopeNames.size() >= MAX_SCOPES) {
+            return MAX_SCOPES;
+        }
+        uint32_t scope = static_cast<uint32_t>(frame.scopeNames.size());
+        frame.scopeNames.push_back(name);
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, (static_cast<uint32_t>(currentFrame) * MAX_SCOPES + scope) * 2);
+        return scope;
+    }
+    /// <summary>
+    /// Écrit le timestamp de fin du scope
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="scope"></param>
+    void LveGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+        if (!isEnabled() || scope >= MAX_SCOPES) {
+            return;
+        }
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, (static_cast<uint32_t>(currentFrame) * MAX_SCOPES + scope) * 2 + 1);
+    }
+    /// <summary>
+    /// Convertit en millisecondes (timestampPeriod) les timestamps de la trame frameIndex et met à jour l'historique.
+    /// Si le pilote n'a pas encore les résultats (VK_NOT_READY), la trame est simplement perdue : on n'attend jamais
+    /// </summary>
+    /// <param name="frameIndex"></param>
+    void LveGpuProfiler::readResults(int frameIndex) {
+        FrameQueries& frame = frames[frameIndex];
+        if (!frame.written || frame.scopeNames.empty()) {
+            return;
+        }
+        uint32_t queryCount = static_cast<uint32_t>(frame.scopeNames.size()) * 2;
+        if (vkGetQueryPoolResults(lveDevice.getDevice(), timestampPool, static_cast<uint32_t>(frameIndex) * MAX_SCOPES * 2, queryCount,
+            queryCount * sizeof(uint64_t), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+
+        double period = lveDevice.properties.limits.timestampPeriod * 1e-6;
+        results.frameNumber = frame.frameNumber;
+        results.scopes.clear();
+        for (size_t i = 0; i < frame.scopeNames.size(); i++) {
+            results.scopes.push_back({ frame.scopeNames[i], static_cast<double>((timestamps[i * 2 + 1] - timestamps[i * 2]) & timestampMask) * period });
+        }
+
+        results.hasStatistics = false;
+        if (statisticsPool != VK_NULL_HANDLE) {
+            uint64_t statistics[2] = {};
+            results.hasStatistics = vkGetQueryPoolResults(lveDevice.getDevice(), statisticsPool, static_cast<uint32_t>(frameIndex), 1,
+                sizeof(statistics), statistics, sizeof(statistics), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS;
+            // les compteurs sont rangés dans l'ordre des bits : vertex puis fragment
+            results.vertexInvocations = statistics[0];
+            results.fragmentInvocations = statistics[1];
+        }
+
+        // un historique par position de scope ; il repart de zéro si le scope à cette position change de nom
+        for (size_t i = 0; i < results.scopes.size(); i++) {
+            if (i >= history.size()) {
+                history.push_back({ results.scopes[i].name, std::vector<float>(HISTORY_SIZE, 0.f) });
+            } else if (std::strcmp(history[i].name, results.scopes[i].name) != 0) {
+                history[i] = { results.scopes[i].name, std::vector<float>(HISTORY_SIZE, 0.f) };
+            }
+            history[i].milliseconds[historyOffset] = static_cast<float>(results.scopes[i].milliseconds);
+        }
+        historyOffset = (historyOffset + 1) % HISTORY_SIZE;
+        frame.written = false;
+    }
+    /// <summary>
+    /// Lit la plus ancienne trame enregistrée mais pas encore relue. À appeler en boucle une fois le GPU au repos,
+    /// pour ne pas perdre les trames encore en vol à l'arrêt ; getResults() garde son frameNumber si la lecture a échoué
+    /// </summary>
+    /// <returns>false quand il n'y a plus rien à lire</returns>
+    bool LveGpuProfiler::readPendingResults() {
+        if (!isEnabled()) {
+            return false;
+        }
+        int oldest = -1;
+        for (int i = 0; i < static_cast<int>(frames.size()); i++) {
+            if (frames[i].written && !frames[i].scopeNames.empty() && (oldest < 0 || frames[i].frameNumber < frames[oldest].frameNumber)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            return false;
+        }
+        readResults(oldest);
+        frames[oldest].written = false;  // même si la lecture a échoué, pour ne pas la retenter sans fin
+        return true;
+    }
+}
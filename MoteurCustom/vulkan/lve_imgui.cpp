@@ -1,4 +1,5 @@
 #include "lve_imgui.hpp"
+#include "lve_profiler.hpp"
 
 // glm
 #include <glm/glm.hpp>
@@ -12,6 +13,9 @@
 #include "imgui_internal.h"
 
 // std
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
 #include <stdexcept>
 #include <iostream>
 
@@ -21,7 +25,7 @@ namespace lve {
     glm::vec3 rotation(0.0f, 0.0f, 0.0f);
     glm::vec3 scale(0.5f, 0.5f, 0.5f);
     /// <summary>
-    /// Il prend une rfrence  un objet LveWindow, LveDevice, et LveRenderer en paramtre.
+    /// Il prend une référence à un objet LveWindow, LveDevice, et LveRenderer en paramètre.
     ///Initialise un pool de descripteurs pour ImGui.
     /// Appelle la fonction initImGui() pour initialiser ImGui
     /// </summary>
@@ -58,7 +62,7 @@ namespace lve {
         initImGui();
     }
     /// <summary>
-    /// Appelle les fonctions de fermeture de ImGui et libre les ressources associes, y compris le pool de descripteurs
+    /// Appelle les fonctions de fermeture de ImGui et libère les ressources associées, y compris le pool de descripteurs
     /// </summary>
     LveImgui::~LveImgui() {
         ImGui_ImplVulkan_Shutdown();
@@ -67,9 +71,9 @@ namespace lve {
         vkDestroyDescriptorPool(lveDevice.getDevice(), imguiPool, nullptr);
     }
     /// <summary>
-    /// Cette fonction est appele pour rendre l'interface ImGui.
+    /// Cette fonction est appelée pour rendre l'interface ImGui.
     ///Initialise un nouveau frame ImGui et rend le contenu.
-    /// Appelle la fonction initInspector() pour initialiser une fentre d'inspection
+    /// Appelle la fonction initInspector() pour initialiser une fenêtre d'inspection
     /// </summary>
     /// <param name="commandBuffer"></param>
     void LveImgui::renderImGui(VkCommandBuffer commandBuffer) {
@@ -109,8 +113,15 @@ namespace lve {
         return position[xyz];
     }
     /// <summary>
+    /// Vrai tant qu'un widget est actif (saisie, glissement) : en mode veille, l'interface doit continuer d'être rendue
+    /// </summary>
+    /// <returns></returns>
+    bool LveImgui::isInteracting() const {
+        return ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput;
+    }
+    /// <summary>
     /// Initialise le contexte ImGui, configure le style, et initialise les backends pour GLFW et Vulkan.
-    ///Cre la texture de polices ImGui
+    ///Crée la texture de polices ImGui
     /// </summary>
     void LveImgui::initImGui() {
         // Setup Dear ImGui context
@@ -152,10 +163,10 @@ namespace lve {
         ImGui_ImplVulkan_CreateFontsTexture();
     }
     /// <summary>
-    /// Initialise une fentre d'inspection ImGui.
-    /// Affiche la dmo ImGui si l'indicateur show_demo_window est activ.
-    /// Affiche un bouton "Create Cube" qui active la cration d'un cube (cubecre est dfini  true).
-    /// Si cubecre est true, affiche les contrles ImGui pour dfinir les proprits du cube(myCube).
+    /// Initialise une fenêtre d'inspection ImGui.
+    /// Affiche la démo ImGui si l'indicateur show_demo_window est activé.
+    /// Affiche un bouton "Create Cube" qui active la création d'un cube (cubecre est défini à true).
+    /// Si cubecre est true, affiche les contrôles ImGui pour définir les propriétés du cube(myCube).
     /// Affiche un texte avec le temps moyen par frame et les FPS de l'application
 
     /// </summary>
@@ -169,7 +180,7 @@ namespace lve {
             glm::vec3 color;
         };
 
-        GameObject myGameObject;                                // Crez une instance de l'objet de jeuGameObject myCube;
+        GameObject myGameObject;                                // Créez une instance de l'objet de jeuGameObject myCube;
         GameObject myCube;
 
 
@@ -180,7 +191,7 @@ namespace lve {
         ImGui::ColorEdit3("clear color", (float*)&clear_color); // Edit 3 floats representing a color
 
         ImGui::Button("Create Cube");
-        // Initialiser ou rinitialiser les paramtres du cube
+        // Initialiser ou réinitialiser les paramètres du cube
         myCube = GameObject();
         float maxScaleValue = 10.0f;
 
@@ -200,8 +211,130 @@ namespace lve {
 
         //compteur fps
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+#ifdef LVE_TRACK_ALLOCATIONS
+        LveAllocTracker::Counters frameAllocations = LveAllocTracker::lastFrame();
+        ImGui::Text("Heap allocations %llu/frame (%llu bytes)", static_cast<unsigned long long>(frameAllocations.allocations), static_cast<unsigned long long>(frameAllocations.bytes));
+#endif
+        drawInputLatency();
+        drawGpuTimings();
+        drawCpuFlameView();
 
 
         ImGui::End();
     }
-}
\ No newline at end of file
+    /// <summary>
+    /// Affiche la latence entre l'arrivée d'une touche et la fin de la première trame qui l'a prise en compte
+    /// </summary>
+    void LveImgui::drawInputLatency() {
+        if (!latencyCounter || latencyCounter->getSampleCount() == 0) {
+            return;
+        }
+        char overlay[48];
+        snprintf(overlay, sizeof(overlay), "%.2f ms (average %.2f ms)", latencyCounter->getLastMilliseconds(), latencyCounter->getAverageMilliseconds());
+        const auto& history = latencyCounter->getHistory();
+        ImGui::PlotLines("Input latency", history.data(), static_cast<int>(history.size()), static_cast<int>(latencyCounter->getHistoryOffset()),
+            overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+    }
+    /// <summary>
+    /// Affiche les temps GPU du profileur : une courbe glissante par scope (la dernière valeur en surimpression)
+    /// et les invocations de shaders si les statistiques de pipeline sont disponibles
+    /// </summary>
+    void LveImgui::drawGpuTimings() {
+        if (!gpuProfiler || !gpuProfiler->isEnabled()) {
+            return;
+        }
+        if (!ImGui::CollapsingHeader("GPU", ImGuiTreeNodeFlags_DefaultOpen)) {
+            return;
+        }
+        const auto& results = gpuProfiler->getResults();
+        const auto& history = gpuProfiler->getHistory();
+        for (size_t i = 0; i < results.scopes.size() && i < history.size(); i++) {
+            char overlay[32];
+            snprintf(overlay, sizeof(overlay), "%.3f ms", results.scopes[i].milliseconds);
+            ImGui::PlotLines(results.scopes[i].name, history[i].milliseconds.data(), static_cast<int>(history[i].milliseconds.size()),
+                static_cast<int>(gpuProfiler->getHistoryOffset()), overlay, 0.0f, FLT_MAX, ImVec2(0, 40));
+        }
+        if (results.hasStatistics) {
+            ImGui::Text("Vertex invocations %llu", static_cast<unsigned long long>(results.vertexInvocations));
+            ImGui::Text("Fragment invocations %llu", static_cast<unsigned long long>(results.fragmentInvocations));
+        }
+    }
+    /// <summary>
+    /// Copie les zones de la dernière trame complète. Seules les zones qui recoupent la trame sont gardées :
+    /// la copie complète des tampons n'est faite qu'au moment de la capture
+    /// </summary>
+    void LveImgui::captureCpuFrame() {
+        framesSinceCpuCapture = 0;
+        int64_t frameStart = 0;
+        int64_t frameEnd = 0;
+        if (!LveProfiler::get().lastFrame(frameStart, frameEnd) || frameEnd <= frameStart) {
+            return;
+        }
+        cpuCaptureStart = frameStart;
+        cpuCaptureEnd = frameEnd;
+        cpuCapture = LveProfiler::get().collect();
+        for (auto& thread : cpuCapture) {
+            std::erase_if(thread.zones, [&](const LveProfiler::Zone& zone) { return zone.end < frameStart || zone.start > frameEnd; });
+        }
+    }
+    /// <summary>
+    /// Vue en flammes des zones CPU d'une trame capturée : une ligne par profondeur, une couleur par thread,
+    /// le nom et la durée en infobulle. La capture est refaite à la demande, ou toutes les CPU_CAPTURE_INTERVAL trames
+    /// en mode automatique. Vide si le profileur n'est pas compilé (LVE_ENABLE_PROFILER)
+    /// </summary>
+    void LveImgui::drawCpuFlameView() {
+#ifdef LVE_ENABLE_PROFILER
+        framesSinceCpuCapture++;
+        if (!ImGui::CollapsingHeader("CPU")) {
+            return;
+        }
+        bool capture = ImGui::Button("Capture");
+        ImGui::SameLine();
+        ImGui::Checkbox("Auto", &autoCpuCapture);
+        if (capture || cpuCaptureEnd <= cpuCaptureStart || (autoCpuCapture && framesSinceCpuCapture >= CPU_CAPTURE_INTERVAL)) {
+            captureCpuFrame();
+        }
+        if (cpuCaptureEnd <= cpuCaptureStart) {
+            return;
+        }
+        const int64_t frameStart = cpuCaptureStart;
+        const int64_t frameEnd = cpuCaptureEnd;
+        ImGui::Text("Frame %.3f ms", static_cast<double>(frameEnd - frameStart) * 1e-6);
+
+        const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+        const float width = ImGui::GetContentRegionAvail().x;
+        const float scale = width / static_cast<float>(frameEnd - frameStart);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float height = 0.0f;
+        for (const auto& thread : cpuCapture) {
+            uint32_t maxDepth = 0;
+            ImU32 color = ImColor::HSV(0.08f + 0.17f * static_cast<float>(thread.threadId % 5), 0.6f, 0.8f);
+            for (const auto& zone : thread.zones) {
+                if (zone.end < frameStart || zone.start > frameEnd) {
+                    continue;
+                }
+                maxDepth = std::max(maxDepth, zone.depth + 1);
+                float x0 = origin.x + static_cast<float>(std::max(zone.start, frameStart) - frameStart) * scale;
+                float x1 = origin.x + static_cast<float>(std::min(zone.end, frameEnd) - frameStart) * scale;
+                ImVec2 min{ x0, origin.y + height + zone.depth * rowHeight };
+                ImVec2 max{ std::max(x1, x0 + 1.0f), min.y + rowHeight - 1.0f };
+                drawList->AddRectFilled(min, max, color);
+                if (max.x - min.x > ImGui::CalcTextSize(zone.name).x) {
+                    drawList->AddText(min, IM_COL32_BLACK, zone.name);
+                }
+                if (ImGui::IsMouseHoveringRect(min, max)) {
+#ifdef LVE_TRACK_ALLOCATIONS
+                    ImGui::SetTooltip("%s %.3f ms\n%llu allocations (%llu bytes)", zone.name, static_cast<double>(zone.end - zone.start) * 1e-6,
+                        static_cast<unsigned long long>(zone.allocations), static_cast<unsigned long long>(zone.allocatedBytes));
+#else
+                    ImGui::SetTooltip("%s %.3f ms", zone.name, static_cast<double>(zone.end - zone.start) * 1e-6);
+#endif
+                }
+            }
+            height += maxDepth * rowHeight;
+        }
+        ImGui::Dummy(ImVec2(width, height));
+#endif
+    }
+}
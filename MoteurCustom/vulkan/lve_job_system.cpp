@@ -0,0 +1,261 @@
+#include "lve_job_system.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+    // indice du thread courant dans le système qui l'a créé (0 pour le thread principal), -1 pour les autres threads
+    static thread_local const LveJobSystem* currentSystem = nullptr;
+    static thread_local int32_t currentIndex = -1;
+
+    /// <summary>
+    /// Démarre workerCount threads de travail (un par coeur moins le thread principal si 0).
+    /// Le thread qui crée le système devient le thread principal : lui seul exécute les tâches scheduleOnMainThread
+    /// </summary>
+    /// <param name="workerCount"></param>
+    LveJobSystem::LveJobSystem(uint32_t workerCount) : mainThreadId{ std::this_thread::get_id() } {
+        if (workerCount == 0) {
+            workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+        for (uint32_t i = 0; i <= workerCount; i++) {
+            queues.push_back(std::make_unique<ThreadQueue>());
+        }
+        mainThreadJobs.reserve(64);
+        mainThreadRunning.reserve(64);
+
+        currentSystem = this;
+        currentIndex = 0;
+        for (uint32_t i = 1; i <= workerCount; i++) {
+            workers.emplace_back(&LveJobSystem::workerLoop, this, i);
+        }
+    }
+    /// <summary>
+    /// Arrête les threads de travail ; les tâches encore en file sont abandonnées, il faut avoir attendu les compteurs avant
+    /// </summary>
+    LveJobSystem::~LveJobSystem() {
+        {
+            std::lock_guard<std::mutex> lock{ sleepMutex };
+            stopping = true;
+        }
+        wakeCondition.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (currentSystem == this) {
+            currentSystem = nullptr;
+            currentIndex = -1;
+        }
+    }
+
+    int32_t LveJobSystem::currentThreadIndex() const {
+        return currentSystem == this ? currentIndex : -1;
+    }
+    /// <summary>
+    /// Ajoute une tâche dans la file du thread appelant. Depuis un thread extérieur au système, ou si la file est pleine,
+    /// la tâche est exécutée tout de suite
+    /// </summary>
+    /// <param name="function"></param>
+    /// <param name="counter">incrémenté ici, décrémenté quand la tâche est terminée</param>
+    void LveJobSystem::schedule(JobFunction function, LveJobCounter& counter) {
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+        int32_t index = currentThreadIndex();
+        Job* job = index >= 0 ? allocateJob(*queues[index], std::move(function), counter) : nullptr;
+        if (job == nullptr) {
+            function();
+            counter.pending.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        queuedJobs.fetch_add(1, std::memory_order_release);
+        if (!queues[index]->deque.push(job)) {
+            execute(job);
+            return;
+        }
+        wakeCondition.notify_one();
+    }
+    /// <summary>
+    /// Ajoute une tâche que seul le thread principal exécute (appels GLFW, ImGui), dans wait() ou runMainThreadJobs()
+    /// </summary>
+    /// <param name="function"></param>
+    /// <param name="counter"></param>
+    void LveJobSystem::scheduleOnMainThread(JobFunction function, LveJobCounter& counter) {
+        counter.pending.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock{ mainThreadMutex };
+        mainThreadJobs.push_back({ std::move(function), &counter });
+    }
+    /// <summary>
+    /// Exécute les tâches du thread principal en attente. Ne fait rien depuis un autre thread
+    /// </summary>
+    void LveJobSystem::runMainThreadJobs() {
+        if (!isMainThread()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock{ mainThreadMutex };
+            if (mainThreadJobs.empty()) {
+                return;
+            }
+            std::swap(mainThreadJobs, mainThreadRunning);
+        }
+        for (auto& job : mainThreadRunning) {
+            job.function();
+            job.counter->pending.fetch_sub(1, std::memory_order_release);
+        }
+        mainThreadRunning.clear();
+    }
+    /// <summary>
+    /// Attend que le compteur revienne à zéro en exécutant d'autres tâches (les siennes, celles du thread principal, puis
+    /// celles volées aux autres threads) plutôt qu'en bloquant
+    /// </summary>
+    /// <param name="counter"></param>
+    void LveJobSystem::wait(LveJobCounter& counter) {
+        int32_t index = currentThreadIndex();
+        while (!counter.isDone()) {
+            runMainThreadJobs();
+            Job* job = index >= 0 ? findJob(static_cast<uint32_t>(index)) : nullptr;
+            if (job) {
+                execute(job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    /// <summary>
+    /// Découpe [0, count) en tranches de grainSize éléments, une tâche par tranche, et attend la fin.
+    /// La dernière tranche est exécutée par le thread appelant
+    /// </summary>
+    /// <param name="count"></param>
+    /// <param name="grainSize"></param>
+    /// <param name="function">appelée avec (début, fin) de chaque tranche</param>
+    void LveJobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& function) {
+        grainSize = std::max(grainSize, 1u);
+        LveJobCounter counter{};
+        uint32_t begin = 0;
+        for (; begin + grainSize < count; begin += grainSize) {
+            schedule([&function, begin, grainSize]() { function(begin, begin + grainSize); }, counter);
+        }
+        if (begin < count) {
+            function(begin, count);
+        }
+        wait(counter);
+    }
+    /// <summary>
+    /// Prend la prochaine case de l'anneau de tâches du thread. Si elle est encore occupée (tâche volée pas encore terminée),
+    /// retourne nullptr : l'appelant exécute la tâche lui-même
+    /// </summary>
+    /// <param name="queue"></param>
+    /// <param name="function"></param>
+    /// <param name="counter"></param>
+    /// <returns></returns>
+    LveJobSystem::Job* LveJobSystem::allocateJob(ThreadQueue& queue, JobFunction&& function, LveJobCounter& counter) {
+        Job& job = queue.jobs[queue.nextJob];
+        if (!job.free.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        queue.nextJob = (queue.nextJob + 1) % (DEQUE_CAPACITY * 2);
+        job.free.store(false, std::memory_order_relaxed);
+        job.function = std::move(function);
+        job.counter = &counter;
+        return &job;
+    }
+    /// <summary>
+    /// Tâche suivante pour le thread threadIndex : la sienne la plus récente, sinon la plus ancienne d'un autre thread
+    /// </summary>
+    /// <param name="threadIndex"></param>
+    /// <returns></returns>
+    LveJobSystem::Job* LveJobSystem::findJob(uint32_t threadIndex) {
+        if (Job* job = queues[threadIndex]->deque.pop()) {
+            return job;
+        }
+        uint32_t threadCount = static_cast<uint32_t>(queues.size());
+        for (uint32_t i = 1; i < threadCount; i++) {
+            if (Job* job = queues[(threadIndex + i) % threadCount]->deque.steal()) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void LveJobSystem::execute(Job* job) {
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        job->function();
+        job->function = nullptr;
+        LveJobCounter* counter = job->counter;
+        job->free.store(true, std::memory_order_release);
+        counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+    /// <summary>
+    /// Boucle d'un thread de travail : exécute ou vole des tâches, et dort quand aucune n'est en file.
+    /// L'attente a un délai pour ne pas dépendre d'un réveil manqué entre le test et le sommeil
+    /// </summary>
+    /// <param name="threadIndex"></param>
+    void LveJobSystem::workerLoop(uint32_t threadIndex) {
+        currentSystem = this;
+        currentIndex = static_cast<int32_t>(threadIndex);
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (Job* job = findJob(threadIndex)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{ sleepMutex };
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                return stopping.load(std::memory_order_acquire) || queuedJobs.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+    /// <summary>
+    /// Ajoute une tâche en bas de la file ; seul le thread propriétaire appelle push et pop
+    /// </summary>
+    /// <param name="job"></param>
+    /// <returns>false si la file est pleine</returns>
+    bool LveJobSystem::WorkStealingDeque::push(Job* job) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(DEQUE_CAPACITY)) {
+            return false;
+        }
+        buffer[b & (DEQUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+    /// <summary>
+    /// Retire la tâche la plus récente. Quand il n'en reste qu'une, le propriétaire et un voleur se la disputent sur top
+    /// </summary>
+    /// <returns></returns>
+    LveJobSystem::Job* LveJobSystem::WorkStealingDeque::pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job* job = buffer[b & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+    /// <summary>
+    /// Vole la tâche la plus ancienne ; appelé par les autres threads
+    /// </summary>
+    /// <returns>nullptr si la file est vide ou si un autre thread l'a prise avant</returns>
+    LveJobSystem::Job* LveJobSystem::WorkStealingDeque::steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Job* job = buffer[t & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+}
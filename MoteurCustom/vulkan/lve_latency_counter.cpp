@@ -0,0 +1,41 @@
+#include "lve_latency_counter.hpp"
+
+//std
+#include <algorithm>
+
+namespace lve {
+    LveLatencyCounter::LveLatencyCounter(LveDevice& device) : lveDevice{ device } {}
+    /// <summary>
+    /// Associe l'entrée à la dernière soumission du device : la mesure sera prise quand le timeline l'aura atteinte.
+    /// Si trop de mesures sont en attente (GPU bloqué), la nouvelle est ignorée
+    /// </summary>
+    /// <param name="inputArrival"></param>
+    void LveLatencyCounter::frameSubmitted(Clock::time_point inputArrival) {
+        if (pendingCount == MAX_PENDING) {
+            return;
+        }
+        pending[pendingCount++] = { lveDevice.getLastSubmittedTimelineValue(), inputArrival };
+    }
+    /// <summary>
+    /// Relève les trames terminées depuis le dernier appel, sans attendre : les valeurs du timeline sont croissantes,
+    /// les mesures en attente se terminent donc dans l'ordre
+    /// </summary>
+    void LveLatencyCounter::update() {
+        if (pendingCount == 0) {
+            return;
+        }
+        uint64_t completed = lveDevice.getCompletedTimelineValue();
+        auto now = Clock::now();
+        uint32_t done = 0;
+        while (done < pendingCount && pending[done].timelineValue <= completed) {
+            lastMilliseconds = std::chrono::duration<double, std::milli>(now - pending[done].inputArrival).count();
+            totalMilliseconds += lastMilliseconds;
+            sampleCount++;
+            history[historyOffset] = static_cast<float>(lastMilliseconds);
+            historyOffset = (historyOffset + 1) % HISTORY_SIZE;
+            done++;
+        }
+        std::copy(pending.begin() + done, pending.begin() + pendingCount, pending.begin());
+        pendingCount -= done;
+    }
+}
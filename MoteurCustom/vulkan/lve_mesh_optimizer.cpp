@@ -0,0 +1,636 @@
+#include "lve_mesh_optimizer.hpp"
+
+//libs
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+//std
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace lve {
+    /// <summary>
+    /// Enchaîne les trois passes d'optimisation sur le Builder (cache de vertex, overdraw, fetch)
+    /// et retourne les statistiques avant / après (ACMR, ATVR et taille en octets sur le GPU).
+    /// Chaque niveau de détail est optimisé séparément dans sa plage du tampon d'indices ; les statistiques
+    /// ACMR / ATVR portent sur le niveau 0
+    /// </summary>
+    /// <param name="builder"></param>
+    /// <returns></returns>
+    MeshOptimizationStats LveMeshOptimizer::optimize(LveModel::Builder& builder) {
+        if (builder.lods.empty()) {
+            builder.lods.push_back({ 0, static_cast<uint32_t>(builder.indices.size()), 0.f });
+        }
+        auto lodIndices = [&](const LveModel::Lod& lod) {
+            return std::vector<uint32_t>(builder.indices.begin() + lod.firstIndex, builder.indices.begin() + lod.firstIndex + lod.indexCount);
+        };
+
+        MeshOptimizationStats stats{};
+        std::vector<uint32_t> lod0 = lodIndices(builder.lods[0]);
+        stats.acmrBefore = computeACMR(lod0, builder.vertices.size());
+        stats.atvrBefore = computeATVR(lod0, builder.vertices.size());
+        stats.bytesBefore = computeByteSize(builder, false);
+
+        if (builder.indices.size() >= 3) {
+            for (const auto& lod : builder.lods) {
+                std::vector<uint32_t> range = lodIndices(lod);
+                optimizeVertexCache(range, builder.vertices.size());
+                optimizeOverdraw(range, builder.vertices);
+                std::copy(range.begin(), range.end(), builder.indices.begin() + lod.firstIndex);
+            }
+            optimizeVertexFetch(builder.vertices, builder.indices);
+        }
+
+        lod0 = lodIndices(builder.lods[0]);
+        stats.acmrAfter = computeACMR(lod0, builder.vertices.size());
+        stats.atvrAfter = computeATVR(lod0, builder.vertices.size());
+        stats.bytesAfter = computeByteSize(builder, true);
+        return stats;
+    }
+    /// <summary>
+    /// Découpe le niveau de détail 0 en clusters d'au plus MAX_CLUSTER_VERTICES vertices distincts et MAX_CLUSTER_TRIANGLES triangles.
+    /// Les triangles sont pris dans l'ordre du tampon d'indices : à appeler après optimize(), l'ordre du cache de vertex
+    /// regroupe déjà des triangles voisins. Les meshs qui tiennent dans un seul cluster n'en reçoivent aucun,
+    /// le culling de l'objet entier suffit
+    /// </summary>
+    /// <param name="builder"></param>
+    void LveMeshOptimizer::buildClusters(LveModel::Builder& builder) {
+        builder.clusters.clear();
+        size_t first = builder.lods.empty() ? 0 : builder.lods[0].firstIndex;
+        size_t count = builder.lods.empty() ? builder.indices.size() : builder.lods[0].indexCount;
+        if (count / 3 <= MAX_CLUSTER_TRIANGLES) {
+            return;
+        }
+
+        std::vector<uint32_t> clusterVertices{};
+        clusterVertices.reserve(MAX_CLUSTER_VERTICES);
+        auto contains = [&](uint32_t index) {
+            return std::find(clusterVertices.begin(), clusterVertices.end(), index) != clusterVertices.end();
+        };
+
+        size_t clusterStart = first;
+        for (size_t i = first; i + 2 < first + count; i += 3) {
+            size_t newVertices = 0;
+            for (size_t k = 0; k < 3; k++) {
+                if (!contains(builder.indices[i + k])) newVertices++;
+            }
+            if (clusterVertices.size() + newVertices > MAX_CLUSTER_VERTICES || (i - clusterStart) / 3 >= MAX_CLUSTER_TRIANGLES) {
+                builder.clusters.push_back(computeClusterBounds(builder.vertices, builder.indices, clusterStart, i - clusterStart));
+                clusterStart = i;
+                clusterVertices.clear();
+            }
+            for (size_t k = 0; k < 3; k++) {
+                if (!contains(builder.indices[i + k])) clusterVertices.push_back(builder.indices[i + k]);
+            }
+        }
+        if (clusterStart < first + count) {
+            builder.clusters.push_back(computeClusterBounds(builder.vertices, builder.indices, clusterStart, first + count - clusterStart));
+        }
+    }
+    /// <summary>
+    /// Sphère englobante et cône de normales d'un cluster. L'axe du cône est la moyenne des normales des faces ;
+    /// chaque normale de face est orientée du côté des normales de vertex, car le pipeline ne fait pas de back-face culling
+    /// et l'ordre des sommets des OBJ n'est pas fiable. cutoff = sin de l'ouverture du cône, 1 si le cône dépasse une demi-sphère
+    /// (le cluster n'est alors jamais rejeté comme tourné vers l'arrière)
+    /// </summary>
+    /// <param name="vertices"></param>
+    /// <param name="indices"></param>
+    /// <param name="first"></param>
+    /// <param name="count"></param>
+    /// <returns></returns>
+    LveModel::Cluster LveMeshOptimizer::computeClusterBounds(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, size_t first, size_t count) {
+        LveModel::Cluster cluster{};
+        cluster.firstIndex = static_cast<uint32_t>(first);
+        cluster.indexCount = static_cast<uint32_t>(count);
+
+        glm::vec3 boundsMin{ vertices[indices[first]].position };
+        glm::vec3 boundsMax{ boundsMin };
+        for (size_t i = first; i < first + count; i++) {
+            boundsMin = glm::min(boundsMin, vertices[indices[i]].position);
+            boundsMax = glm::max(boundsMax, vertices[indices[i]].position);
+        }
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        float radius = 0.f;
+        for (size_t i = first; i < first + count; i++) {
+            radius = std::max(radius, glm::length(vertices[indices[i]].position - center));
+        }
+        cluster.boundingSphere = glm::vec4{ center, radius };
+
+        std::vector<glm::vec3> normals{};
+        normals.reserve(count / 3);
+        glm::vec3 axis{ 0.f };
+        for (size_t i = first; i + 2 < first + count; i += 3) {
+            const LveModel::Vertex& a = vertices[indices[i]];
+            const LveModel::Vertex& b = vertices[indices[i + 1]];
+            const LveModel::Vertex& c = vertices[indices[i + 2]];
+            glm::vec3 normal = glm::cross(b.position - a.position, c.position - a.position);
+            float length = glm::length(normal);
+            if (length == 0.f) continue;
+            normal /= length;
+            if (glm::dot(normal, a.normal + b.normal + c.normal) < 0.f) {
+                normal = -normal;
+            }
+            normals.push_back(normal);
+            axis += normal;
+        }
+
+        cluster.cone = glm::vec4{ 0.f, 0.f, 0.f, 1.f };
+        float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength == 0.f) {
+            return cluster;
+        }
+        axis /= axisLength;
+        float minDot = 1.f;
+        for (const auto& normal : normals) {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+        float cutoff = minDot <= 0.f ? 1.f : std::sqrt(1.f - minDot * minDot);
+        cluster.cone = glm::vec4{ axis, cutoff };
+        return cluster;
+    }
+    /// <summary>
+    /// Génère jusqu'à lodCount niveaux de détail par simplification successive (un demi du nombre de triangles à chaque niveau).
+    /// Tous les niveaux partagent les vertices du Builder et sont ajoutés à la suite dans builder.indices.
+    /// La génération s'arrête quand un niveau ne retire plus assez de triangles, par exemple si le mesh est fait de bords verrouillés
+    /// </summary>
+    /// <param name="builder"></param>
+    /// <param name="lodCount"></param>
+    void LveMeshOptimizer::generateLods(LveModel::Builder& builder, uint32_t lodCount) {
+        builder.lods.clear();
+        builder.lods.push_back({ 0, static_cast<uint32_t>(builder.indices.size()), 0.f });
+        if (builder.indices.size() < 3) {
+            return;
+        }
+
+        const size_t sourceIndexCount = builder.indices.size();
+        std::vector<uint32_t> previous = builder.indices;
+        float accumulatedError = 0.f;
+        for (uint32_t level = 1; level < lodCount; level++) {
+            size_t target = static_cast<size_t>(static_cast<double>(sourceIndexCount) / static_cast<double>(1u << level)) / 3 * 3;
+            float error = 0.f;
+            std::vector<uint32_t> lod = simplify(builder.vertices, previous, target, &error);
+            if (lod.empty() || lod.size() > previous.size() * 9 / 10) {
+                break;
+            }
+
+            accumulatedError += error;
+            builder.lods.push_back({ static_cast<uint32_t>(builder.indices.size()), static_cast<uint32_t>(lod.size()), accumulatedError });
+            builder.indices.insert(builder.indices.end(), lod.begin(), lod.end());
+            previous.swap(lod);
+        }
+    }
+    /// <summary>
+    /// Simplification par contraction d'arêtes guidée par les quadriques d'erreur (Garland et Heckbert).
+    /// Un vertex n'est jamais déplacé : il est fusionné sur un voisin existant, ce qui permet de garder le tampon de vertex partagé.
+    /// Les bords ouverts et les coutures (positions dupliquées avec des attributs différents) sont verrouillés.
+    /// Chaque passe applique un ensemble indépendant de contractions, les moins coûteuses d'abord, en rejetant celles qui retournent un triangle
+    /// </summary>
+    /// <param name="vertices"></param>
+    /// <param name="indices"></param>
+    /// <param name="targetIndexCount"></param>
+    /// <param name="resultError">erreur géométrique maximale introduite, en unités du modèle</param>
+    /// <returns></returns>
+    std::vector<uint32_t> LveMeshOptimizer::simplify(const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float* resultError) {
+        std::vector<uint32_t> result = indices;
+        const size_t vertexCount = vertices.size();
+        double maxError = 0.0;
+
+        std::vector<bool> locked(vertexCount, false);
+        std::unordered_map<glm::vec3, uint32_t> firstAtPosition{};
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            auto inserted = firstAtPosition.emplace(vertices[v].position, v);
+            if (!inserted.second) {
+                locked[v] = true;
+                locked[inserted.first->second] = true;
+            }
+        }
+        std::unordered_map<uint64_t, uint32_t> edgeUse{};
+        for (size_t i = 0; i + 2 < result.size(); i += 3) {
+            for (int k = 0; k < 3; k++) {
+                uint32_t a = result[i + k];
+                uint32_t b = result[i + (k + 1) % 3];
+                edgeUse[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+            }
+        }
+        for (const auto& edge : edgeUse) {
+            if (edge.second == 1) {
+                locked[edge.first >> 32] = true;
+                locked[edge.first & 0xffffffffu] = true;
+            }
+        }
+
+        std::vector<glm::dmat4> quadrics(vertexCount, glm::dmat4{ 0.0 });
+        for (size_t i = 0; i + 2 < result.size(); i += 3) {
+            glm::dvec3 p0{ vertices[result[i + 0]].position };
+            glm::dvec3 p1{ vertices[result[i + 1]].position };
+            glm::dvec3 p2{ vertices[result[i + 2]].position };
+            glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+            double length = glm::length(n);
+            if (length == 0.0) continue;
+
+            n /= length;
+            glm::dvec4 plane{ n, -glm::dot(n, p0) };
+            glm::dmat4 q = glm::outerProduct(plane, plane);
+            quadrics[result[i + 0]] += q;
+            quadrics[result[i + 1]] += q;
+            quadrics[result[i + 2]] += q;
+        }
+        auto quadricError = [&](const glm::dmat4& q, const glm::vec3& p) {
+            glm::dvec4 v{ glm::dvec3{ p }, 1.0 };
+            return std::abs(glm::dot(v, q * v));
+        };
+        auto faceNormal = [](const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+            return glm::cross(b - a, c - a);
+        };
+
+        struct Collapse {
+            uint32_t from;
+            uint32_t to;
+            double error;
+        };
+        std::vector<Collapse> collapses{};
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<bool> touched(vertexCount);
+        std::vector<uint32_t> offsets(vertexCount + 1);
+        std::vector<uint32_t> adjacency{};
+
+        while (result.size() > targetIndexCount) {
+            const size_t triangleCount = result.size() / 3;
+
+            collapses.clear();
+            for (size_t t = 0; t < triangleCount; t++) {
+                for (int k = 0; k < 3; k++) {
+                    uint32_t a = result[t * 3 + k];
+                    uint32_t b = result[t * 3 + (k + 1) % 3];
+                    if (locked[a]) continue;
+                    collapses.push_back({ a, b, quadricError(quadrics[a] + quadrics[b], vertices[b].position) });
+                }
+            }
+            if (collapses.empty()) {
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r) { return l.error < r.error; });
+
+            std::fill(offsets.begin(), offsets.end(), 0);
+            for (uint32_t index : result) {
+                offsets[index + 1]++;
+            }
+            for (size_t v = 0; v < vertexCount; v++) {
+                offsets[v + 1] += offsets[v];
+            }
+            adjacency.resize(result.size());
+            std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (size_t t = 0; t < triangleCount; t++) {
+                for (int k = 0; k < 3; k++) {
+                    adjacency[fill[result[t * 3 + k]]++] = static_cast<uint32_t>(t);
+                }
+            }
+
+            std::iota(remap.begin(), remap.end(), 0);
+            std::fill(touched.begin(), touched.end(), false);
+            const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+            size_t removed = 0;
+            for (const Collapse& c : collapses) {
+                if (removed >= trianglesToRemove) break;
+                if (touched[c.from] || touched[c.to]) continue;
+
+                bool flips = false;
+                size_t collapsedTriangles = 0;
+                for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1] && !flips; a++) {
+                    const uint32_t* tri = &result[adjacency[a] * 3];
+                    if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                        collapsedTriangles++;
+                        continue;
+                    }
+                    glm::vec3 before[3];
+                    glm::vec3 after[3];
+                    for (int k = 0; k < 3; k++) {
+                        before[k] = vertices[tri[k]].position;
+                        after[k] = tri[k] == c.from ? vertices[c.to].position : before[k];
+                    }
+                    if (glm::dot(faceNormal(before[0], before[1], before[2]), faceNormal(after[0], after[1], after[2])) <= 0.f) {
+                        flips = true;
+                    }
+                }
+                if (flips) continue;
+
+                remap[c.from] = c.to;
+                quadrics[c.to] += quadrics[c.from];
+                for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1]; a++) {
+                    for (int k = 0; k < 3; k++) {
+                        touched[result[adjacency[a] * 3 + k]] = true;
+                    }
+                }
+                removed += collapsedTriangles;
+                maxError = std::max(maxError, c.error);
+            }
+            if (removed == 0) {
+                break;
+            }
+
+            size_t write = 0;
+            for (size_t t = 0; t < triangleCount; t++) {
+                uint32_t a = remap[result[t * 3 + 0]];
+                uint32_t b = remap[result[t * 3 + 1]];
+                uint32_t c = remap[result[t * 3 + 2]];
+                if (a == b || b == c || a == c) continue;
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+            result.resize(write);
+        }
+
+        if (resultError != nullptr) {
+            *resultError = static_cast<float>(std::sqrt(maxError));
+        }
+        return result;
+    }
+    /// <summary>
+    /// Réordonne les triangles pour le cache post-transformation avec l'algorithme Tipsify (Sander et al. 2007).
+    /// On "éventaille" autour d'un vertex, puis on choisit le prochain vertex parmi ceux encore dans le cache
+    /// et qui ont encore des triangles à émettre ; sinon on repart d'un vertex de la pile des impasses
+    /// </summary>
+    /// <param name="indices"></param>
+    /// <param name="vertexCount"></param>
+    void LveMeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0 || vertexCount == 0) {
+            return;
+        }
+
+        // adjacence vertex -> triangles, stockée de manière compacte
+        std::vector<uint32_t> live(vertexCount, 0);
+        for (uint32_t index : indices) {
+            live[index]++;
+        }
+        std::vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; v++) {
+            offsets[v + 1] = offsets[v] + live[v];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int k = 0; k < 3; k++) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnd{};
+        std::vector<uint32_t> candidates{};
+        std::vector<uint32_t> result{};
+        result.reserve(indices.size());
+
+        uint32_t timeStamp = CACHE_SIZE + 1;
+        size_t cursor = 0;
+        int64_t fanning = 0;
+
+        while (fanning >= 0) {
+            candidates.clear();
+            for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+                uint32_t t = adjacency[a];
+                if (emitted[t]) continue;
+
+                for (int k = 0; k < 3; k++) {
+                    uint32_t v = indices[t * 3 + k];
+                    result.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (timeStamp - cacheTime[v] > CACHE_SIZE) {
+                        cacheTime[v] = timeStamp++;
+                    }
+                }
+                emitted[t] = true;
+            }
+
+            // vertex suivant : le plus ancien encore dans le cache qui y restera pendant son éventail
+            int64_t next = -1;
+            int64_t bestPriority = -1;
+            for (uint32_t v : candidates) {
+                if (live[v] == 0) continue;
+
+                int64_t priority = 0;
+                if (timeStamp - cacheTime[v] + 2 * live[v] <= CACHE_SIZE) {
+                    priority = timeStamp - cacheTime[v];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+
+            if (next == -1) {
+                while (!deadEnd.empty()) {
+                    uint32_t d = deadEnd.back();
+                    deadEnd.pop_back();
+                    if (live[d] > 0) {
+                        next = d;
+                        break;
+                    }
+                }
+            }
+            while (next == -1 && cursor < vertexCount) {
+                if (live[cursor] > 0) {
+                    next = static_cast<int64_t>(cursor);
+                } else {
+                    cursor++;
+                }
+            }
+            fanning = next;
+        }
+
+        indices.swap(result);
+    }
+    /// <summary>
+    /// Découpe la liste (déjà optimisée pour le cache) en clusters puis les trie pour dessiner en premier
+    /// ceux qui sont tournés vers l'extérieur du mesh, qui ont le plus de chances de cacher les autres.
+    /// Les frontières "dures" sont les triangles qui ratent le cache sur leurs trois sommets ; les frontières
+    /// "souples" coupent un cluster dès que son ACMR local repasse sous threshold * ACMR du cluster dur,
+    /// ce qui borne la perte d'efficacité du cache
+    /// </summary>
+    /// <param name="indices"></param>
+    /// <param name="vertices"></param>
+    /// <param name="threshold"></param>
+    void LveMeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices, float threshold) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2) {
+            return;
+        }
+
+        // cache FIFO simulé ; vider le cache revient à avancer le compteur de défauts de CACHE_SIZE
+        std::vector<int64_t> loadedAt(vertices.size(), std::numeric_limits<int64_t>::min() / 2);
+        int64_t missCount = 0;
+        auto flushCache = [&]() { missCount += CACHE_SIZE; };
+        auto triangleMisses = [&](size_t t) {
+            uint32_t count = 0;
+            for (int k = 0; k < 3; k++) {
+                uint32_t v = indices[t * 3 + k];
+                if (missCount - loadedAt[v] >= CACHE_SIZE) {
+                    loadedAt[v] = missCount++;
+                    count++;
+                }
+            }
+            return count;
+        };
+
+        std::vector<size_t> hardBoundaries{ 0 };
+        triangleMisses(0);
+        for (size_t t = 1; t < triangleCount; t++) {
+            if (triangleMisses(t) == 3) {
+                hardBoundaries.push_back(t);
+            }
+        }
+        hardBoundaries.push_back(triangleCount);
+
+        // les ACMR des clusters sont mesurés avec un cache vidé au début de chaque cluster,
+        // puisqu'après le tri ils ne se suivront plus
+        std::vector<size_t> clusterStarts{};
+        for (size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+            size_t begin = hardBoundaries[h];
+            size_t end = hardBoundaries[h + 1];
+
+            flushCache();
+            size_t clusterMisses = 0;
+            for (size_t t = begin; t < end; t++) {
+                clusterMisses += triangleMisses(t);
+            }
+            float limit = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+            clusterStarts.push_back(begin);
+            flushCache();
+            size_t runningMisses = 0;
+            size_t start = begin;
+            for (size_t t = begin; t + 1 < end; t++) {
+                runningMisses += triangleMisses(t);
+                if (static_cast<float>(runningMisses) / static_cast<float>(t - start + 1) <= limit) {
+                    clusterStarts.push_back(t + 1);
+                    start = t + 1;
+                    runningMisses = 0;
+                    flushCache();
+                }
+            }
+        }
+        clusterStarts.push_back(triangleCount);
+
+        glm::vec3 meshCentroid{ 0.f };
+        float meshArea = 0.f;
+        const size_t clusterCount = clusterStarts.size() - 1;
+        std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{ 0.f });
+        std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{ 0.f });
+        for (size_t c = 0; c < clusterCount; c++) {
+            float clusterArea = 0.f;
+            for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+                const glm::vec3& a = vertices[indices[t * 3 + 0]].position;
+                const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+                const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+                glm::vec3 faceNormal = glm::cross(b - a, d - a);
+                float area = glm::length(faceNormal);
+                glm::vec3 center = (a + b + d) / 3.f;
+
+                clusterCentroids[c] += center * area;
+                clusterNormals[c] += faceNormal;
+                clusterArea += area;
+                meshCentroid += center * area;
+                meshArea += area;
+            }
+            clusterCentroids[c] /= clusterArea > 0.f ? clusterArea : 1.f;
+            float normalLength = glm::length(clusterNormals[c]);
+            clusterNormals[c] /= normalLength > 0.f ? normalLength : 1.f;
+        }
+        meshCentroid /= meshArea > 0.f ? meshArea : 1.f;
+
+        std::vector<float> sortKeys(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]);
+        }
+        std::vector<size_t> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) { return sortKeys[l] > sortKeys[r]; });
+
+        std::vector<uint32_t> result{};
+        result.reserve(indices.size());
+        for (size_t c : order) {
+            result.insert(result.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + clusterStarts[c + 1] * 3);
+        }
+        indices.swap(result);
+    }
+    /// <summary>
+    /// Renumérote les vertices dans l'ordre de leur première utilisation par les indices,
+    /// pour que le fetch lise le tampon de vertex de manière quasi séquentielle. Les vertices non référencés sont supprimés
+    /// </summary>
+    /// <param name="vertices"></param>
+    /// <param name="indices"></param>
+    void LveMeshOptimizer::optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices) {
+        if (indices.empty()) {
+            return;
+        }
+
+        std::vector<uint32_t> remap(vertices.size(), std::numeric_limits<uint32_t>::max());
+        std::vector<LveModel::Vertex> result{};
+        result.reserve(vertices.size());
+        for (uint32_t& index : indices) {
+            if (remap[index] == std::numeric_limits<uint32_t>::max()) {
+                remap[index] = static_cast<uint32_t>(result.size());
+                result.push_back(vertices[index]);
+            }
+            index = remap[index];
+        }
+        vertices.swap(result);
+    }
+    /// <summary>
+    /// Compte les vertices transformés (défauts de cache) en simulant un cache FIFO de cacheSize entrées
+    /// </summary>
+    size_t LveMeshOptimizer::countTransformedVertices(const std::vector<uint32_t>& indices, size_t first, size_t count, size_t vertexCount, uint32_t cacheSize) {
+        std::vector<int64_t> loadedAt(vertexCount, std::numeric_limits<int64_t>::min() / 2);
+        int64_t missCount = 0;
+        for (size_t i = first; i < first + count; i++) {
+            uint32_t v = indices[i];
+            if (missCount - loadedAt[v] >= cacheSize) {
+                loadedAt[v] = missCount++;
+            }
+        }
+        return static_cast<size_t>(missCount);
+    }
+    /// <summary>
+    /// Average Cache Miss Ratio : vertices transformés par triangle (0.5 idéal, 3 au pire)
+    /// </summary>
+    float LveMeshOptimizer::computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return 0.f;
+        }
+        return static_cast<float>(countTransformedVertices(indices, 0, indices.size(), vertexCount, cacheSize)) / static_cast<float>(triangleCount);
+    }
+    /// <summary>
+    /// Average Transformed to Vertex Ratio : vertices transformés par vertex unique référencé (1 idéal)
+    /// </summary>
+    float LveMeshOptimizer::computeATVR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+        std::vector<bool> referenced(vertexCount, false);
+        size_t uniqueCount = 0;
+        for (uint32_t index : indices) {
+            if (!referenced[index]) {
+                referenced[index] = true;
+                uniqueCount++;
+            }
+        }
+        if (uniqueCount == 0) {
+            return 0.f;
+        }
+        return static_cast<float>(countTransformedVertices(indices, 0, indices.size(), vertexCount, cacheSize)) / static_cast<float>(uniqueCount);
+    }
+    /// <summary>
+    /// Taille en octets des tampons de vertex et d'indices tels qu'ils seront envoyés sur le GPU
+    /// </summary>
+    size_t LveMeshOptimizer::computeByteSize(const LveModel::Builder& builder, bool allowShortIndices) {
+        size_t vertexSize = builder.layout == VertexLayout::Packed ? sizeof(LveModel::PackedVertex) : sizeof(LveModel::Vertex);
+        size_t indexSize = allowShortIndices && LveModel::canUseShortIndices(builder.vertices.size()) ? sizeof(uint16_t) : sizeof(uint32_t);
+        return builder.vertices.size() * vertexSize + builder.indices.size() * indexSize;
+    }
+}
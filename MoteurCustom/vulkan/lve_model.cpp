@@ -1,4 +1,7 @@
 #include "lve_model.hpp"
+#include "lve_deletion_queue.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_profiler.hpp"
 #include "lve_utils.hpp"
 
 //libs
@@ -6,9 +9,13 @@
 #include "tiny_obj_loader.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 //std
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <unordered_map>
@@ -16,8 +23,8 @@
 namespace std {
     template<>
     /// <summary>
-    /// Contient des donnes de vertex telles que position, couleur, normale et coordonnes de texture.
-    /// Possde des mthodes statiques(getBindingDescriptions et getAttributeDescriptions) pour dcrire les donnes de vertex pour Vulkan
+    /// Contient des données de vertex telles que position, couleur, normale et coordonnées de texture.
+    /// Possède des méthodes statiques(getBindingDescriptions et getAttributeDescriptions) pour décrire les données de vertex pour Vulkan
     /// </summary>
     struct hash<lve::LveModel::Vertex> {
         size_t operator()(lve::LveModel::Vertex const& vertex) const {
@@ -29,53 +36,167 @@ namespace std {
 }
 
 namespace lve {
+    static_assert(sizeof(LveModel::PackedVertex) == 20, "PackedVertex must stay tightly packed");
+
     /// <summary>
-    /// Prend une rfrence  un objet LveDevice et un objet Builder en paramtre.
-    ///Appelle les fonctions createVertexBuffers et createIndexBuffers pour crer les tampons de vertex et d'indices respectivement
+    /// Encode une normale unitaire en coordonnées octaédriques dans [-1, 1]²
+    /// </summary>
+    /// <param name="n"></param>
+    /// <returns></returns>
+    static glm::vec2 octEncode(glm::vec3 n) {
+        float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        if (l1 == 0.f) {
+            return glm::vec2{ 0.f };
+        }
+        n /= l1;
+        glm::vec2 p{ n.x, n.y };
+        if (n.z < 0.f) {
+            p = (1.f - glm::abs(glm::vec2{ n.y, n.x })) * glm::vec2{ n.x >= 0.f ? 1.f : -1.f, n.y >= 0.f ? 1.f : -1.f };
+        }
+        return p;
+    }
+
+    /// <summary>
+    /// Prend une référence à un objet LveDevice et un objet Builder en paramètre.
+    ///Appelle les fonctions createVertexBuffers et createIndexBuffers pour créer les tampons de vertex et d'indices respectivement.
+    /// Le format des vertices sur le GPU dépend de builder.layout
     /// </summary>
     /// <param name="device"></param>
     /// <param name="builder"></param>
-    LveModel::LveModel(LveDevice& device, const LveModel::Builder& builder) : lveDevice{ device } {
-        createVertexBuffers(builder.vertices);
+    LveModel::LveModel(LveDevice& device, const LveModel::Builder& builder) : lveDevice{ device }, geometryPool{ device.getGeometryPool() }, vertexLayout{ builder.layout } {
+        if (vertexLayout == VertexLayout::Packed) {
+            createPackedVertexBuffers(builder.vertices);
+        } else {
+            createVertexBuffers(builder.vertices);
+        }
         createIndexBuffers(builder.indices);
+        createClusterBuffers(builder.clusters);
+        computeBoundingSphere(builder.vertices);
+
+        lods = builder.lods;
+        if (lods.empty()) {
+            lods.push_back({ 0, indexCount, 0.f });
+        }
     }
     /// <summary>
-    /// Dtruit l'objet LveModel.
-    ///Les tampons de vertex et d'indices sont dtruits automatiquement car ce sont des objets std::unique_ptr
+    /// Détruit l'objet LveModel.
+    ///Rend les plages de vertex, d'indices et de clusters au pool de géométrie une fois que les trames en vol ne les lisent plus
     /// </summary>
-    LveModel::~LveModel() {}
+    LveModel::~LveModel() {
+        assert(lveDevice.hasGeometryPool() && "LveModel destroyed after its device's geometry pool");
+        LveGeometryPool* pool = &geometryPool;
+        lveDevice.getDeletionQueue().defer([pool, vertexAllocation = vertexAllocation, indexAllocation = indexAllocation, clusterAllocation = clusterAllocation]() {
+            if (vertexAllocation != LveGeometryPool::INVALID_HANDLE) {
+                pool->free(LveGeometryPool::Heap::Vertex, vertexAllocation);
+            }
+            if (indexAllocation != LveGeometryPool::INVALID_HANDLE) {
+                pool->free(LveGeometryPool::Heap::Index, indexAllocation);
+            }
+            if (clusterAllocation != LveGeometryPool::INVALID_HANDLE) {
+                pool->free(LveGeometryPool::Heap::Cluster, clusterAllocation);
+            }
+        });
+    }
 
-    std::unique_ptr <LveModel> LveModel::createModelFromFile(LveDevice& device, const std::string& filePath) {
+    std::unique_ptr <LveModel> LveModel::createModelFromFile(LveDevice& device, const std::string& filePath, VertexLayout layout, bool verbose) {
         Builder builder{};
+        builder.layout = layout;
         builder.loadModel(filePath);
         std::cout << "Vertex count: " << builder.vertices.size() << "\n";
 
+        LveMeshOptimizer::generateLods(builder);
+        MeshOptimizationStats stats = LveMeshOptimizer::optimize(builder);
+        LveMeshOptimizer::buildClusters(builder);
+
+        if (verbose) {
+            for (size_t i = 0; i < builder.lods.size(); i++) {
+                std::cout << "LOD " << i << ": " << builder.lods[i].indexCount / 3 << " triangles, error " << builder.lods[i].error << "\n";
+            }
+            std::cout << "Mesh optimization " << filePath << ": ACMR " << stats.acmrBefore << " -> " << stats.acmrAfter
+                << ", ATVR " << stats.atvrBefore << " -> " << stats.atvrAfter
+                << ", " << stats.bytesBefore << " -> " << stats.bytesAfter << " bytes\n";
+            std::cout << "Cluster count: " << builder.clusters.size() << "\n";
+        }
+
         return std::make_unique<LveModel>(device, builder);
     }
     /// <summary>
-    /// Prend un vecteur de Vertex en paramtre.
-    ///Alloue un tampon de vertex sur le GPU aprs avoir utilis un tampon temporaire pour transfrer les donnes depuis le CPU
+    /// Prend un vecteur de Vertex en paramètre.
+    ///Alloue une plage de vertex dans le pool de géométrie et y transfère les données depuis le CPU
     /// </summary>
     /// <param name="vertices"></param>
     void LveModel::createVertexBuffers(const std::vector<Vertex>& vertices) {
         vertexCount = static_cast<uint32_t>(vertices.size());
         assert(vertexCount >= 3 && "Vertex count must be at least 3");
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-        uint32_t vertexSize = sizeof(vertices[0]);
+        uploadVertices(vertices.data(), sizeof(Vertex));
+    }
+    /// <summary>
+    /// Quantifie les vertices au format PackedVertex avant l'envoi sur le GPU.
+    /// Les positions sont stockées relativement à la boîte englobante du modèle ; dequantizeMatrix
+    /// permet de retrouver les coordonnées d'origine et doit être combinée à la matrice de modèle
+    /// </summary>
+    /// <param name="vertices"></param>
+    void LveModel::createPackedVertexBuffers(const std::vector<Vertex>& vertices) {
+        vertexCount = static_cast<uint32_t>(vertices.size());
+        assert(vertexCount >= 3 && "Vertex count must be at least 3");
+
+        glm::vec3 boundsMin{ vertices[0].position };
+        glm::vec3 boundsMax{ vertices[0].position };
+        for (const auto& v : vertices) {
+            boundsMin = glm::min(boundsMin, v.position);
+            boundsMax = glm::max(boundsMax, v.position);
+        }
+        glm::vec3 extent = boundsMax - boundsMin;
+        for (int i = 0; i < 3; i++) {
+            if (extent[i] <= 0.f) extent[i] = 1.f;
+        }
+        dequantizeMatrix = glm::scale(glm::translate(glm::mat4{ 1.f }, boundsMin), extent);
 
-        LveBuffer stagingBuffer{ lveDevice, vertexSize, vertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+        std::vector<PackedVertex> packed(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            const Vertex& v = vertices[i];
+            PackedVertex& p = packed[i];
 
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)vertices.data());
+            glm::vec3 position = glm::clamp((v.position - boundsMin) / extent, 0.f, 1.f);
+            for (int c = 0; c < 3; c++) {
+                p.position[c] = static_cast<uint16_t>(std::lround(position[c] * 65535.f));
+            }
+            p.position[3] = 0;
 
-        vertexBuffer = std::make_unique<LveBuffer>(lveDevice, vertexSize, vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            glm::vec2 normal = octEncode(v.normal);
+            p.normal[0] = static_cast<int16_t>(std::lround(glm::clamp(normal.x, -1.f, 1.f) * 32767.f));
+            p.normal[1] = static_cast<int16_t>(std::lround(glm::clamp(normal.y, -1.f, 1.f) * 32767.f));
 
-        lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
+            glm::vec3 color = glm::clamp(v.color, 0.f, 1.f);
+            for (int c = 0; c < 3; c++) {
+                p.color[c] = static_cast<uint8_t>(std::lround(color[c] * 255.f));
+            }
+            p.color[3] = 255;
+
+            p.uv[0] = glm::packHalf1x16(v.uv.x);
+            p.uv[1] = glm::packHalf1x16(v.uv.y);
+        }
+
+        uploadVertices(packed.data(), sizeof(PackedVertex));
+    }
+    /// <summary>
+    /// Réserve une plage dans le tas de vertex du pool, alignée sur la taille d'un vertex pour que
+    /// l'offset divisé par cette taille serve de vertexOffset, puis y copie les données
+    /// </summary>
+    /// <param name="data"></param>
+    /// <param name="vertexSize"></param>
+    void LveModel::uploadVertices(const void* data, uint32_t vertexSize) {
+        LveGeometryPool& pool = geometryPool;
+        VkDeviceSize bufferSize = static_cast<VkDeviceSize>(vertexSize) * vertexCount;
+        vertexAllocation = pool.allocate(LveGeometryPool::Heap::Vertex, bufferSize, vertexSize);
+        pool.upload(LveGeometryPool::Heap::Vertex, vertexAllocation, data, bufferSize);
+        vertexStride = vertexSize;
     }
     /// <summary>
-    /// Prend un vecteur d'indices en paramtre.
-    ///Alloue un tampon d'indices sur le GPU aprs avoir utilis un tampon temporaire pour transfrer les donnes depuis le CPU.
-    /// Vrifie si l'objet LveModel a un tampon d'indices(s'il y a des indices)
+    /// Prend un vecteur d'indices en paramètre.
+    ///Alloue une plage d'indices dans le pool de géométrie et y transfère les données depuis le CPU.
+    /// Vérifie si l'objet LveModel a un tampon d'indices(s'il y a des indices).
+    /// Les indices sont stockés sur 16 bits quand il y a moins de 65536 vertices
     /// </summary>
     /// <param name="indices"></param>
     void LveModel::createIndexBuffers(const std::vector<uint32_t>& indices) {
@@ -85,52 +206,138 @@ namespace lve {
             return;
         }
 
-        VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
-        uint32_t indexSize = sizeof(indices[0]);
-
-        LveBuffer stagingBuffer{ lveDevice, indexSize, indexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)indices.data());
-
-        indexBuffer = std::make_unique<LveBuffer>(lveDevice, indexSize, indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        std::vector<uint16_t> shortIndices{};
+        const void* indexData = indices.data();
+        uint32_t indexSize = sizeof(uint32_t);
+        indexType = VK_INDEX_TYPE_UINT32;
+        if (canUseShortIndices(vertexCount)) {
+            shortIndices.reserve(indices.size());
+            for (uint32_t index : indices) {
+                shortIndices.push_back(static_cast<uint16_t>(index));
+            }
+            indexData = shortIndices.data();
+            indexSize = sizeof(uint16_t);
+            indexType = VK_INDEX_TYPE_UINT16;
+        }
+        VkDeviceSize bufferSize = static_cast<VkDeviceSize>(indexSize) * indexCount;
 
-        lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+        LveGeometryPool& pool = geometryPool;
+        indexAllocation = pool.allocate(LveGeometryPool::Heap::Index, bufferSize, sizeof(uint32_t));
+        pool.upload(LveGeometryPool::Heap::Index, indexAllocation, indexData, bufferSize);
+        indexSizeBytes = indexSize;
     }
     /// <summary>
-    /// Appelle vkCmdDrawIndexed ou vkCmdDraw en fonction de la prsence d'un tampon d'indices
+    /// Appelle vkCmdDrawIndexed ou vkCmdDraw en fonction de la présence d'un tampon d'indices.
+    /// Avec un tampon d'indices, seule la plage du niveau de détail demandé est dessinée
     /// </summary>
     /// <param name="commandBuffer"></param>
-    void LveModel::draw(VkCommandBuffer commandBuffer) {
+    /// <param name="lod"></param>
+    /// <param name="firstInstance"></param>
+    void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t firstInstance) {
         if (hasIndexBuffer) {
-            vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+            const Lod& range = lods[std::min(lod, static_cast<uint32_t>(lods.size()) - 1)];
+            vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, getFirstIndex() + range.firstIndex, getVertexOffset(), firstInstance);
         } else {
-            vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+            vkCmdDraw(commandBuffer, vertexCount, 1, static_cast<uint32_t>(getVertexOffset()), firstInstance);
+        }
+    }
+    /// <summary>
+    /// Envoie les clusters du Builder dans le tas des clusters du pool. Les allocations sont alignées sur la taille d'un Cluster,
+    /// le shader de culling les indexe donc directement avec getFirstCluster()
+    /// </summary>
+    /// <param name="clusters"></param>
+    void LveModel::createClusterBuffers(const std::vector<Cluster>& clusters) {
+        clusterCount = static_cast<uint32_t>(clusters.size());
+        if (clusterCount == 0) {
+            return;
         }
+        LveGeometryPool& pool = geometryPool;
+        VkDeviceSize bufferSize = sizeof(Cluster) * clusters.size();
+        clusterAllocation = pool.allocate(LveGeometryPool::Heap::Cluster, bufferSize, sizeof(Cluster));
+        pool.upload(LveGeometryPool::Heap::Cluster, clusterAllocation, clusters.data(), bufferSize);
     }
     /// <summary>
-    /// Appelle vkCmdBindVertexBuffers et vkCmdBindIndexBuffer pour lier les tampons au pipeline de rendu
+    /// Position, en nombre de clusters, du premier cluster du modèle dans le tas des clusters
+    /// </summary>
+    /// <returns></returns>
+    uint32_t LveModel::getFirstCluster() const {
+        assert(clusterCount > 0 && "Model has no clusters");
+        return static_cast<uint32_t>(geometryPool.getOffset(LveGeometryPool::Heap::Cluster, clusterAllocation) / sizeof(Cluster));
+    }
+    /// <summary>
+    /// Position, en nombre d'indices, du début du tampon d'indices du modèle dans le tas d'indices.
+    /// Recalculée à chaque appel car le compactage du pool peut déplacer la plage
+    /// </summary>
+    /// <returns></returns>
+    uint32_t LveModel::getFirstIndex() const {
+        return static_cast<uint32_t>(geometryPool.getOffset(LveGeometryPool::Heap::Index, indexAllocation) / indexSizeBytes);
+    }
+    /// <summary>
+    /// Position, en nombre de vertices, du premier vertex du modèle dans le tas de vertex
+    /// </summary>
+    /// <returns></returns>
+    int32_t LveModel::getVertexOffset() const {
+        return static_cast<int32_t>(geometryPool.getOffset(LveGeometryPool::Heap::Vertex, vertexAllocation) / vertexStride);
+    }
+    /// <summary>
+    /// Calcule une sphère englobante (centre de la boîte englobante, rayon au vertex le plus éloigné),
+    /// utilisée pour estimer la taille projetée à l'écran lors du choix du niveau de détail
+    /// </summary>
+    /// <param name="vertices"></param>
+    void LveModel::computeBoundingSphere(const std::vector<Vertex>& vertices) {
+        if (vertices.empty()) {
+            return;
+        }
+        glm::vec3 boundsMin{ vertices[0].position };
+        glm::vec3 boundsMax{ vertices[0].position };
+        for (const auto& v : vertices) {
+            boundsMin = glm::min(boundsMin, v.position);
+            boundsMax = glm::max(boundsMax, v.position);
+        }
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        float radius = 0.f;
+        for (const auto& v : vertices) {
+            radius = std::max(radius, glm::length(v.position - center));
+        }
+        boundingSphere = glm::vec4{ center, radius };
+    }
+    /// <summary>
+    /// Lie les tampons du pool de géométrie ; comme tous les modèles partagent les mêmes tampons,
+    /// le pool ignore les liaisons redondantes et seul un changement de type d'indice coûte un appel
     /// </summary>
     /// <param name="commandBuffer"></param>
     void LveModel::bind(VkCommandBuffer commandBuffer) {
-        VkBuffer buffers[] = { vertexBuffer->getBuffer() };
-        VkDeviceSize offset[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offset);
-        if (hasIndexBuffer) {
-            vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-        }
+        geometryPool.bind(commandBuffer, indexType);
     }
 
-    std::vector<VkVertexInputBindingDescription>LveModel::Vertex::getBindingDescriptions() {
+    /// <summary>
+    /// Décrit le binding de vertex pour le format demandé (Vertex ou PackedVertex)
+    /// </summary>
+    /// <param name="layout"></param>
+    /// <returns></returns>
+    std::vector<VkVertexInputBindingDescription>LveModel::Vertex::getBindingDescriptions(VertexLayout layout) {
         std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
         bindingDescriptions[0].binding = 0;
-        bindingDescriptions[0].stride = sizeof(Vertex);
+        bindingDescriptions[0].stride = layout == VertexLayout::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
         bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
         return bindingDescriptions;
     }
-
-    std::vector<VkVertexInputAttributeDescription>LveModel::Vertex::getAttributeDescriptions() {
+    /// <summary>
+    /// Décrit les attributs de vertex pour le format demandé.
+    /// Les emplacements (locations) sont identiques pour les deux formats, seul le VkFormat change :
+    /// le shader reçoit toujours des flottants, la décompression est faite par l'unité de fetch
+    /// </summary>
+    /// <param name="layout"></param>
+    /// <returns></returns>
+    std::vector<VkVertexInputAttributeDescription>LveModel::Vertex::getAttributeDescriptions(VertexLayout layout) {
         std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+        if (layout == VertexLayout::Packed) {
+            attributeDescriptions.push_back({ 0,0,VK_FORMAT_R16G16B16A16_UNORM,offsetof(PackedVertex, position) });
+            attributeDescriptions.push_back({ 1,0,VK_FORMAT_R8G8B8A8_UNORM,offsetof(PackedVertex, color) });
+            attributeDescriptions.push_back({ 2,0,VK_FORMAT_R16G16_SNORM,offsetof(PackedVertex, normal) });
+            attributeDescriptions.push_back({ 3,0,VK_FORMAT_R16G16_SFLOAT,offsetof(PackedVertex, uv) });
+            return attributeDescriptions;
+        }
         attributeDescriptions.push_back({ 0,0,VK_FORMAT_R32G32B32_SFLOAT,offsetof(Vertex, position) });
         attributeDescriptions.push_back({ 1,0,VK_FORMAT_R32G32B32_SFLOAT,offsetof(Vertex, color) });
         attributeDescriptions.push_back({ 2,0,VK_FORMAT_R32G32B32_SFLOAT,offsetof(Vertex, normal) });
@@ -138,12 +345,13 @@ namespace lve {
         return attributeDescriptions;
     }
     /// <summary>
-    /// Contient une mthode loadModel qui utilise la bibliothque TinyObjLoader pour charger un modle  partir d'un fichier OBJ.
-    /// Remplit le vecteur de vertices(vertices) et d'indices (indices)  partir des donnes du fichier OBJ.
-    /// Utilise un dictionnaire std::unordered_map pour garantir l'unicit des vertices
+    /// Contient une méthode loadModel qui utilise la bibliothèque TinyObjLoader pour charger un modèle à partir d'un fichier OBJ.
+    /// Remplit le vecteur de vertices(vertices) et d'indices (indices) à partir des données du fichier OBJ.
+    /// Utilise un dictionnaire std::unordered_map pour garantir l'unicité des vertices
     /// </summary>
     /// <param name="filepath"></param>
     void LveModel::Builder::loadModel(const std::string& filepath) {
+        LVE_PROFILE_FUNCTION();
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t > materials;
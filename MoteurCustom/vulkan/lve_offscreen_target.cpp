@@ -0,0 +1,325 @@
+#include "lve_offscreen_target.hpp"
+#include "lve_buffer.hpp"
+#include "lve_profiler.hpp"
+
+// std
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace lve {
+    /// <summary>
+    /// Crée les images de couleur et de profondeur, la render pass et les tampons de trame du rendu hors écran.
+    /// Une image par trame en vol : il n'y a pas de présentation, l'image de la trame est libre dès que son timeline est atteint
+    /// </summary>
+    /// <param name="deviceRef"></param>
+    /// <param name="extent"></param>
+    /// <param name="framesInFlight"></param>
+    LveOffscreenTarget::LveOffscreenTarget(LveDevice& deviceRef, VkExtent2D extent, int framesInFlight) : device{ deviceRef }, extent{ extent } {
+        depthFormat = findDepthFormat();
+        colorImages.resize(framesInFlight);
+        frameTimelineValues.assign(framesInFlight, 0);
+        createImages();
+        createRenderPass();
+        createFramebuffers();
+    }
+    /// <summary>
+    /// Libère les images, vues, tampons de trame et la render pass
+    /// </summary>
+    LveOffscreenTarget::~LveOffscreenTarget() {
+        for (auto framebuffer : framebuffers) {
+            vkDestroyFramebuffer(device.getDevice(), framebuffer, nullptr);
+        }
+        vkDestroyRenderPass(device.getDevice(), renderPass, nullptr);
+
+        for (size_t i = 0; i < colorImages.size(); i++) {
+            vkDestroyImageView(device.getDevice(), colorImageViews[i], nullptr);
+            vkDestroyImage(device.getDevice(), colorImages[i], nullptr);
+            vkFreeMemory(device.getDevice(), colorImageMemorys[i], nullptr);
+            vkDestroyImageView(device.getDevice(), depthImageViews[i], nullptr);
+            vkDestroyImage(device.getDevice(), depthImages[i], nullptr);
+            vkFreeMemory(device.getDevice(), depthImageMemorys[i], nullptr);
+        }
+    }
+    /// <summary>
+    /// Attend que le GPU ait terminé la dernière trame soumise
+    /// </summary>
+    void LveOffscreenTarget::waitForLastSubmission() {
+        size_t lastFrame = (currentFrame + frameTimelineValues.size() - 1) % frameTimelineValues.size();
+        device.waitForTimeline(frameTimelineValues[lastFrame]);
+    }
+    /// <summary>
+    /// Équivalent de LveSwapChain::acquireNextImage : attend que l'image de la trame courante ne soit plus utilisée par le GPU
+    /// </summary>
+    /// <param name="imageIndex"></param>
+    /// <returns></returns>
+    VkResult LveOffscreenTarget::acquireNextImage(uint32_t* imageIndex) {
+        LVE_PROFILE_FUNCTION();
+        device.waitForTimeline(frameTimelineValues[currentFrame]);
+        *imageIndex = static_cast<uint32_t>(currentFrame);
+        return VK_SUCCESS;
+    }
+    /// <summary>
+    /// Soumet les tampons de commandes de la trame sur le timeline du device, sans sémaphore ni présentation
+    /// </summary>
+    /// <param name="buffers"></param>
+    /// <param name="imageIndex"></param>
+    /// <returns></returns>
+    VkResult LveOffscreenTarget::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex) {
+        LVE_PROFILE_FUNCTION();
+        frameTimelineValues[*imageIndex] = device.submitGraphics({ buffers[0] });
+        currentFrame = (currentFrame + 1) % frameTimelineValues.size();
+        return VK_SUCCESS;
+    }
+    /// <summary>
+    /// Copie l'image de couleur index dans un tampon visible par l'hôte et retourne ses pixels (RGBA8, ligne par ligne).
+    /// Bloquant : sert aux tests de régression et aux captures, pas à la boucle de rendu
+    /// </summary>
+    /// <param name="index"></param>
+    /// <returns></returns>
+    std::vector<uint8_t> LveOffscreenTarget::readPixels(int index) {
+        VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+        LveBuffer stagingBuffer{ device, size, 1, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+
+        // la render pass laisse l'image en TRANSFER_SRC_OPTIMAL, et sa dépendance de sortie couvre la copie soumise après elle
+        VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = { extent.width, extent.height, 1 };
+        vkCmdCopyImageToBuffer(commandBuffer, colorImages[index], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer.getBuffer(), 1, &region);
+        device.endSingleTimeCommands(commandBuffer);
+
+        std::vector<uint8_t> pixels(size);
+        stagingBuffer.map();
+        std::memcpy(pixels.data(), stagingBuffer.getMappedMemory(), size);
+        return pixels;
+    }
+    int LveOffscreenTarget::getLastImageIndex() const {
+        return static_cast<int>((currentFrame + frameTimelineValues.size() - 1) % frameTimelineValues.size());
+    }
+    /// <summary>
+    /// Attend la dernière trame soumise et relit son image de couleur
+    /// </summary>
+    /// <returns></returns>
+    std::vector<uint8_t> LveOffscreenTarget::readLastFrame() {
+        waitForLastSubmission();
+        return readPixels(getLastImageIndex());
+    }
+    /// <summary>
+    /// Écrit la dernière trame soumise en PPM binaire (P6, RGB sur 8 bits, l'alpha est ignoré) : l'image de référence
+    /// des tests de régression
+    /// </summary>
+    /// <param name="filepath"></param>
+    void LveOffscreenTarget::saveLastFrame(const std::string& filepath) {
+        std::vector<uint8_t> pixels = readLastFrame();
+        std::ofstream file{ filepath, std::ios::binary };
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to write image: " + filepath);
+        }
+        file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            file.write(reinterpret_cast<const char*>(&pixels[i]), 3);
+        }
+    }
+    /// <summary>
+    /// Compare la dernière trame soumise à une image PPM écrite par saveLastFrame. Un pixel diffère si l'un de ses canaux
+    /// s'écarte de plus de tolerance de la référence ; une référence illisible ou d'une autre taille lève une exception
+    /// </summary>
+    /// <param name="filepath"></param>
+    /// <param name="tolerance"></param>
+    /// <returns>le nombre de pixels qui diffèrent</returns>
+    size_t LveOffscreenTarget::compareLastFrame(const std::string& filepath, uint8_t tolerance) {
+        std::ifstream file{ filepath, std::ios::binary };
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open reference image: " + filepath);
+        }
+        std::string magic;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t maxValue = 0;
+        file >> magic >> width >> height >> maxValue;
+        file.get();  // un seul blanc sépare l'en-tête des pixels
+        if (!file || magic != "P6" || maxValue != 255) {
+            throw std::runtime_error("reference image is not a binary 8-bit PPM: " + filepath);
+        }
+        if (width != extent.width || height != extent.height) {
+            throw std::runtime_error("reference image " + filepath + " is " + std::to_string(width) + "x" + std::to_string(height)
+                + ", rendered " + std::to_string(extent.width) + "x" + std::to_string(extent.height));
+        }
+        std::vector<uint8_t> reference(static_cast<size_t>(width) * height * 3);
+        if (!file.read(reinterpret_cast<char*>(reference.data()), static_cast<std::streamsize>(reference.size()))) {
+            throw std::runtime_error("reference image is truncated: " + filepath);
+        }
+
+        std::vector<uint8_t> pixels = readLastFrame();
+        size_t different = 0;
+        for (size_t pixel = 0; pixel < reference.size() / 3; pixel++) {
+            for (size_t channel = 0; channel < 3; channel++) {
+                if (std::abs(pixels[pixel * 4 + channel] - reference[pixel * 3 + channel]) > tolerance) {
+                    different++;
+                    break;
+                }
+            }
+        }
+        return different;
+    }
+    /// <summary>
+    /// Crée les images de couleur (copiables pour la relecture) et de profondeur avec leurs vues
+    /// </summary>
+    void LveOffscreenTarget::createImages() {
+        size_t count = colorImages.size();
+        colorImageMemorys.resize(count);
+        colorImageViews.resize(count);
+        depthImages.resize(count);
+        depthImageMemorys.resize(count);
+        depthImageViews.resize(count);
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = extent.width;
+        imageInfo.extent.height = extent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        for (size_t i = 0; i < count; i++) {
+            imageInfo.format = COLOR_FORMAT;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, colorImages[i], colorImageMemorys[i]);
+            colorImageViews[i] = createImageView(colorImages[i], COLOR_FORMAT, VK_IMAGE_ASPECT_COLOR_BIT);
+
+            imageInfo.format = depthFormat;
+            imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImages[i], depthImageMemorys[i]);
+            depthImageViews[i] = createImageView(depthImages[i], depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+        }
+    }
+    /// <summary>
+    /// Crée une vue 2D sur une image à un seul niveau
+    /// </summary>
+    /// <param name="image"></param>
+    /// <param name="format"></param>
+    /// <param name="aspectMask"></param>
+    /// <returns></returns>
+    VkImageView LveOffscreenTarget::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectMask) {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = aspectMask;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        VkImageView imageView;
+        if (vkCreateImageView(device.getDevice(), &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen image view!");
+        }
+        return imageView;
+    }
+    /// <summary>
+    /// Même render pass que la chaîne d'échanges (les pipelines restent compatibles), mais l'image de couleur
+    /// finit en TRANSFER_SRC_OPTIMAL pour pouvoir être relue
+    /// </summary>
+    void LveOffscreenTarget::createRenderPass() {
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = depthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depthAttachmentRef{};
+        depthAttachmentRef.attachment = 1;
+        depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentDescription colorAttachment = {};
+        colorAttachment.format = COLOR_FORMAT;
+        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        VkAttachmentReference colorAttachmentRef = {};
+        colorAttachmentRef.attachment = 0;
+        colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
+        subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+        std::array<VkSubpassDependency, 2> dependencies{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        // les copies vers l'hôte (readPixels) lisent ce que la passe a écrit
+        dependencies[1].srcSubpass = 0;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
+        VkRenderPassCreateInfo renderPassInfo = {};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = 1;
+        renderPassInfo.pSubpasses = &subpass;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        if (vkCreateRenderPass(device.getDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create offscreen render pass!");
+        }
+    }
+    /// <summary>
+    /// Crée un tampon de trame par image
+    /// </summary>
+    void LveOffscreenTarget::createFramebuffers() {
+        framebuffers.resize(imageCount());
+        for (size_t i = 0; i < imageCount(); i++) {
+            std::array<VkImageView, 2> attachments = { colorImageViews[i], depthImageViews[i] };
+
+            VkFramebufferCreateInfo framebufferInfo = {};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments = attachments.data();
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(device.getDevice(), &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create offscreen framebuffer!");
+            }
+        }
+    }
+
+    VkFormat LveOffscreenTarget::findDepthFormat() {
+        return device.findSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+    }
+}
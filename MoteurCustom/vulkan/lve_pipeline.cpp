@@ -1,14 +1,43 @@
 #include "lve_pipeline.hpp"
+#include "lve_deletion_queue.hpp"
 #include "lve_model.hpp"
+#include "lve_shader_library.hpp"
 
-#include <fstream>
-#include <iostream>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 namespace lve {
     /// <summary>
-    /// Prend une rfrence  un objet LveDevice, les chemins des fichiers des shaders vertex et fragment, ainsi qu'une structure PipeLineConfigInfo en paramtres.
-    ///Appelle la fonction createGraphicsPipeline pour crer le pipeline graphique Vulkan
+    /// Copie une configuration de pipeline ; colorBlendInfo et dynamicStateInfo pointent vers des membres de la structure,
+    /// ces pointeurs sont donc refaits sur la copie
+    /// </summary>
+    /// <param name="src"></param>
+    /// <param name="dst"></param>
+    static void copyPipeLineConfigInfo(const PipeLineConfigInfo& src, PipeLineConfigInfo& dst) {
+        dst.bindingDescriptions = src.bindingDescriptions;
+        dst.attributeDescriptions = src.attributeDescriptions;
+        dst.viewportInfo = src.viewportInfo;
+        dst.inputAssemblyInfo = src.inputAssemblyInfo;
+        dst.rasterizationInfo = src.rasterizationInfo;
+        dst.multisampleInfo = src.multisampleInfo;
+        dst.colorBlendAttachment = src.colorBlendAttachment;
+        dst.colorBlendInfo = src.colorBlendInfo;
+        dst.colorBlendInfo.pAttachments = &dst.colorBlendAttachment;
+        dst.depthStencilInfo = src.depthStencilInfo;
+        dst.dynamicStateEnables = src.dynamicStateEnables;
+        dst.dynamicStateInfo = src.dynamicStateInfo;
+        dst.dynamicStateInfo.pDynamicStates = dst.dynamicStateEnables.data();
+        dst.pipelineLayout = src.pipelineLayout;
+        dst.renderPass = src.renderPass;
+        dst.subpass = src.subpass;
+        dst.specializationEntries = src.specializationEntries;
+        dst.specializationData = src.specializationData;
+    }
+
+    /// <summary>
+    /// Prend une référence à un objet LveDevice, les chemins des fichiers des shaders vertex et fragment, ainsi qu'une structure PipeLineConfigInfo en paramètres.
+    ///Appelle la fonction createGraphicsPipeline pour créer le pipeline graphique Vulkan
     /// </summary>
     /// <param name="device"></param>
     /// <param name="vertFilePath"></param>
@@ -18,41 +47,36 @@ namespace lve {
         createGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
     }
     /// <summary>
-    /// Dtruit les modules de shader et le pipeline graphique
+    /// Crée un pipeline de calcul à partir d'un shader compute et d'un pipeline layout existant
     /// </summary>
-    LvePipeline::~LvePipeline() {
-        vkDestroyShaderModule(lveDevice.getDevice(), vertShaderModule, nullptr);
-        vkDestroyShaderModule(lveDevice.getDevice(), fragShaderModule, nullptr);
-        vkDestroyPipeline(lveDevice.getDevice(), graphicsPipeline, nullptr);
+    /// <param name="device"></param>
+    /// <param name="compFilePath"></param>
+    /// <param name="pipelineLayout"></param>
+    LvePipeline::LvePipeline(LveDevice& device, const std::string& compFilePath, VkPipelineLayout pipelineLayout) : lveDevice{ device } {
+        createComputePipeline(compFilePath, pipelineLayout);
     }
     /// <summary>
-    /// Prend un chemin de fichier en paramtre et retourne le contenu du fichier sous forme de vecteur de caractres
+    /// Détruit le pipeline graphique et ses permutations, différé jusqu'à la fin des trames en vol ;
+    /// les modules de shader sont rendus à la bibliothèque de shaders
     /// </summary>
-    /// <param name="filepath"></param>
-    /// <returns></returns>
-    std::vector<char> LvePipeline::readFile(const std::string& filepath) {
-        std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file: " + filepath);
+    LvePipeline::~LvePipeline() {
+        std::vector<VkPipeline> pipelines{ graphicsPipeline };
+        for (auto& kv : permutations) {
+            pipelines.push_back(kv.second);
         }
-
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-
-        std::cout << "Loaded SPIR-V code from " << filepath << " with size: " << fileSize << " bytes" << std::endl;
-
-        return buffer;
+        lveDevice.getDeletionQueue().defer([device = lveDevice.getDevice(), pipelines = std::move(pipelines)]() {
+            for (VkPipeline pipeline : pipelines) {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+        });
     }
     /// <summary>
-    /// Lit le code source des shaders depuis les fichiers spcifis.
-    ///Cre les modules de shader et les tapes du pipeline graphique Vulkan.
-    ///    Utilise la configuration fournie(PipeLineConfigInfo) pour spcifier divers paramtres du pipeline
+    /// Récupère les modules de shader des fichiers spécifiés auprès de la bibliothèque de shaders du device
+    /// (partagés avec les autres pipelines qui utilisent le même SPIR-V).
+    ///Crée les étapes du pipeline graphique Vulkan.
+    ///    Utilise la configuration fournie(PipeLineConfigInfo) pour spécifier divers paramètres du pipeline.
+    /// La configuration est conservée pour construire plus tard d'autres permutations des constantes de spécialisation
+    /// avec les mêmes modules de shader
     /// </summary>
     /// <param name="vertFilepath"></param>
     /// <param name="fragFilepath"></param>
@@ -61,27 +85,43 @@ namespace lve {
         assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline: no pipelineLayout provided in configInfo");
         assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline: no renderPass provided in configInfo");
 
-        auto vertCode = readFile(vertFilepath);
-        auto fragCode = readFile(fragFilepath);
+        vertShaderModule = lveDevice.getShaderLibrary().load(vertFilepath);
+        fragShaderModule = lveDevice.getShaderLibrary().load(fragFilepath);
 
-        createShaderModule(vertCode, &vertShaderModule);
-        createShaderModule(fragCode, &fragShaderModule);
+        permutationConfig = std::make_unique<PipeLineConfigInfo>();
+        copyPipeLineConfigInfo(configInfo, *permutationConfig);
+        graphicsPipeline = buildGraphicsPipeline(*permutationConfig, permutationConfig->specializationData);
+    }
+    /// <summary>
+    /// Crée un pipeline graphique à partir des modules de shader déjà chargés, avec les valeurs de constantes de spécialisation données.
+    /// Passe par le cache de pipelines du device, qui peut être utilisé depuis plusieurs threads à la fois
+    /// </summary>
+    /// <param name="configInfo"></param>
+    /// <param name="specializationData"></param>
+    /// <returns></returns>
+    VkPipeline LvePipeline::buildGraphicsPipeline(const PipeLineConfigInfo& configInfo, const std::vector<uint8_t>& specializationData) {
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = static_cast<uint32_t>(configInfo.specializationEntries.size());
+        specializationInfo.pMapEntries = configInfo.specializationEntries.data();
+        specializationInfo.dataSize = specializationData.size();
+        specializationInfo.pData = specializationData.data();
+        const VkSpecializationInfo* pSpecializationInfo = configInfo.specializationEntries.empty() ? nullptr : &specializationInfo;
 
         VkPipelineShaderStageCreateInfo shaderStages[2];
         shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-        shaderStages[0].module = vertShaderModule;
+        shaderStages[0].module = vertShaderModule->getShaderModule();
         shaderStages[0].pName = "main";
         shaderStages[0].flags = 0;
         shaderStages[0].pNext = nullptr;
-        shaderStages[0].pSpecializationInfo = nullptr;
+        shaderStages[0].pSpecializationInfo = pSpecializationInfo;
         shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        shaderStages[1].module = fragShaderModule;
+        shaderStages[1].module = fragShaderModule->getShaderModule();
         shaderStages[1].pName = "main";
         shaderStages[1].flags = 0;
         shaderStages[1].pNext = nullptr;
-        shaderStages[1].pSpecializationInfo = nullptr;
+        shaderStages[1].pSpecializationInfo = pSpecializationInfo;
 
         auto& bindingDescriptions = configInfo.bindingDescriptions;
         auto& attributeDescriptions = configInfo.attributeDescriptions;
@@ -112,34 +152,84 @@ namespace lve {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(lveDevice.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+        VkPipeline pipeline;
+        if (vkCreateGraphicsPipelines(lveDevice.getDevice(), lveDevice.getPipelineCache(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline");
         }
+        return pipeline;
+    }
+    /// <summary>
+    /// Retourne le pipeline correspondant à la permutation (valeurs de constantes de spécialisation remplaçant celles de la configuration).
+    /// Chaque permutation est créée à la première demande puis gardée ; la configuration de base renvoie le pipeline d'origine
+    /// </summary>
+    /// <param name="permutation"></param>
+    /// <returns></returns>
+    VkPipeline LvePipeline::getPermutation(const SpecializationPermutation& permutation) {
+        assert(permutationConfig != nullptr && "Permutations are only available for graphics pipelines");
+
+        std::vector<uint8_t>& specializationData = specializationScratch;
+        specializationData.assign(permutationConfig->specializationData.begin(), permutationConfig->specializationData.end());
+        for (const auto& [constantId, value] : permutation) {
+            auto entry = std::find_if(permutationConfig->specializationEntries.begin(), permutationConfig->specializationEntries.end(),
+                [constantId](const VkSpecializationMapEntry& e) { return e.constantID == constantId; });
+            assert(entry != permutationConfig->specializationEntries.end() && "Specialization constant missing from the pipeline configuration");
+            std::memcpy(specializationData.data() + entry->offset, &value, sizeof(value));
+        }
+        if (specializationData == permutationConfig->specializationData) {
+            return graphicsPipeline;
+        }
+
+        auto it = permutations.find(specializationData);
+        if (it == permutations.end()) {
+            it = permutations.emplace(specializationData, buildGraphicsPipeline(*permutationConfig, specializationData)).first;
+        }
+        return it->second;
     }
     /// <summary>
-    /// Cre un module de shader Vulkan  partir du code source du shader
+    /// Lit le shader compute et crée le pipeline de calcul ; bind() utilisera alors le point de liaison compute
     /// </summary>
-    /// <param name="code"></param>
-    /// <param name="shaderModule"></param>
-    void LvePipeline::createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-        VkShaderModuleCreateInfo createInfo{};
-        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
-
-        if (vkCreateShaderModule(lveDevice.getDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create shader module");
+    /// <param name="compFilepath"></param>
+    /// <param name="pipelineLayout"></param>
+    void LvePipeline::createComputePipeline(const std::string& compFilepath, VkPipelineLayout pipelineLayout) {
+        assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided");
+
+        compShaderModule = lveDevice.getShaderLibrary().load(compFilepath);
+
+        VkPipelineShaderStageCreateInfo shaderStage{};
+        shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        shaderStage.module = compShaderModule->getShaderModule();
+        shaderStage.pName = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = shaderStage;
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(lveDevice.getDevice(), lveDevice.getPipelineCache(), 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create compute pipeline");
         }
+        bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
     }
     /// <summary>
-    /// Lie le pipeline graphique au tampon de commandes Vulkan spcifi
+    /// Lie le pipeline (graphique ou de calcul) au tampon de commandes Vulkan spécifié
     /// </summary>
     /// <param name="VkCommandBuffer"></param>
     void LvePipeline::bind(VkCommandBuffer(commandBuffer)) {
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+        vkCmdBindPipeline(commandBuffer, bindPoint, graphicsPipeline);
     }
     /// <summary>
-    /// Initialise une structure PipeLineConfigInfo avec des valeurs par dfaut
+    /// Lie la permutation demandée du pipeline graphique
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="permutation"></param>
+    void LvePipeline::bind(VkCommandBuffer commandBuffer, const SpecializationPermutation& permutation) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, getPermutation(permutation));
+    }
+    /// <summary>
+    /// Initialise une structure PipeLineConfigInfo avec des valeurs par défaut
     /// </summary>
     /// <param name="configInfo"></param>
     void LvePipeline::defaultPipeLineConfigInfo(PipeLineConfigInfo& configInfo) {
@@ -214,7 +304,7 @@ namespace lve {
         configInfo.attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
     }
     /// <summary>
-    /// Active le mlange alpha dans la configuration du pipeline
+    /// Active le mélange alpha dans la configuration du pipeline
     /// </summary>
     /// <param name="configInfo"></param>
     void LvePipeline::enableAlphaBlending(PipeLineConfigInfo& configInfo) {
@@ -227,4 +317,36 @@ namespace lve {
         configInfo.colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
         configInfo.colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
     }
+    /// <summary>
+    /// Ajoute (ou remplace) une constante de spécialisation 32 bits utilisée par les shaders du pipeline
+    /// </summary>
+    /// <param name="configInfo"></param>
+    /// <param name="constantId"></param>
+    /// <param name="value"></param>
+    void LvePipeline::setSpecializationConstant(PipeLineConfigInfo& configInfo, uint32_t constantId, uint32_t value) {
+        for (const auto& entry : configInfo.specializationEntries) {
+            if (entry.constantID == constantId) {
+                std::memcpy(configInfo.specializationData.data() + entry.offset, &value, sizeof(value));
+                return;
+            }
+        }
+        VkSpecializationMapEntry entry{};
+        entry.constantID = constantId;
+        entry.offset = static_cast<uint32_t>(configInfo.specializationData.size());
+        entry.size = sizeof(value);
+        configInfo.specializationEntries.push_back(entry);
+        configInfo.specializationData.resize(configInfo.specializationData.size() + sizeof(value));
+        std::memcpy(configInfo.specializationData.data() + entry.offset, &value, sizeof(value));
+    }
+    /// <summary>
+    /// Variante pour une constante float, stockée bit à bit sur 32 bits
+    /// </summary>
+    /// <param name="configInfo"></param>
+    /// <param name="constantId"></param>
+    /// <param name="value"></param>
+    void LvePipeline::setSpecializationConstant(PipeLineConfigInfo& configInfo, uint32_t constantId, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        setSpecializationConstant(configInfo, constantId, bits);
+    }
 }//namespace lve
\ No newline at end of file
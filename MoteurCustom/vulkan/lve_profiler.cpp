@@ -0,0 +1,135 @@
+#include "lve_profiler.hpp"
+#include "lve_utils.hpp"
+
+//std
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace lve {
+    /// <summary>
+    /// Profileur unique du processus, créé au premier appel
+    /// </summary>
+    /// <returns></returns>
+    LveProfiler& LveProfiler::get() {
+        static LveProfiler profiler;
+        return profiler;
+    }
+    /// <summary>
+    /// Tampon circulaire du thread appelant. Il est enregistré sous mutex la première fois, puis retrouvé par un pointeur thread_local ;
+    /// les tampons vivent aussi longtemps que le profileur, même après la fin de leur thread, pour que l'export les voie encore
+    /// </summary>
+    /// <returns></returns>
+    LveProfiler::ThreadBuffer& LveProfiler::threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock{ threadsMutex };
+            threads.push_back(std::make_unique<ThreadBuffer>());
+            buffer = threads.back().get();
+            buffer->threadId = static_cast<uint32_t>(threads.size() - 1);
+        }
+        return *buffer;
+    }
+    /// <summary>
+    /// Entre dans une zone : retourne sa profondeur d'imbrication dans le thread
+    /// </summary>
+    /// <returns></returns>
+    uint32_t LveProfiler::enterZone() {
+        return threadBuffer().depth++;
+    }
+    /// <summary>
+    /// Sort d'une zone et l'écrit dans le tampon du thread. La zone est publiée par le store release de head,
+    /// sans verrou ; la plus ancienne est écrasée quand le tampon est plein
+    /// </summary>
+    /// <param name="name"></param>
+    /// <param name="start"></param>
+    /// <param name="depth"></param>
+    /// <param name="allocations">allocations faites dans la zone, zéro sans LVE_TRACK_ALLOCATIONS</param>
+    void LveProfiler::leaveZone(const char* name, int64_t start, uint32_t depth, const LveAllocTracker::Counters& allocations) {
+        ThreadBuffer& buffer = threadBuffer();
+        buffer.depth = depth;
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        buffer.zones[head & (RING_SIZE - 1)] = { name, start, now(), depth, allocations.allocations, allocations.bytes };
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+    /// <summary>
+    /// Marque le début d'une trame ; la vue en flammes affiche la dernière trame complète
+    /// </summary>
+    void LveProfiler::markFrame() {
+        uint64_t frame = frameCount.load(std::memory_order_relaxed);
+        frameMarks[frame % FRAME_HISTORY].store(now(), std::memory_order_relaxed);
+        frameCount.store(frame + 1, std::memory_order_release);
+    }
+    /// <summary>
+    /// Bornes de la dernière trame complète, entre les deux derniers appels à markFrame
+    /// </summary>
+    /// <param name="start"></param>
+    /// <param name="end"></param>
+    /// <returns>false tant que deux trames n'ont pas été marquées</returns>
+    bool LveProfiler::lastFrame(int64_t& start, int64_t& end) const {
+        uint64_t frame = frameCount.load(std::memory_order_acquire);
+        if (frame < 2) {
+            return false;
+        }
+        start = frameMarks[(frame - 2) % FRAME_HISTORY].load(std::memory_order_relaxed);
+        end = frameMarks[(frame - 1) % FRAME_HISTORY].load(std::memory_order_relaxed);
+        return true;
+    }
+    /// <summary>
+    /// Copie les zones de tous les threads sans bloquer les écrivains. Après la copie, head est relu :
+    /// les zones que l'écrivain a pu écraser pendant la copie sont retirées
+    /// </summary>
+    /// <returns></returns>
+    std::vector<LveProfiler::ThreadZones> LveProfiler::collect() const {
+        std::lock_guard<std::mutex> lock{ threadsMutex };
+        std::vector<ThreadZones> result{};
+        result.reserve(threads.size());
+        for (const auto& buffer : threads) {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > RING_SIZE ? head - RING_SIZE : 0;
+            ThreadZones thread{ buffer->threadId, {} };
+            thread.zones.reserve(static_cast<size_t>(head - first));
+            for (uint64_t i = first; i < head; i++) {
+                thread.zones.push_back(buffer->zones[i & (RING_SIZE - 1)]);
+            }
+
+            // l'écrivain peut être en train de remplir l'emplacement de headAfter, qui est celui de headAfter - RING_SIZE :
+            // seules les zones à partir de headAfter - RING_SIZE + 1 sont sûres
+            uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+            uint64_t overwritten = headAfter + 1 > RING_SIZE + first ? headAfter + 1 - RING_SIZE - first : 0;
+            thread.zones.erase(thread.zones.begin(), thread.zones.begin() + static_cast<ptrdiff_t>(std::min<uint64_t>(overwritten, thread.zones.size())));
+            result.push_back(std::move(thread));
+        }
+        return result;
+    }
+    /// <summary>
+    /// Écrit les zones au format Chrome trace (événements complets "X", en microsecondes), lisible par chrome://tracing ou Perfetto.
+    /// Les temps sont écrits en notation fixe à la nanoseconde près : en notation par défaut (6 chiffres significatifs),
+    /// ts perdrait sa résolution après une seconde et les zones voisines se confondraient
+    /// </summary>
+    /// <param name="filepath"></param>
+    /// <returns>false si le fichier ne peut pas être écrit</returns>
+    bool LveProfiler::exportChromeTrace(const std::string& filepath) const {
+        std::ofstream file{ filepath };
+        if (!file.is_open()) {
+            return false;
+        }
+        file << std::fixed << std::setprecision(3);
+        file << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& thread : collect()) {
+            for (const auto& zone : thread.zones) {
+                file << (first ? "\n" : ",\n");
+                first = false;
+                file << "{\"name\":";
+                writeJsonString(file, zone.name);
+                file << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.threadId
+                    << ",\"ts\":" << static_cast<double>(zone.start) / 1000.0
+                    << ",\"dur\":" << static_cast<double>(zone.end - zone.start) / 1000.0
+                    << ",\"args\":{\"allocations\":" << zone.allocations << ",\"bytes\":" << zone.allocatedBytes << "}}";
+            }
+        }
+        file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return true;
+    }
+}
@@ -0,0 +1,126 @@
+#include "lve_render_config.hpp"
+#include "lve_swap_chain.hpp"
+
+//std
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+    /// <summary>
+    /// Lit la configuration de rendu dans les arguments du programme. Les options absentes gardent leur valeur par défaut,
+    /// une option inconnue ou une valeur invalide lève une exception
+    /// </summary>
+    /// <param name="argc"></param>
+    /// <param name="argv"></param>
+    /// <returns></returns>
+    LveRenderConfig LveRenderConfig::fromCommandLine(int argc, char* argv[]) {
+        LveRenderConfig config{};
+        for (int i = 1; i < argc; i++) {
+            std::string option = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("missing value for " + option);
+                }
+                return argv[++i];
+            };
+
+            if (option == "--frames-in-flight") {
+                config.framesInFlight = std::stoi(value());
+                if (config.framesInFlight < 1 || config.framesInFlight > LveSwapChain::MAX_FRAMES_IN_FLIGHT) {
+                    throw std::runtime_error("--frames-in-flight must be between 1 and " + std::to_string(LveSwapChain::MAX_FRAMES_IN_FLIGHT));
+                }
+            } else if (option == "--present-mode") {
+                std::string mode = value();
+                if (mode == "fifo") config.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+                else if (mode == "fifo_relaxed") config.presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+                else if (mode == "mailbox") config.presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+                else if (mode == "immediate") config.presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+                else throw std::runtime_error("unknown present mode: " + mode);
+            } else if (option == "--fps") {
+                config.targetFps = std::stod(value());
+                if (config.targetFps < 0.0) {
+                    throw std::runtime_error("--fps must be positive");
+                }
+            } else if (option == "--low-latency") {
+                config.lowLatency = true;
+            } else if (option == "--headless") {
+                config.headless = true;
+            } else if (option == "--resolution") {
+                std::string resolution = value();
+                size_t separator = resolution.find('x');
+                if (separator == std::string::npos) {
+                    throw std::runtime_error("--resolution must be <width>x<height>");
+                }
+                config.headlessExtent.width = static_cast<uint32_t>(std::stoul(resolution.substr(0, separator)));
+                config.headlessExtent.height = static_cast<uint32_t>(std::stoul(resolution.substr(separator + 1)));
+                if (config.headlessExtent.width == 0 || config.headlessExtent.height == 0) {
+                    throw std::runtime_error("--resolution must not be empty");
+                }
+            } else if (option == "--frames") {
+                config.frameCount = static_cast<uint32_t>(std::stoul(value()));
+            } else if (option == "--benchmark") {
+                config.benchmarkReport = value();
+            } else if (option == "--baseline") {
+                config.benchmarkBaseline = value();
+            } else if (option == "--tolerance") {
+                config.regressionTolerance = std::stod(value());
+                if (config.regressionTolerance < 0.0) {
+                    throw std::runtime_error("--tolerance must be positive");
+                }
+            } else if (option == "--cubes") {
+                config.benchmarkCubes = static_cast<uint32_t>(std::stoul(value()));
+            } else if (option == "--lights") {
+                config.benchmarkLights = static_cast<uint32_t>(std::stoul(value()));
+            } else if (option == "--models") {
+                config.benchmarkModels = static_cast<uint32_t>(std::stoul(value()));
+            } else if (option == "--workers") {
+                config.workerThreads = static_cast<uint32_t>(std::stoul(value()));
+            } else if (option == "--trace") {
+                config.traceFile = value();
+            } else if (option == "--idle") {
+                config.idleMode = true;
+            } else if (option == "--verbose") {
+                config.verbose = true;
+            } else if (option == "--capture") {
+                config.captureImage = value();
+            } else if (option == "--reference") {
+                config.referenceImage = value();
+            } else if (option == "--image-tolerance") {
+                config.imageTolerance = static_cast<uint32_t>(std::stoul(value()));
+                if (config.imageTolerance > 255) {
+                    throw std::runtime_error("--image-tolerance must be between 0 and 255");
+                }
+            } else {
+                throw std::runtime_error("unknown option: " + option);
+            }
+        }
+        // sans fenêtre à fermer, il faut bien s'arrêter ; un benchmark a toujours le même nombre de trames
+        if ((config.headless || config.isBenchmark()) && config.frameCount == 0) {
+            config.frameCount = DEFAULT_FRAME_COUNT;
+        }
+        if (!config.benchmarkBaseline.empty() && !config.isBenchmark()) {
+            throw std::runtime_error("--baseline needs --benchmark");
+        }
+        if ((!config.captureImage.empty() || !config.referenceImage.empty()) && !config.headless) {
+            throw std::runtime_error("--capture and --reference need --headless");
+        }
+        if (config.idleMode && (config.headless || config.isBenchmark())) {
+            throw std::runtime_error("--idle needs a window and cannot be used with --headless or --benchmark");
+        }
+        return config;
+    }
+    /// <summary>
+    /// Nom lisible d'un mode de présentation, pour les traces
+    /// </summary>
+    /// <param name="presentMode"></param>
+    /// <returns></returns>
+    const char* LveRenderConfig::presentModeName(VkPresentModeKHR presentMode) {
+        switch (presentMode) {
+        case VK_PRESENT_MODE_FIFO_KHR: return "V-Sync";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "V-Sync (relaxed)";
+        case VK_PRESENT_MODE_MAILBOX_KHR: return "Mailbox";
+        case VK_PRESENT_MODE_IMMEDIATE_KHR: return "Immediate";
+        default: return "Unknown";
+        }
+    }
+}
@@ -0,0 +1,42 @@
+#include "lve_render_snapshot.hpp"
+#include "lve_profiler.hpp"
+
+namespace lve {
+    /// <summary>
+    /// Copie l'état visible de la simulation : pour chaque objet dessiné ou lumière, sa transformation et sa couleur.
+    /// La capacité du slot est réutilisée ; lastChangeStep est laissé à l'appelant
+    /// </summary>
+    /// <param name="simulationStep"></param>
+    /// <param name="gameObjects"></param>
+    void RenderSnapshot::capture(uint64_t simulationStep, LveGameObject::Map& gameObjects) {
+        LVE_PROFILE_FUNCTION();
+        step = simulationStep;
+        objects.clear();
+        for (auto& kv : gameObjects) {
+            auto& obj = kv.second;
+            if (obj.model == nullptr && obj.pointLight == nullptr) continue;
+            objects.push_back({ kv.first, obj.transform.translation, obj.transform.scale, obj.transform.rotation, obj.color,
+                obj.pointLight ? obj.pointLight->lightIntensity : 0.f });
+        }
+    }
+    /// <summary>
+    /// Recopie l'instantané dans les objets du thread de rendu. Les objets absents de l'instantané gardent leur dernier état,
+    /// les données propres au rendu (LOD, matériau) ne sont pas touchées
+    /// </summary>
+    /// <param name="renderObjects"></param>
+    void RenderSnapshot::apply(LveGameObject::Map& renderObjects) const {
+        LVE_PROFILE_FUNCTION();
+        for (auto& state : objects) {
+            auto it = renderObjects.find(state.id);
+            if (it == renderObjects.end()) continue;
+            auto& obj = it->second;
+            obj.transform.translation = state.translation;
+            obj.transform.scale = state.scale;
+            obj.transform.rotation = state.rotation;
+            obj.color = state.color;
+            if (obj.pointLight) {
+                obj.pointLight->lightIntensity = state.lightIntensity;
+            }
+        }
+    }
+}
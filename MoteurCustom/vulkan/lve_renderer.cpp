@@ -1,4 +1,5 @@
 #include "lve_renderer.hpp"
+#include "lve_deletion_queue.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -10,53 +11,70 @@
 
 namespace lve {
     /// <summary>
-    /// Prend une rfrence  un objet LveWindow et un objet LveDevice en paramtres.
+    /// Prend une référence à un objet LveWindow et un objet LveDevice en paramètres.
     ///Appelle les fonctions recreateSwapChain et createCommandBuffers pour initialiser le rendu
     /// </summary>
     /// <param name="window"></param>
     /// <param name="device"></param>
-    LveRenderer::LveRenderer(LveWindow& window, LveDevice& device) : lveWindow{ window }, lveDevice{ device } {
-        recreateSwapChain();
+    /// <param name="config">nombre de trames en vol et mode de présentation</param>
+    LveRenderer::LveRenderer(LveWindow& window, LveDevice& device, const LveRenderConfig& config) : LveRenderer{ &window, device, config } {}
+    /// <summary>
+    /// Sans fenêtre (window nul), le rendu se fait dans des images hors écran de taille config.headlessExtent,
+    /// avec le même déroulé de trame (beginFrame, render pass, endFrame) que pour la chaîne d'échange
+    /// </summary>
+    /// <param name="window"></param>
+    /// <param name="device"></param>
+    /// <param name="config"></param>
+    LveRenderer::LveRenderer(LveWindow* window, LveDevice& device, const LveRenderConfig& config) : lveWindow{ window }, lveDevice{ device }, config{ config } {
+        if (lveWindow == nullptr) {
+            offscreenTarget = std::make_unique<LveOffscreenTarget>(lveDevice, config.headlessExtent, config.framesInFlight);
+        } else {
+            recreateSwapChain();
+        }
         createCommandBuffers();
-
     }
     /// <summary>
-    /// Appelle la fonction freeCommandBuffers pour librer les tampons de commandes
+    /// Appelle la fonction freeCommandBuffers pour libérer les tampons de commandes
     /// </summary>
     LveRenderer::~LveRenderer() {
         freeCommandBuffers();
     }
     /// <summary>
-    ///Obtient la taille de la fentre et attend que la taille ne soit pas nulle.
-    ///Attend que le priphrique Vulkan termine les oprations en cours.
-    ///Recre ou initialise la chane d'change Vulkan (LveSwapChain)
+    ///Obtient la taille de la fenêtre et attend que la taille ne soit pas nulle.
+    ///Recrée ou initialise la chaîne d'échange Vulkan (LveSwapChain) sans attendre le périphérique :
+    /// l'ancienne chaîne est retirée et ne sera détruite qu'une fois ses trames terminées (voir releaseRetiredSwapChains)
     /// </summary>
     void LveRenderer::recreateSwapChain() {
-        auto extent = lveWindow.getExtent();
+        auto extent = lveWindow->getExtent();
         while (extent.width == 0 || extent.height == 0) {
-            extent = lveWindow.getExtent();
+            extent = lveWindow->getExtent();
             glfwWaitEvents();
         }
-        vkDeviceWaitIdle(lveDevice.getDevice());
-        //lveSwapChain = nullptr;
         if (lveSwapChain == nullptr) {
-            lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent);
+            lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, config);
         } else {
             std::shared_ptr<LveSwapChain> oldSwapChain = std::move(lveSwapChain);
-            lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, oldSwapChain);
+            lveSwapChain = std::make_unique<LveSwapChain>(lveDevice, extent, oldSwapChain, config);
 
             if (!oldSwapChain->compareSwapFormats(*lveSwapChain.get())) {
                 throw std::runtime_error("Swap chain image(or depth) format has cganged!");
             }
-
+            retiredSwapChains.push_back({ oldSwapChain, lveDevice.getLastSubmittedTimelineValue() });
         }
     }
     /// <summary>
-    /// Alloue les tampons de commandes ncessaires pour l'excution des commandes GPU.
-    ///Utilise la classe LveSwapChain pour dterminer le nombre maximal de tampons de commandes en vol
+    /// Détruit les chaînes d'échange retirées dont toutes les trames sont terminées, d'après la valeur atteinte par le timeline du device
+    /// </summary>
+    void LveRenderer::releaseRetiredSwapChains() {
+        uint64_t completed = lveDevice.getCompletedTimelineValue();
+        std::erase_if(retiredSwapChains, [&](const RetiredSwapChain& retired) { return retired.timelineValue <= completed; });
+    }
+    /// <summary>
+    /// Alloue les tampons de commandes nécessaires pour l'exécution des commandes GPU.
+    ///Un tampon de commandes par trame en vol (LveRenderConfig::framesInFlight)
     /// </summary>
     void LveRenderer::createCommandBuffers() {
-        commandBuffers.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+        commandBuffers.resize(config.framesInFlight);
 
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -69,21 +87,21 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Libre les tampons de commandes Vulkan
+    /// Libère les tampons de commandes Vulkan
     /// </summary>
     void LveRenderer::freeCommandBuffers() {
         vkFreeCommandBuffers(lveDevice.getDevice(), lveDevice.getCommandPool(), static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data());
         commandBuffers.clear();
     }
     /// <summary>
-    /// Acquiert l'image suivante de la chane d'change.
-    ///Vrifie si la chane d'change a besoin d'tre recre en cas de redimensionnement de la fentre.
+    /// Acquiert l'image suivante de la chaîne d'échange.
+    ///Vérifie si la chaîne d'échange a besoin d'être recréée en cas de redimensionnement de la fenêtre.
     ///  Commence l'enregistrement des commandes pour le tampon de commande actuel
     /// </summary>
     /// <returns></returns>
     VkCommandBuffer LveRenderer::beginFrame() {
         assert(!isFrameStarted && "Can't call beginFrame while already in progress");
-        auto result = lveSwapChain->acquireNextImage(&currentImageIndex);
+        auto result = offscreenTarget ? offscreenTarget->acquireNextImage(&currentImageIndex) : lveSwapChain->acquireNextImage(&currentImageIndex);
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
             return nullptr;
@@ -92,6 +110,8 @@ namespace lve {
             throw std::runtime_error("failed to acquire swap chain image !");
         }
         isFrameStarted = true;
+        releaseRetiredSwapChains();
+        lveDevice.getDeletionQueue().collect();
 
         auto commandBuffer = getCurrentCommandBuffer();
         VkCommandBufferBeginInfo beginInfo{};
@@ -103,8 +123,8 @@ namespace lve {
     }
     /// <summary>
     /// Termine l'enregistrement des commandes pour le tampon de commande actuel.
-    /// Soumet les commandes au GPU via la chane d'change.
-    /// Vrifie si la chane d'change doit tre recre en cas de redimensionnement de la fentre
+    /// Soumet les commandes au GPU via la chaîne d'échange.
+    /// Vérifie si la chaîne d'échange doit être recréée en cas de redimensionnement de la fenêtre
     /// </summary>
     void LveRenderer::endFrame() {
         assert(isFrameStarted && "Can't call endFrame while frame is not in progress");
@@ -113,19 +133,22 @@ namespace lve {
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer !");
         }
-        auto result = lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow.wasWindowResized()) {
-            lveWindow.resetWindowResizedFlag();
+        auto result = offscreenTarget ? offscreenTarget->submitCommandBuffers(&commandBuffer, &currentImageIndex) : lveSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
+        // ce qui a été libéré pendant cette trame attend sa fin
+        lveDevice.getDeletionQueue().retire(lveDevice.getLastSubmittedTimelineValue());
+        // hors écran, pas de présentation ni de redimensionnement : le résultat est toujours VK_SUCCESS
+        if (lveWindow != nullptr && (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lveWindow->wasWindowResized())) {
+            lveWindow->resetWindowResizedFlag();
             recreateSwapChain();
         } else if (result != VK_SUCCESS) {
             throw std::runtime_error("failed to present swap chain image !");
         }
         isFrameStarted = false;
-        currentFrameIndex = (currentFrameIndex + 1) % LveSwapChain::MAX_FRAMES_IN_FLIGHT;
+        currentFrameIndex = (currentFrameIndex + 1) % config.framesInFlight;
     }
     /// <summary>
-    /// Commence une passe de rendu pour la chane d'change actuelle.
-    ///Configure les paramtres de la passe de rendu, tels que la couleur de fond
+    /// Commence une passe de rendu pour la chaîne d'échange actuelle.
+    ///Configure les paramètres de la passe de rendu, tels que la couleur de fond
     /// </summary>
     /// <param name="commandBuffer"></param>
     void LveRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
@@ -133,11 +156,12 @@ namespace lve {
         assert(commandBuffer == getCurrentCommandBuffer() && "Can begin render pass on command buffer from a different frame");
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = lveSwapChain->getRenderPass();
-        renderPassInfo.framebuffer = lveSwapChain->getFrameBuffer(currentImageIndex);
+        renderPassInfo.renderPass = getSwapChainRenderPass();
+        renderPassInfo.framebuffer = offscreenTarget ? offscreenTarget->getFrameBuffer(currentImageIndex) : lveSwapChain->getFrameBuffer(currentImageIndex);
 
+        VkExtent2D extent = getExtent();
         renderPassInfo.renderArea.offset = { 0, 0 };
-        renderPassInfo.renderArea.extent = lveSwapChain->getSwapChainExtent();
+        renderPassInfo.renderArea.extent = extent;
 
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = { 0.01f, 0.01f, 0.01f, 1.0f };
@@ -150,16 +174,16 @@ namespace lve {
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(lveSwapChain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(lveSwapChain->getSwapChainExtent().height);
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
-        VkRect2D scissor{ {0, 0}, lveSwapChain->getSwapChainExtent() };
+        VkRect2D scissor{ {0, 0}, extent };
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
     /// <summary>
-    /// Termine la passe de rendu pour la chane d'change actuelle
+    /// Termine la passe de rendu pour la chaîne d'échange actuelle
     /// </summary>
     /// <param name="commandBuffer"></param>
     void LveRenderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer) {
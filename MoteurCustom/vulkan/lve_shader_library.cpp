@@ -0,0 +1,192 @@
+#include "lve_shader_library.hpp"
+
+//std
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+    // fichier projeté en mémoire en lecture seule ; la projection est alignée sur une page, donc utilisable directement comme pCode.
+    // Chaque ressource système est tenue par un membre qui la libère : rien ne fuit si le constructeur lève une exception
+    class MappedFile {
+    public:
+        MappedFile(const std::string& filepath) {
+#ifdef _WIN32
+            file.handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file.handle == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("failed to open file: " + filepath);
+            }
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx(file.handle, &fileSize);
+            size = static_cast<size_t>(fileSize.QuadPart);
+            if (size > 0) {
+                mapping.handle = CreateFileMappingA(file.handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                view.data = mapping.handle != nullptr ? MapViewOfFile(mapping.handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if (view.data == nullptr) {
+                    throw std::runtime_error("failed to map file: " + filepath);
+                }
+            }
+#else
+            file.fd = open(filepath.c_str(), O_RDONLY);
+            if (file.fd < 0) {
+                throw std::runtime_error("failed to open file: " + filepath);
+            }
+            struct stat status;
+            fstat(file.fd, &status);
+            size = static_cast<size_t>(status.st_size);
+            if (size > 0) {
+                void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+                if (data == MAP_FAILED) {
+                    throw std::runtime_error("failed to map file: " + filepath);
+                }
+                view = { data, size };
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const void* getData() const { return view.data; }
+        size_t getSize() const { return size; }
+
+    private:
+#ifdef _WIN32
+        struct UniqueHandle {
+            HANDLE handle = INVALID_HANDLE_VALUE;
+            ~UniqueHandle() {
+                if (handle != nullptr && handle != INVALID_HANDLE_VALUE) CloseHandle(handle);
+            }
+        };
+        struct UniqueView {
+            void* data = nullptr;
+            ~UniqueView() {
+                if (data != nullptr) UnmapViewOfFile(data);
+            }
+        };
+#else
+        struct UniqueHandle {
+            int fd = -1;
+            ~UniqueHandle() {
+                if (fd >= 0) close(fd);
+            }
+        };
+        struct UniqueView {
+            void* data = nullptr;
+            size_t size = 0;
+            ~UniqueView() {
+                if (data != nullptr) munmap(data, size);
+            }
+        };
+#endif
+        // détruits dans l'ordre inverse : la vue, puis la projection, puis le fichier
+        UniqueHandle file{};
+#ifdef _WIN32
+        UniqueHandle mapping{};
+#endif
+        UniqueView view{};
+        size_t size = 0;
+    };
+
+    LveShaderModule::LveShaderModule(LveDevice& device, VkShaderModule shaderModule) : lveDevice{ device }, shaderModule{ shaderModule } {}
+
+    LveShaderModule::~LveShaderModule() {
+        vkDestroyShaderModule(lveDevice.getDevice(), shaderModule, nullptr);
+    }
+
+    LveShaderLibrary::LveShaderLibrary(LveDevice& device) : lveDevice{ device } {}
+
+    LveShaderLibrary::~LveShaderLibrary() {}
+    /// <summary>
+    /// Retourne le module de shader du fichier SPIR-V. Le fichier est projeté en mémoire et son contenu haché, sans copie.
+    /// Une entrée de même hash et de même taille est la bonne si elle vient du même fichier ; venant d'un autre fichier,
+    /// celui-ci est projeté à son tour et comparé octet par octet. Si un module identique est encore utilisé par un pipeline,
+    /// il est partagé, sinon il est créé. Les entrées expirées sont retirées à chaque chargement (rechargement à chaud).
+    /// Le module est détruit quand le dernier shared_ptr est relâché. Peut être appelé depuis plusieurs threads
+    /// </summary>
+    /// <param name="filepath"></param>
+    /// <returns></returns>
+    std::shared_ptr<LveShaderModule> LveShaderLibrary::load(const std::string& filepath) {
+        MappedFile file{ filepath };
+        if (file.getSize() == 0 || file.getSize() % sizeof(uint32_t) != 0) {
+            throw std::runtime_error("invalid SPIR-V file: " + filepath);
+        }
+        const uint32_t* code = static_cast<const uint32_t*>(file.getData());
+        uint64_t hash = hashCode(code, file.getSize());
+
+        std::lock_guard<std::mutex> lock{ mutex };
+        for (auto it = modules.begin(); it != modules.end();) {
+            it = it->second.module.expired() ? modules.erase(it) : std::next(it);
+        }
+        auto [first, last] = modules.equal_range(hash);
+        for (auto it = first; it != last; ++it) {
+            const CachedModule& cached = it->second;
+            if (cached.size != file.getSize()) continue;
+            auto existing = cached.module.lock();
+            if (!existing) continue;
+            if (cached.path == filepath) {
+                return existing;
+            }
+            try {
+                MappedFile other{ cached.path };
+                if (other.getSize() == file.getSize() && std::memcmp(other.getData(), code, file.getSize()) == 0) {
+                    return existing;
+                }
+            } catch (const std::runtime_error&) {
+                // l'autre fichier a disparu : rien à comparer, on crée le module
+            }
+        }
+
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = file.getSize();
+        createInfo.pCode = code;
+
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(lveDevice.getDevice(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module");
+        }
+        auto module = std::make_shared<LveShaderModule>(lveDevice, shaderModule);
+        modules.emplace(hash, CachedModule{ filepath, file.getSize(), module });
+        return module;
+    }
+    /// <summary>
+    /// Nombre de modules encore vivants ; les entrées expirées sont retirées au passage, comme à chaque chargement
+    /// </summary>
+    /// <returns></returns>
+    size_t LveShaderLibrary::getModuleCount() {
+        std::lock_guard<std::mutex> lock{ mutex };
+        for (auto it = modules.begin(); it != modules.end();) {
+            it = it->second.module.expired() ? modules.erase(it) : std::next(it);
+        }
+        return modules.size();
+    }
+    /// <summary>
+    /// FNV-1a 64 bits sur les mots SPIR-V, mélangé avec la taille
+    /// </summary>
+    /// <param name="code"></param>
+    /// <param name="codeSize"></param>
+    /// <returns></returns>
+    uint64_t LveShaderLibrary::hashCode(const uint32_t* code, size_t codeSize) {
+        uint64_t hash = 14695981039346656037ull ^ codeSize;
+        for (size_t i = 0; i < codeSize / sizeof(uint32_t); i++) {
+            hash ^= code[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
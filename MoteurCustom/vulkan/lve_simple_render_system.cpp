@@ -1,4 +1,8 @@
 #include "lve_simple_render_system.hpp"
+#include "lve_cluster_cull_system.hpp"
+#include "lve_profiler.hpp"
+#include "lve_job_system.hpp"
+#include "lve_frame_arena.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -6,6 +10,7 @@
 #include <ctime>
 #include <chrono>
 #include <vector>
+#include <bit>
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
@@ -16,48 +21,53 @@
 #define MS_PER_UPDATE 0.016 // 1/60
 
 namespace lve {
-    struct SimplePushConstantData {
-        glm::mat4 modelMatrix{ 1.f };
-        glm::mat4 normalMatrix{ 1.f };
-    };
+    // taille projetée (fraction de la demi-hauteur de l'écran) sous laquelle on passe au niveau suivant,
+    // divisée par deux à chaque niveau
+    static constexpr float LOD_SCREEN_SIZE = 0.5f;
+    static constexpr float LOD_HYSTERESIS = 0.15f;
+
     /// <summary>
-    /// Prend une rfrence  un objet LveDevice, un VkRenderPass et un VkDescriptorSetLayout en paramtres.
-    ///Appelle la fonction createPipelineLayout pour crer la mise en page du pipeline.
-    ///   Appelle la fonction createPipeline pour crer le pipeline de rendu
+    /// Prend une référence à un objet LveDevice, un VkRenderPass et un VkDescriptorSetLayout en paramètres.
+    ///Appelle la fonction createPipelineLayout pour créer la mise en page du pipeline.
+    ///   Appelle la fonction createPipeline pour créer le pipeline de rendu
     /// </summary>
     /// <param name="device"></param>
     /// <param name="renderPass"></param>
     /// <param name="globalSetLayout"></param>
-    SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice{ device } {
-        createPipelineLayout(globalSetLayout);
+    /// <param name="bindlessSetLayout">layout de LveBindlessTable (set 2), ou VK_NULL_HANDLE sans le mode bindless</param>
+    SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout bindlessSetLayout) : lveDevice{ device }, bindless{ bindlessSetLayout != VK_NULL_HANDLE } {
+        instanceSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+            .build();
+        createPipelineLayout(globalSetLayout, bindlessSetLayout);
         createPipeline(renderPass);
+        permutation = lightingPermutation();
     }
     /// <summary>
-    /// Dtruit le pipeline layout Vulkan
+    /// Détruit le pipeline layout Vulkan
     /// </summary>
     SimpleRenderSystem::~SimpleRenderSystem() {
         vkDestroyPipelineLayout(lveDevice.getDevice(), pipelineLayout, nullptr);
     }
     /// <summary>
-    /// Cre la mise en page du pipeline Vulkan (pipelineLayout).
-    ///Utilise un VkPushConstantRange pour spcifier des donnes pouvant tre modifies entre les trames.
-    /// Utilise un ensemble de descripteurs global(globalSetLayout).
+    /// Crée la mise en page du pipeline Vulkan (pipelineLayout).
+    /// Utilise un ensemble de descripteurs global(globalSetLayout), les données par objet en set 1 (ObjectInstance, lues à gl_InstanceIndex)
+    /// et l'ensemble bindless en set 2 s'il est fourni. Pas de constantes de poussée : un même appel indirect dessine plusieurs objets
     /// </summary>
     /// <param name="globalSetLayout"></param>
-    void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(SimplePushConstantData);
-
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+    /// <param name="bindlessSetLayout"></param>
+    void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout, VkDescriptorSetLayout bindlessSetLayout) {
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, instanceSetLayout->getDescriptorSetLayout() };
+        if (bindlessSetLayout != VK_NULL_HANDLE) {
+            descriptorSetLayouts.push_back(bindlessSetLayout);
+        }
 
         VkPipelineLayoutCreateInfo pipelineLayoutinfo{};
         pipelineLayoutinfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutinfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());;
         pipelineLayoutinfo.pSetLayouts = descriptorSetLayouts.data();;
-        pipelineLayoutinfo.pushConstantRangeCount = 1;
-        pipelineLayoutinfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutinfo.pushConstantRangeCount = 0;
+        pipelineLayoutinfo.pPushConstantRanges = nullptr;
         if (vkCreatePipelineLayout(lveDevice.getDevice(), &pipelineLayoutinfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
         }
@@ -73,9 +83,11 @@ namespace lve {
         return duration_in_seconds.count();
     }
     /// <summary>
-    /// Cre le pipeline de rendu (lvePipeline).
+    /// Crée les pipelines de rendu (lvePipeline pour les Vertex complets, packedPipeline pour les PackedVertex).
     ///Utilise la configuration du pipeline Vulkan(PipeLineConfigInfo).
-    /// Utilise les shaders vertex et fragment spcifis
+    /// Utilise les shaders vertex et fragment spécifiés, la constante de spécialisation 0 active le décodage des normales octaédriques.
+    /// Les constantes 1 à 4 (éclairage) prennent les valeurs par défaut de LightingFeatures ; les autres combinaisons sont des permutations
+    /// créées à la demande par LvePipeline. En mode bindless, le fragment shader est la variante compilée avec -DBINDLESS
     /// </summary>
     /// <param name="renderPass"></param>
     void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
@@ -85,34 +97,216 @@ namespace lve {
         LvePipeline::defaultPipeLineConfigInfo(pipelineConfig);
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
-        lvePipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/simple_shader.vert.spv", "./shaders/SPIR-V/simple_shader.frag.spv", pipelineConfig);
+        LvePipeline::setSpecializationConstant(pipelineConfig, 0, VK_FALSE);
+        LightingFeatures defaults{};
+        LvePipeline::setSpecializationConstant(pipelineConfig, 1, defaults.maxLights);
+        LvePipeline::setSpecializationConstant(pipelineConfig, 2, defaults.specular ? VK_TRUE : VK_FALSE);
+        LvePipeline::setSpecializationConstant(pipelineConfig, 3, defaults.shininess);
+        LvePipeline::setSpecializationConstant(pipelineConfig, 4, static_cast<uint32_t>(defaults.attenuation));
+        const char* fragFilePath = bindless ? "./shaders/SPIR-V/simple_shader_bindless.frag.spv" : "./shaders/SPIR-V/simple_shader.frag.spv";
+        lvePipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/simple_shader.vert.spv", fragFilePath, pipelineConfig);
+
+        pipelineConfig.bindingDescriptions = LveModel::Vertex::getBindingDescriptions(VertexLayout::Packed);
+        pipelineConfig.attributeDescriptions = LveModel::Vertex::getAttributeDescriptions(VertexLayout::Packed);
+        LvePipeline::setSpecializationConstant(pipelineConfig, 0, VK_TRUE);
+        packedPipeline = std::make_unique<LvePipeline>(lveDevice, "./shaders/SPIR-V/simple_shader.vert.spv", fragFilePath, pipelineConfig);
     }
     /// <summary>
-    /// Lie le pipeline de rendu et les ensembles de descripteurs.
-    ///Itre sur les objets de jeu dans frameInfo.gameObjects.
-    ///    Pour chaque objet :
-    ///Met  jour les constantes de pousse(push constants) avec la transformation actuelle de l'objet.
-    ///   Lie le modle de l'objet et dclenche le dessin
+    /// Prépare les dessins de la trame : pour chaque objet ayant un modèle, choisit le niveau de détail et écrit ses données
+    /// (ObjectInstance) dans le tampon transitoire de la trame, à l'indice de son paquet.
+    /// Avec un LveJobSystem, les objets sont répartis par tranches de DRAW_GRAIN_SIZE sur les threads ; chaque objet n'est touché
+    /// que par une tâche (selectLod écrit obj.lodIndex). L'ordre des objets est celui de frameInfo.gameObjects.
+    /// Les objets au niveau de détail 0 dont le modèle a des clusters sont ensuite confiés au culling des clusters s'il est disponible
+    /// </summary>
+    /// <param name="frameInfo"></param>
+    /// <param name="jobSystem">nullptr pour tout faire sur le thread appelant</param>
+    void SimpleRenderSystem::prepareDraws(FrameInfo& frameInfo, LveJobSystem* jobSystem) {
+        LVE_PROFILE_FUNCTION();
+        drawPackets.clear();
+        clusterObjects.clear();
+        for (auto& kv : frameInfo.gameObjects) {
+            if (kv.second.model != nullptr) {
+                drawPackets.push_back({ &kv.second, kv.first });
+            }
+        }
+        uint32_t count = static_cast<uint32_t>(drawPackets.size());
+        drawsPrepared = true;
+        if (count == 0) {
+            return;
+        }
+        assert(frameInfo.transient != nullptr && "SimpleRenderSystem needs the transient allocator for the instance data");
+        instances = frameInfo.transient->allocateStorage(count * sizeof(ObjectInstance));
+        ObjectInstance* instanceData = static_cast<ObjectInstance*>(instances.mapped);
+
+        auto prepare = [this, &frameInfo, instanceData](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                DrawPacket& packet = drawPackets[i];
+                LveGameObject& obj = *packet.object;
+                packet.lod = selectLod(obj, frameInfo.camera);
+                ObjectInstance instance{};
+                instance.modelMatrix = obj.transform.mat4() * obj.model->getDequantizeMatrix();
+                instance.normalMatrix = glm::mat3x4(obj.transform.normalMatrix());
+                instance.materialIndex = obj.materialIndex;
+                instanceData[i] = instance;
+            }
+        };
+        if (jobSystem) {
+            jobSystem->parallelFor(count, DRAW_GRAIN_SIZE, prepare);
+        } else {
+            prepare(0, count);
+        }
+
+        if (frameInfo.clusterCull != nullptr && frameInfo.clusterCull->isSupported()) {
+            for (uint32_t i = 0; i < count; i++) {
+                DrawPacket& packet = drawPackets[i];
+                if (packet.lod == 0 && packet.object->model->getClusterCount() > 0) {
+                    packet.clustered = true;
+                    clusterObjects.push_back({ packet.object, i });
+                }
+            }
+        }
+    }
+    /// <summary>
+    /// Lie le pipeline du format de vertex s'il n'est pas déjà lié
+    /// </summary>
+    /// <param name="commandBuffer"></param>
+    /// <param name="layout"></param>
+    void SimpleRenderSystem::bindPipeline(VkCommandBuffer commandBuffer, VertexLayout layout) {
+        if (layout != boundLayout) {
+            (layout == VertexLayout::Packed ? packedPipeline : lvePipeline)->bind(commandBuffer, permutation);
+            boundLayout = layout;
+        }
+    }
+    /// <summary>
+    /// Lie le pipeline de rendu et les ensembles de descripteurs : global, données des objets (alloué dans l'allocateur de la trame)
+    /// et table bindless. Parcourt les dessins préparés par prepareDraws (appelé ici s'il ne l'a pas été pour cette trame).
+    /// Les objets dessinés directement (niveau de détail > 0, sans clusters) passent leur indice de paquet en firstInstance ;
+    /// les objets confiés à frameInfo.clusterCull sont ensuite dessinés ensemble, un appel indirect par format de vertex et type d'indices,
+    /// quel que soit leur matériau. Le pipeline n'est changé que lorsque le format de vertex change, et les tampons du pool de géométrie ne sont liés qu'une fois
     /// </summary>
     /// <param name="frameInfo"></param>
     void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
-        lvePipeline->bind(frameInfo.commandBuffer);
+        LVE_PROFILE_FUNCTION();
+        if (!drawsPrepared) {
+            prepareDraws(frameInfo);
+        }
+        drawsPrepared = false;
+        if (drawPackets.empty()) {
+            return;
+        }
+        assert(frameInfo.frameDescriptors != nullptr && "SimpleRenderSystem needs the frame descriptor allocator");
+        VkDescriptorBufferInfo instanceInfo = instances.descriptorInfo();
+        VkDescriptorSet instanceSet;
+        bool allocated = LveDescriptorWriter(*instanceSetLayout, *frameInfo.frameDescriptors, LveFrameArena::resourceOf(frameInfo.frameArena))
+            .writeBuffer(0, &instanceInfo)
+            .build(instanceSet);
+        if (!allocated) {
+            throw std::runtime_error("failed to allocate object instance descriptor set!");
+        }
 
-        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
+        LVE_NO_ALLOC_SCOPE("SimpleRenderSystem::renderGameObjects");
+        boundLayout = VertexLayout::Full;
+        lvePipeline->bind(frameInfo.commandBuffer, permutation);
+        lveDevice.getGeometryPool().resetBindings();
 
-        for (auto& kv : frameInfo.gameObjects) {
-            auto& obj = kv.second;
-            if (obj.model == nullptr) continue;
-            //obj.transform.rotation.y = glm::mod(obj.transform.rotation.y + 0.01f, glm::two_pi<float>());
-            //obj.transform.rotation.x = glm::mod(obj.transform.rotation.x + 0.005f, glm::two_pi<float>());
-            SimplePushConstantData push{};
-            push.modelMatrix = obj.transform.mat4();
-            push.normalMatrix = obj.transform.normalMatrix();
-
-            vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 1, &frameInfo.globalUboOffset);
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &instanceSet, 0, nullptr);
+        if (bindless) {
+            // le matériau de chaque objet est dans ses données d'instance
+            vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 2, 1, &frameInfo.bindlessDescriptorSet, 0, nullptr);
+        }
+
+        uint32_t drawCalls = 0;
+        for (uint32_t i = 0; i < drawPackets.size(); i++) {
+            const DrawPacket& packet = drawPackets[i];
+            if (packet.clustered) continue;
+            auto& obj = *packet.object;
+            bindPipeline(frameInfo.commandBuffer, obj.model->getVertexLayout());
             obj.model->bind(frameInfo.commandBuffer);
-            obj.model->draw(frameInfo.commandBuffer);
+            obj.model->draw(frameInfo.commandBuffer, packet.lod, i);
+            drawCalls++;
+        }
+
+        if (!clusterObjects.empty()) {
+            for (VertexLayout layout : { VertexLayout::Full, VertexLayout::Packed }) {
+                for (VkIndexType indexType : { VK_INDEX_TYPE_UINT32, VK_INDEX_TYPE_UINT16 }) {
+                    if (!frameInfo.clusterCull->hasDraws(layout, indexType)) continue;
+                    bindPipeline(frameInfo.commandBuffer, layout);
+                    lveDevice.getGeometryPool().bind(frameInfo.commandBuffer, indexType);
+                    drawCalls += frameInfo.clusterCull->drawClusters(frameInfo.commandBuffer, layout, indexType);
+                }
+            }
+        }
+        if (frameInfo.stats) {
+            frameInfo.stats->drawCalls += drawCalls;
+            frameInfo.stats->objectsDrawn += static_cast<uint32_t>(drawPackets.size());
         }
     }
 
+    /// <summary>
+    /// Change les options d'éclairage ; la permutation n'est recalculée que si elles ont changé, pour ne rien allouer à chaque trame
+    /// </summary>
+    /// <param name="features"></param>
+    void SimpleRenderSystem::setLighting(const LightingFeatures& features) {
+        if (features == lighting) {
+            return;
+        }
+        lighting = features;
+        permutation = lightingPermutation();
+    }
+    /// <summary>
+    /// Traduit LightingFeatures en valeurs des constantes de spécialisation 1 à 4.
+    /// Le nombre de lumières est arrondi à la puissance de deux supérieure (borné par MAX_LIGHTS)
+    /// pour ne pas créer un pipeline par nombre de lumières
+    /// </summary>
+    /// <returns></returns>
+    SpecializationPermutation SimpleRenderSystem::lightingPermutation() const {
+        uint32_t maxLights = lighting.maxLights == 0 ? 0 : std::bit_ceil(lighting.maxLights);
+        maxLights = std::min(maxLights, static_cast<uint32_t>(MAX_LIGHTS));
+        return {
+            { 1, maxLights },
+            { 2, lighting.specular ? VK_TRUE : VK_FALSE },
+            { 3, std::bit_cast<uint32_t>(lighting.shininess) },
+            { 4, static_cast<uint32_t>(lighting.attenuation) }
+        };
+    }
+    /// <summary>
+    /// Choisit le niveau de détail d'un objet à partir de la taille projetée de sa sphère englobante,
+    /// calculée avec la matrice de projection de la caméra. Le seuil de chaque niveau est élargi de LOD_HYSTERESIS
+    /// dans le sens opposé au dernier changement, pour éviter le scintillement quand un objet reste à la limite
+    /// </summary>
+    /// <param name="obj"></param>
+    /// <param name="camera"></param>
+    /// <returns></returns>
+    uint32_t SimpleRenderSystem::selectLod(LveGameObject& obj, const LveCamera& camera) {
+        uint32_t lodCount = obj.model->getLodCount();
+        if (lodCount <= 1) {
+            return 0;
+        }
+
+        glm::vec4 sphere = obj.model->getBoundingSphere();
+        glm::vec3 scale = glm::abs(obj.transform.scale);
+        float radius = sphere.w * glm::max(scale.x, glm::max(scale.y, scale.z));
+        glm::vec4 centerView = camera.getView() * obj.transform.mat4() * glm::vec4(glm::vec3(sphere), 1.f);
+        float depth = centerView.z;
+        if (depth <= radius) {
+            obj.lodIndex = 0;
+            return 0;
+        }
+        float screenSize = radius * camera.getProjection()[1][1] / depth;
+
+        uint32_t current = glm::min(obj.lodIndex, lodCount - 1);
+        uint32_t target = 0;
+        float threshold = LOD_SCREEN_SIZE;
+        while (target + 1 < lodCount) {
+            // passer au niveau target + 1 demande de descendre sous le seuil moins la marge si on est plus fin,
+            // y rester tant qu'on ne dépasse pas le seuil plus la marge
+            float margin = target + 1 <= current ? (1.f + LOD_HYSTERESIS) : (1.f - LOD_HYSTERESIS);
+            if (screenSize >= threshold * margin) break;
+            target++;
+            threshold *= 0.5f;
+        }
+        obj.lodIndex = target;
+        return target;
+    }
 }
\ No newline at end of file
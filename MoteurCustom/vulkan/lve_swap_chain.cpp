@@ -1,4 +1,5 @@
 #include "lve_swap_chain.hpp"
+#include "lve_profiler.hpp"
 
 // std
 #include <array>
@@ -11,38 +12,69 @@
 
 namespace lve {
     /// <summary>
-    /// Initialise une nouvelle chane d'changes.
+    /// Initialise une nouvelle chaîne d'échanges.
     /// </summary>
     /// <param name="deviceRef"></param>
     /// <param name="extent"></param>
-    LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent) : device{ deviceRef }, windowExtent{ extent } {
+    /// <param name="config">nombre de trames en vol et mode de présentation souhaité</param>
+    LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent, const LveRenderConfig& config)
+        : device{ deviceRef }, windowExtent{ extent }, framesInFlight{ config.framesInFlight }, preferredPresentMode{ config.presentMode } {
         init();
     }
     /// <summary>
-    ///  Initialise une nouvelle chane d'changes base sur une prcdente (utilise pour grer les changements de taille de fentre).
+    ///  Initialise une nouvelle chaîne d'échanges basée sur une précédente (utilisée pour gérer les changements de taille de fenêtre).
+    ///  La nouvelle chaîne reprend les objets de synchronisation de la précédente (les trames en vol restent protégées par leurs fences)
+    ///  et sa render pass si les formats n'ont pas changé. L'ancienne chaîne n'est pas détruite ici : l'appelant la garde
+    ///  jusqu'à ce que les trames qui l'utilisent soient terminées
     /// </summary>
     /// <param name="deviceRef"></param>
     /// <param name="extent"></param>
     /// <param name="previous"></param>
-    LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent, std::shared_ptr<LveSwapChain>previous) : device{ deviceRef }, windowExtent{ extent }, oldSwapChain{ previous } {
+    /// <param name="config"></param>
+    LveSwapChain::LveSwapChain(LveDevice& deviceRef, VkExtent2D extent, std::shared_ptr<LveSwapChain>previous, const LveRenderConfig& config)
+        : device{ deviceRef }, windowExtent{ extent }, framesInFlight{ config.framesInFlight }, preferredPresentMode{ config.presentMode }, oldSwapChain{ previous } {
         init();
-        //cleanup old swap since it's no longer used
+        // l'ancienne chaîne reste en vie tant que l'appelant la garde
         oldSwapChain = nullptr;
     }
     /// <summary>
-    /// Appele dans les constructeurs pour initialiser la chane d'changes en appelant plusieurs fonctions prives
+    /// Appelée dans les constructeurs pour initialiser la chaîne d'échanges en appelant plusieurs fonctions privées
     /// </summary>
     void LveSwapChain::init() {
         createSwapChain();
         createImageViews();
-        createRenderPass();
+        if (oldSwapChain != nullptr && oldSwapChain->swapChainImageFormat == swapChainImageFormat && oldSwapChain->swapChainDepthFormat == findDepthFormat()) {
+            renderPass = oldSwapChain->renderPass;
+            oldSwapChain->renderPass = VK_NULL_HANDLE;
+        } else {
+            createRenderPass();
+        }
         createDepthResources();
         createFramebuffers();
-        createSyncObjects();
+        if (oldSwapChain != nullptr && oldSwapChain->framesInFlight == framesInFlight) {
+            takeSyncObjects(*oldSwapChain);
+        } else {
+            createSyncObjects();
+        }
+    }
+    /// <summary>
+    /// Reprend les sémaphores et les valeurs de timeline de la chaîne précédente, ainsi que l'indice de trame.
+    /// Appelé seulement après un present ou un acquire en échec : aucun sémaphore n'a de signal en attente
+    /// </summary>
+    /// <param name="previous"></param>
+    void LveSwapChain::takeSyncObjects(LveSwapChain& previous) {
+        imageAvailableSemaphores = std::move(previous.imageAvailableSemaphores);
+        renderFinishedSemaphores = std::move(previous.renderFinishedSemaphores);
+        frameTimelineValues = std::move(previous.frameTimelineValues);
+        previous.imageAvailableSemaphores.clear();
+        previous.renderFinishedSemaphores.clear();
+        previous.frameTimelineValues.clear();
+        currentFrame = previous.currentFrame;
+        imageTimelineValues.assign(imageCount(), 0);
     }
     /// <summary>
-    /// Libre les ressources associes  la chane d'changes, y compris les images, les images de profondeur, les images de vue, les tampons de rendu, etc.
-    /// Dtruit galement les objets de synchronisation tels que les smaphores et les cltures.
+    /// Libère les ressources associées à la chaîne d'échanges, y compris les images, les images de profondeur, les images de vue, les tampons de rendu, etc.
+    /// Détruit également les sémaphores d'acquisition et de présentation.
     /// </summary>
     LveSwapChain::~LveSwapChain() {
         for (auto imageView : swapChainImageViews) {
@@ -65,23 +97,34 @@ namespace lve {
             vkDestroyFramebuffer(device.getDevice(), framebuffer, nullptr);
         }
 
-        vkDestroyRenderPass(device.getDevice(), renderPass, nullptr);
+        // null quand la render pass a été reprise par la chaîne suivante
+        if (renderPass != VK_NULL_HANDLE) {
+            vkDestroyRenderPass(device.getDevice(), renderPass, nullptr);
+        }
 
-        // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        // cleanup synchronization objects (empty when taken over by the next swap chain)
+        for (size_t i = 0; i < imageAvailableSemaphores.size(); i++) {
             vkDestroySemaphore(device.getDevice(), renderFinishedSemaphores[i], nullptr);
             vkDestroySemaphore(device.getDevice(), imageAvailableSemaphores[i], nullptr);
-            vkDestroyFence(device.getDevice(), inFlightFences[i], nullptr);
         }
     }
     /// <summary>
-    /// Acquiert l'index de l'image pour laquelle effectuer le rendu dans la chane d'changes.
-    /// Utilise des smaphores pour synchroniser l'acquisition d'images
+    /// Attend que le GPU ait terminé la dernière trame soumise (mode faible latence) :
+    /// ce qui est fait ensuite (entrées, simulation, enregistrement) ne prend pas d'avance sur le GPU
+    /// </summary>
+    void LveSwapChain::waitForLastSubmission() {
+        size_t lastFrame = (currentFrame + framesInFlight - 1) % framesInFlight;
+        device.waitForTimeline(frameTimelineValues[lastFrame]);
+    }
+    /// <summary>
+    /// Acquiert l'index de l'image pour laquelle effectuer le rendu dans la chaîne d'échanges.
+    /// Attend d'abord sur le timeline que le GPU ait fini la dernière utilisation de cette trame
     /// </summary>
     /// <param name="imageIndex"></param>
     /// <returns></returns>
     VkResult LveSwapChain::acquireNextImage(uint32_t* imageIndex) {
-        vkWaitForFences(device.getDevice(), 1, &inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+        LVE_PROFILE_FUNCTION();
+        device.waitForTimeline(frameTimelineValues[currentFrame]);
 
         VkResult result = vkAcquireNextImageKHR(device.getDevice(), swapChain, std::numeric_limits<uint64_t>::max(), imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, imageIndex);
 
@@ -89,37 +132,22 @@ namespace lve {
     }
     /// <summary>
     /// Soumet les tampons de commandes pour le rendu.
-    /// Gre les cltures pour synchroniser le rendu
+    /// La soumission passe par le timeline du device : sa valeur remplace la fence de la trame et celle de l'image.
+    /// Les sémaphores binaires ne servent plus qu'à l'acquisition et à la présentation
     /// </summary>
     /// <param name="buffers"></param>
     /// <param name="imageIndex"></param>
     /// <returns></returns>
     VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex) {
-        if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-            vkWaitForFences(device.getDevice(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-        }
-        imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
-
-        VkSubmitInfo submitInfo = {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-        VkSemaphore waitSemaphores[] = { imageAvailableSemaphores[currentFrame] };
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
-
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = buffers;
+        LVE_PROFILE_FUNCTION();
+        // l'image peut encore être utilisée par une trame d'un autre indice si elles ont été acquises dans le désordre
+        device.waitForTimeline(imageTimelineValues[*imageIndex]);
 
         VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[currentFrame] };
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores = signalSemaphores;
-
-        vkResetFences(device.getDevice(), 1, &inFlightFences[currentFrame]);
-        if (vkQueueSubmit(device.getGraphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer!");
-        }
+        uint64_t value = device.submitGraphics({ buffers[0] }, { imageAvailableSemaphores[currentFrame] },
+            { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, { signalSemaphores[0] });
+        frameTimelineValues[currentFrame] = value;
+        imageTimelineValues[*imageIndex] = value;
 
         VkPresentInfoKHR presentInfo = {};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -135,18 +163,26 @@ namespace lve {
 
         auto result = vkQueuePresentKHR(device.getPresentQueue(), &presentInfo);
 
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        currentFrame = (currentFrame + 1) % framesInFlight;
 
         return result;
     }
     /// <summary>
-    /// Cre la chane d'changes Vulkan
+    /// Crée la chaîne d'échanges Vulkan
     /// </summary>
     void LveSwapChain::createSwapChain() {
         SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
 
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-        VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+        presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+        // tracé à la première chaîne seulement : une recréation (redimensionnement) garde le même mode
+        if (oldSwapChain == nullptr || oldSwapChain->presentMode != presentMode) {
+            std::cout << "Present mode: " << LveRenderConfig::presentModeName(presentMode);
+            if (preferredPresentMode != VK_PRESENT_MODE_MAX_ENUM_KHR && preferredPresentMode != presentMode) {
+                std::cout << " (" << LveRenderConfig::presentModeName(preferredPresentMode) << " unsupported)";
+            }
+            std::cout << std::endl;
+        }
         VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
         uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
@@ -204,7 +240,7 @@ namespace lve {
         swapChainExtent = extent;
     }
     /// <summary>
-    /// Cre les images de vue pour chaque image dans la chane d'changes
+    /// Crée les images de vue pour chaque image dans la chaîne d'échanges
     /// </summary>
     void LveSwapChain::createImageViews() {
         swapChainImageViews.resize(swapChainImages.size());
@@ -226,7 +262,7 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Cre le tampon de rendu Vulkan pour les images de la chane d'changes
+    /// Crée le tampon de rendu Vulkan pour les images de la chaîne d'échanges
     /// </summary>
     void LveSwapChain::createRenderPass() {
         VkAttachmentDescription depthAttachment{};
@@ -286,7 +322,7 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Cre les tampons de trame Vulkan associs  chaque image
+    /// Crée les tampons de trame Vulkan associés à chaque image
     /// </summary>
     void LveSwapChain::createFramebuffers() {
         swapChainFramebuffers.resize(imageCount());
@@ -309,7 +345,7 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Cre les ressources de profondeur pour chaque image
+    /// Crée les ressources de profondeur pour chaque image
     /// </summary>
     void LveSwapChain::createDepthResources() {
         VkFormat depthFormat = findDepthFormat();
@@ -356,29 +392,25 @@ namespace lve {
         }
     }
     /// <summary>
-    /// Cre les objets de synchronisation Vulkan tels que les smaphores et les cltures
+    /// Crée les sémaphores binaires d'acquisition et de présentation. Une valeur de timeline à 0 signifie « rien à attendre »
     /// </summary>
     void LveSwapChain::createSyncObjects() {
-        imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+        imageAvailableSemaphores.resize(framesInFlight);
+        renderFinishedSemaphores.resize(framesInFlight);
+        frameTimelineValues.assign(framesInFlight, 0);
+        imageTimelineValues.assign(imageCount(), 0);
 
         VkSemaphoreCreateInfo semaphoreInfo = {};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        VkFenceCreateInfo fenceInfo = {};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            if (vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS || vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS || vkCreateFence(device.getDevice(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+        for (size_t i = 0; i < framesInFlight; i++) {
+            if (vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS || vkCreateSemaphore(device.getDevice(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
                 throw std::runtime_error("failed to create synchronization objects for a frame!");
             }
         }
     }
     /// <summary>
-    /// Choisi le format de surface pour la chane d'changes
+    /// Choisi le format de surface pour la chaîne d'échanges
     /// </summary>
     /// <param name="availableFormats"></param>
     /// <returns></returns>
@@ -392,30 +424,33 @@ namespace lve {
         return availableFormats[0];
     }
     /// <summary>
-    /// Choisi le mode de prsentation pour la chane d'changes
+    /// Choisi le mode de présentation pour la chaîne d'échanges : celui de la configuration s'il est disponible,
+    /// sinon FIFO (V-Sync), le seul mode que tout périphérique doit supporter.
+    /// Sans mode dans la configuration : Mailbox, à défaut Immediate, à défaut FIFO
     /// </summary>
     /// <param name="availablePresentModes"></param>
     /// <returns></returns>
     VkPresentModeKHR LveSwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
-        for (const auto& availablePresentMode : availablePresentModes) {
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                std::cout << "Present mode: Mailbox" << std::endl;
-                return availablePresentMode;
+        if (preferredPresentMode == VK_PRESENT_MODE_MAX_ENUM_KHR) {
+            for (VkPresentModeKHR candidate : { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR }) {
+                for (const auto& availablePresentMode : availablePresentModes) {
+                    if (availablePresentMode == candidate) {
+                        return availablePresentMode;
+                    }
+                }
             }
+            return VK_PRESENT_MODE_FIFO_KHR;
         }
 
         for (const auto& availablePresentMode : availablePresentModes) {
-            if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-                std::cout << "Present mode: Immediate" << std::endl;
+            if (availablePresentMode == preferredPresentMode) {
                 return availablePresentMode;
             }
         }
-
-        std::cout << "Present mode: V-Sync" << std::endl;
         return VK_PRESENT_MODE_FIFO_KHR;
     }
     /// <summary>
-    /// Choisi l'tendue pour la chane d'changes
+    /// Choisi l'étendue pour la chaîne d'échanges
     /// </summary>
     /// <param name="capabilities"></param>
     /// <returns></returns>
@@ -0,0 +1,77 @@
+#include "lve_task_graph.hpp"
+#include "lve_profiler.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+    /// <summary>
+    /// Ajoute une tâche après celles déjà présentes. Elle dépend de chaque tâche précédente avec laquelle elle est en conflit :
+    /// l'une écrit une ressource que l'autre lit ou écrit. Les lectures seules d'une même ressource peuvent s'exécuter en parallèle
+    /// </summary>
+    /// <param name="name"></param>
+    /// <param name="function"></param>
+    /// <param name="reads"></param>
+    /// <param name="writes"></param>
+    /// <param name="mainThread">exécutée par le thread principal seulement</param>
+    /// <returns>indice de la tâche</returns>
+    uint32_t LveTaskGraph::addTask(const char* name, TaskFunction function, std::initializer_list<std::string_view> reads,
+        std::initializer_list<std::string_view> writes, bool mainThread) {
+        Task task{ name, std::move(function), reads, writes, mainThread };
+        auto intersects = [](const std::vector<std::string_view>& a, const std::vector<std::string_view>& b) {
+            return std::any_of(a.begin(), a.end(), [&](std::string_view resource) { return std::find(b.begin(), b.end(), resource) != b.end(); });
+        };
+
+        uint32_t index = static_cast<uint32_t>(tasks.size());
+        for (uint32_t i = 0; i < index; i++) {
+            Task& previous = tasks[i];
+            if (intersects(previous.writes, task.reads) || intersects(previous.writes, task.writes) || intersects(previous.reads, task.writes)) {
+                previous.dependents.push_back(index);
+                task.dependencyCount++;
+            }
+        }
+        tasks.push_back(std::move(task));
+        return index;
+    }
+    /// <summary>
+    /// Exécute toutes les tâches en respectant les dépendances et attend la fin. Une tâche terminée lance celles
+    /// dont elle était la dernière dépendance ; le thread appelant participe au travail pendant l'attente
+    /// </summary>
+    /// <param name="jobSystem"></param>
+    void LveTaskGraph::run(LveJobSystem& jobSystem) {
+        assert(counter.isDone() && "Task graph is already running");
+        if (remainingCapacity < tasks.size()) {
+            remainingCapacity = static_cast<uint32_t>(tasks.size());
+            remaining.reset(new std::atomic<uint32_t>[remainingCapacity]);
+        }
+        for (uint32_t i = 0; i < tasks.size(); i++) {
+            remaining[i].store(tasks[i].dependencyCount, std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < tasks.size(); i++) {
+            if (tasks[i].dependencyCount == 0) {
+                scheduleTask(jobSystem, i);
+            }
+        }
+        jobSystem.wait(counter);
+    }
+
+    void LveTaskGraph::scheduleTask(LveJobSystem& jobSystem, uint32_t task) {
+        auto job = [this, &jobSystem, task]() {
+            {
+                LVE_PROFILE_SCOPE(tasks[task].name);
+                tasks[task].function();
+            }
+            for (uint32_t dependent : tasks[task].dependents) {
+                if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    scheduleTask(jobSystem, dependent);
+                }
+            }
+        };
+        if (tasks[task].mainThread) {
+            jobSystem.scheduleOnMainThread(job, counter);
+        } else {
+            jobSystem.schedule(job, counter);
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#include "lve_transient_allocator.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+    /// <summary>
+    /// Crée un tampon visible par l'hôte par trame en vol, projeté en mémoire pour toute la durée de vie de l'allocateur.
+    /// La capacité est arrondie à nonCoherentAtomSize pour que les flush partiels restent dans le tampon
+    /// </summary>
+    /// <param name="device"></param>
+    /// <param name="frameCount"></param>
+    /// <param name="frameCapacity"></param>
+    LveTransientAllocator::LveTransientAllocator(LveDevice& device, int frameCount, VkDeviceSize frameCapacity) : lveDevice{ device } {
+        VkDeviceSize atomSize = lveDevice.properties.limits.nonCoherentAtomSize;
+        this->frameCapacity = (frameCapacity + atomSize - 1) / atomSize * atomSize;
+        for (int i = 0; i < frameCount; i++) {
+            auto buffer = std::make_unique<LveBuffer>(lveDevice, this->frameCapacity, 1, USAGE, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+            buffer->map();
+            frameBuffers.push_back(std::move(buffer));
+        }
+    }
+
+    LveTransientAllocator::~LveTransientAllocator() {}
+    /// <summary>
+    /// Remet le pointeur de la trame à zéro. À appeler quand la fence de la trame a été attendue :
+    /// le GPU ne lit plus rien de ce qui a été écrit la dernière fois que cette trame a été utilisée
+    /// </summary>
+    /// <param name="frameIndex"></param>
+    void LveTransientAllocator::beginFrame(int frameIndex) {
+        assert(frameIndex < frameBuffers.size() && "Frame index out of range");
+        currentFrame = frameIndex;
+        head = 0;
+        flushedHead = 0;
+    }
+    /// <summary>
+    /// Réserve size octets alignés sur alignment dans le tampon de la trame courante.
+    /// Retourne le tampon, le décalage (utilisable comme dynamic offset) et le pointeur où écrire les données
+    /// </summary>
+    /// <param name="size"></param>
+    /// <param name="alignment">puissance de deux</param>
+    /// <returns></returns>
+    LveTransientAllocator::Allocation LveTransientAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+        assert((alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+        VkDeviceSize offset = (head + alignment - 1) & ~(alignment - 1);
+        if (offset + size > frameCapacity) {
+            throw std::runtime_error("transient allocator is out of memory for this frame!");
+        }
+        head = offset + size;
+
+        auto& buffer = frameBuffers[currentFrame];
+        return { buffer->getBuffer(), offset, size, static_cast<char*>(buffer->getMappedMemory()) + offset };
+    }
+    /// <summary>
+    /// Réserve de la place pour des données lues comme uniform buffer (dynamique ou non)
+    /// </summary>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    LveTransientAllocator::Allocation LveTransientAllocator::allocateUniform(VkDeviceSize size) {
+        return allocate(size, std::max<VkDeviceSize>(lveDevice.properties.limits.minUniformBufferOffsetAlignment, 1));
+    }
+    /// <summary>
+    /// Réserve de la place pour des données lues comme storage buffer (dynamique ou non)
+    /// </summary>
+    /// <param name="size"></param>
+    /// <returns></returns>
+    LveTransientAllocator::Allocation LveTransientAllocator::allocateStorage(VkDeviceSize size) {
+        return allocate(size, std::max<VkDeviceSize>(lveDevice.properties.limits.minStorageBufferOffsetAlignment, 1));
+    }
+    /// <summary>
+    /// Rend visibles pour le GPU les octets écrits depuis le dernier flush, et seulement ceux-là.
+    /// La plage est étendue aux multiples de nonCoherentAtomSize comme l'exige vkFlushMappedMemoryRanges
+    /// </summary>
+    void LveTransientAllocator::flush() {
+        if (head == flushedHead) {
+            return;
+        }
+        VkDeviceSize atomSize = lveDevice.properties.limits.nonCoherentAtomSize;
+        VkDeviceSize begin = flushedHead / atomSize * atomSize;
+        VkDeviceSize end = std::min((head + atomSize - 1) / atomSize * atomSize, frameCapacity);
+        frameBuffers[currentFrame]->flush(end - begin, begin);
+        flushedHead = head;
+    }
+}
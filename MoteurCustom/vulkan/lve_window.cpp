@@ -5,7 +5,7 @@
 
 namespace lve {
     /// <summary>
-    /// Constructeur initialisant la fentre avec une largeur, une hauteur et un nom spcifis
+    /// Constructeur initialisant la fenêtre avec une largeur, une hauteur et un nom spécifiés
     /// </summary>
     LveWindow::LveWindow(int w, int h, std::string name) : width{ w }, height{ h }, windowName{ name } {
         initWindow();
@@ -20,7 +20,7 @@ namespace lve {
     }
 
     /// <summary>
-    /// Initialise la fentre GLFW avec les paramtres appropris.
+    /// Initialise la fenêtre GLFW avec les paramètres appropriés.
     /// </summary>
     void LveWindow::initWindow() {
         glfwInit();
@@ -30,10 +30,15 @@ namespace lve {
         window = glfwCreateWindow(width, height, windowName.c_str(), nullptr, nullptr);
         glfwSetWindowUserPointer(window, this);
         glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+        // installé avant ImGui, qui enchaîne sur les callbacks déjà présents
+        glfwSetKeyCallback(window, keyCallback);
+        glfwSetCursorPosCallback(window, cursorPosCallback);
+        glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        glfwSetScrollCallback(window, scrollCallback);
     }
 
     /// <summary>
-    /// Cre la surface de la fentre pour Vulkan.
+    /// Crée la surface de la fenêtre pour Vulkan.
     /// </summary>
     /// <param name="instance"></param>
     /// <param name="surface"></param>
@@ -44,7 +49,7 @@ namespace lve {
     }
 
     /// <summary>
-    /// Callback appel lors du redimensionnement de la fentre.
+    /// Callback appelé lors du redimensionnement de la fenêtre.
     /// </summary>
     /// <param name="window"></param>
     /// <param name="width"></param>
@@ -52,7 +57,72 @@ namespace lve {
     void LveWindow::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
         auto lveWindow = reinterpret_cast<LveWindow*>(glfwGetWindowUserPointer(window));
         lveWindow->frambufferResized = true;
+        lveWindow->hasActivity = true;
         lveWindow->width = width;
         lveWindow->height = height;
     }
-}// namespace lve
+
+    /// <summary>
+    /// Horodate l'arrivée des évènements clavier (pendant glfwPollEvents) pour la mesure de latence.
+    /// Seul le premier évènement depuis le dernier takeInputEvent compte : c'est celui qui a attendu le plus longtemps
+    /// </summary>
+    /// <param name="window"></param>
+    /// <param name="key"></param>
+    /// <param name="scancode"></param>
+    /// <param name="action"></param>
+    /// <param name="mods"></param>
+    void LveWindow::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        auto lveWindow = reinterpret_cast<LveWindow*>(glfwGetWindowUserPointer(window));
+        lveWindow->hasActivity = true;
+        if (!lveWindow->hasInputEvent) {
+            lveWindow->hasInputEvent = true;
+            lveWindow->inputEventTime = Clock::now();
+        }
+    }
+
+    /// <summary>
+    /// Donne l'heure d'arrivée du premier évènement clavier non encore consommé
+    /// </summary>
+    /// <param name="arrival"></param>
+    /// <returns>false si aucun évènement n'est arrivé depuis le dernier appel</returns>
+    bool LveWindow::takeInputEvent(Clock::time_point& arrival) {
+        if (!hasInputEvent) {
+            return false;
+        }
+        arrival = inputEventTime;
+        hasInputEvent = false;
+        return true;
+    }
+
+    /// <summary>
+    /// Évènements souris : ils ne déplacent pas la caméra mais peuvent changer l'interface (survol, clic dans ImGui)
+    /// </summary>
+    /// <param name="window"></param>
+    /// <param name="x"></param>
+    /// <param name="y"></param>
+    void LveWindow::cursorPosCallback(GLFWwindow* window, double x, double y) {
+        markActivity(window);
+    }
+
+    void LveWindow::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+        markActivity(window);
+    }
+
+    void LveWindow::scrollCallback(GLFWwindow* window, double x, double y) {
+        markActivity(window);
+    }
+
+    void LveWindow::markActivity(GLFWwindow* window) {
+        reinterpret_cast<LveWindow*>(glfwGetWindowUserPointer(window))->hasActivity = true;
+    }
+
+    /// <summary>
+    /// Indique si un évènement (clavier, souris, redimensionnement) est arrivé depuis le dernier appel
+    /// </summary>
+    /// <returns></returns>
+    bool LveWindow::takeActivity() {
+        bool activity = hasActivity;
+        hasActivity = false;
+        return activity;
+    }
+}// namespace lve
\ No newline at end of file
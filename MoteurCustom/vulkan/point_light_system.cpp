@@ -1,4 +1,6 @@
 #include "point_light_system.hpp"
+#include "lve_profiler.hpp"
+#include "lve_frame_arena.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -14,7 +16,7 @@
 
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
-#include <map>
+#include <algorithm>
 
 namespace lve {
     struct PointLightPushConstants {
@@ -24,7 +26,7 @@ namespace lve {
     };
 
     /// <summary>
-    /// Constructeur initialisant le systme avec un priphrique logique, un passe de rendu Vulkan, et une mise en page de descripteurs globaux.
+    /// Constructeur initialisant le système avec un périphérique logique, un passe de rendu Vulkan, et une mise en page de descripteurs globaux.
     /// </summary>
     /// <param name="device"></param>
     /// <param name="renderPass"></param>
@@ -42,7 +44,7 @@ namespace lve {
     }
 
     /// <summary>
-    /// Cre la mise en page du pipeline.
+    /// Crée la mise en page du pipeline.
     /// </summary>
     /// <param name="globalSetLayout"></param>
     void PointLightSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
@@ -75,23 +77,32 @@ namespace lve {
     }
 
     /// <summary>
-    /// Met  jour les informations sur les lumires  chaque frame.
+    /// Fait tourner les lumières autour de l'axe vertical. Appelé par la simulation à chaque pas, le rendu ne fait que les lire
+    /// </summary>
+    /// <param name="gameObjects"></param>
+    /// <param name="dt"></param>
+    void PointLightSystem::animateLights(LveGameObject::Map& gameObjects, float dt) {
+        auto rotateLight = glm::rotate(glm::mat4(1.f), dt, { 0.f, -1.f, 0.f });
+        for (auto& kv : gameObjects) {
+            auto& obj = kv.second;
+            if (obj.pointLight == nullptr) continue;
+            obj.transform.translation = glm::vec3(rotateLight * glm::vec4(obj.transform.translation, 1.f));
+        }
+    }
+
+    /// <summary>
+    /// Met à jour les informations sur les lumières à chaque frame.
     /// </summary>
     /// <param name="frameInfo"></param>
     /// <param name="ubo"></param>
     void PointLightSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
-        auto rotateLight = glm::rotate(glm::mat4(1.f), frameInfo.frameTime, { 0.f, -1.f, 0.f });
-
+        LVE_PROFILE_FUNCTION();
         int lightIndex = 0;
         for (auto& kv : frameInfo.gameObjects) {
             auto& obj = kv.second;
             if (obj.pointLight == nullptr) continue;
 
             assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specified");
-            // update light positions
-            obj.transform.translation = glm::vec3(rotateLight * glm::vec4(obj.transform.translation, 1.f));
-
-
             // copy light to ubo
             ubo.pointLights[lightIndex].position = glm::vec4(obj.transform.translation, 1.f);
             ubo.pointLights[lightIndex].color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
@@ -102,7 +113,7 @@ namespace lve {
     }
 
     /// <summary>
-    /// Cre le pipeline graphique pour le systme de lumires ponctuelles.
+    /// Crée le pipeline graphique pour le système de lumières ponctuelles.
     /// </summary>
     /// <param name="renderPass"></param>
     void PointLightSystem::createPipeline(VkRenderPass renderPass) {
@@ -119,12 +130,15 @@ namespace lve {
     }
 
     /// <summary>
-    /// Effectue le rendu des lumires ponctuelles.
+    /// Effectue le rendu des lumières ponctuelles.
     /// </summary>
     /// <param name="frameInfo"></param>
     void PointLightSystem::render(FrameInfo& frameInfo) {
-        // sort lights
-        std::map<float, LveGameObject::id_t> sorted;
+        LVE_PROFILE_FUNCTION();
+        LVE_NO_ALLOC_SCOPE("PointLightSystem::render");
+        // sort lights, farthest first; the list lives in the frame arena
+        FrameVector<std::pair<float, LveGameObject::id_t>> sortedLights{ LveFrameArena::resourceOf(frameInfo.frameArena) };
+        sortedLights.reserve(MAX_LIGHTS);
         for (auto& kv : frameInfo.gameObjects) {
             auto& obj = kv.second;
             if (obj.pointLight == nullptr) continue;
@@ -132,15 +146,16 @@ namespace lve {
             // calculate distance
             auto offset = frameInfo.camera.getPosition() - obj.transform.translation;
             float disSquared = glm::dot(offset, offset);
-            sorted[disSquared] = obj.getId();
+            sortedLights.emplace_back(disSquared, obj.getId());
         }
+        std::sort(sortedLights.begin(), sortedLights.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
         lvePipeline->bind(frameInfo.commandBuffer);
 
-        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 0, nullptr);
-        // iterate through sorted lights in reverse order
-        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
+        vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &frameInfo.globalDescriptorSet, 1, &frameInfo.globalUboOffset);
+        // iterate through sorted lights, back to front
+        for (const auto& [distance, id] : sortedLights) {
             // use game obj id to find light object
-            auto& obj = frameInfo.gameObjects.at(it->second);
+            auto& obj = frameInfo.gameObjects.at(id);
 
             PointLightPushConstants push{};
             push.position = glm::vec4(obj.transform.translation, 1.f);
@@ -150,5 +165,9 @@ namespace lve {
             vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PointLightPushConstants), &push);
             vkCmdDraw(frameInfo.commandBuffer, 6, 1, 0, 0);
         }
+        if (frameInfo.stats) {
+            frameInfo.stats->drawCalls += static_cast<uint32_t>(sortedLights.size());
+            frameInfo.stats->objectsDrawn += static_cast<uint32_t>(sortedLights.size());
+        }
     }
 }
\ No newline at end of file